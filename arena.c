@@ -0,0 +1,57 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "arena.h"
+
+//Allocates the memory of the arena. Returns 1 if successful and 0 if not
+int createArena(Arena *arena, size_t size) {
+    //Extra room so the first allocation can be aligned
+    arena->memory = malloc(size + ARENA_ALIGNMENT);
+    arena->size = arena->memory != NULL ? size + ARENA_ALIGNMENT : 0;
+    arena->used = 0;
+    return arena->memory != NULL;
+}
+
+//Returns the next aligned block of the provided size, or NULL if the arena is full.
+//An arena without memory only counts the size the allocations would need
+void *arenaAlloc(Arena *arena, size_t size) {
+    uintptr_t base = (uintptr_t)arena->memory;
+    size_t start = ((base + arena->used + ARENA_ALIGNMENT - 1) & ~(uintptr_t)(ARENA_ALIGNMENT - 1)) - base;
+    if (arena->memory == NULL) start = (arena->used + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (arena->memory != NULL && start + size > arena->size) return NULL;
+    arena->used = start + size;
+    return arena->memory != NULL ? arena->memory + start : NULL;
+}
+
+//Frees every allocation at once while keeping the memory for reuse
+void resetArena(Arena *arena) {
+    arena->used = 0;
+}
+
+//Returns the memory of the arena to the system
+void freeArena(Arena *arena) {
+    free(arena->memory);
+    *arena = (Arena){0};
+}
@@ -0,0 +1,39 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Bump allocator for memory that lives as long as a match
+#ifndef ARENA_H
+#define ARENA_H
+#define ARENA_ALIGNMENT 32 //Every allocation starts on this many bytes so SIMD loads stay aligned
+#include <stddef.h>
+
+typedef struct ArenaStruct {
+    unsigned char *memory; //NULL while measuring how much memory a set of allocations needs
+    size_t size;
+    size_t used;
+} Arena;
+
+int createArena(Arena *arena, size_t size);
+void *arenaAlloc(Arena *arena, size_t size);
+void resetArena(Arena *arena);
+void freeArena(Arena *arena);
+#endif //ARENA_H
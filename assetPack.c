@@ -0,0 +1,406 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "assetPack.h"
+#include "threadPool.h"
+#define PACK_HASH_BITS 14 //Size of the match finder's table
+
+//Chunks are compressed as a series of sequences, each one a run of literal bytes followed by a copy of earlier output. A sequence
+//starts with a token byte holding the literal count in its high half and the copy length minus 4 in its low half. A half of 15 is
+//followed by extra bytes added to it, 255 meaning another byte follows. Then come the literals, then the copy's distance back as
+//2 bytes and the extra bytes of its length. The last sequence has only literals
+
+//Writes a length that didn't fit in its half of the token. Returns 0 if the output is full
+static int putLength(unsigned char *output, size_t capacity, size_t *position, size_t length) {
+    for (length -= 15; ; length -= 255) {
+        if (*position >= capacity) return 0;
+        output[(*position)++] = length >= 255 ? 255 : length;
+        if (length < 255) return 1;
+    }
+}
+
+//Writes a sequence. Returns 0 if the output is full
+static int putSequence(unsigned char *output, size_t capacity, size_t *position, const unsigned char *literals, size_t literalCount,
+                       size_t distance, size_t copyLength) {
+    if (*position >= capacity) return 0;
+    size_t extra = copyLength >= 4 ? copyLength - 4 : 0;
+    output[(*position)++] = (literalCount < 15 ? literalCount : 15) << 4 | (extra < 15 ? extra : 15);
+    if (literalCount >= 15 && !putLength(output, capacity, position, literalCount)) return 0;
+    if (literalCount > capacity - *position) return 0;
+    memcpy(output + *position, literals, literalCount);
+    *position += literalCount;
+    if (copyLength == 0) return 1; //Last sequence
+    if (capacity - *position < 2) return 0;
+    output[(*position)++] = distance & 0xFF;
+    output[(*position)++] = distance >> 8;
+    return extra < 15 || putLength(output, capacity, position, extra);
+}
+
+//Compresses a chunk. Returns the compressed size, or 0 if it doesn't fit in the provided capacity
+size_t compressChunk(const unsigned char *input, size_t size, unsigned char *output, size_t capacity) {
+    int32_t table[1 << PACK_HASH_BITS]; //Last position every hash of 4 bytes was seen at
+    memset(table, 0xFF, sizeof(table));
+    size_t position = 0, anchor = 0, written = 0; //anchor is the first byte not written yet
+    while (position + 4 <= size) {
+        uint32_t bytes;
+        memcpy(&bytes, input + position, 4);
+        uint32_t hash = (bytes*2654435761u) >> (32 - PACK_HASH_BITS);
+        int32_t candidate = table[hash];
+        table[hash] = (int32_t)position;
+        if (candidate < 0 || position - candidate > 65535 || memcmp(input + candidate, input + position, 4) != 0) {
+            position++;
+            continue;
+        }
+        size_t length = 4;
+        while (position + length < size && input[candidate + length] == input[position + length]) length++;
+        if (!putSequence(output, capacity, &written, input + anchor, position - anchor, position - candidate, length)) return 0;
+        position += length;
+        anchor = position;
+    }
+    if (!putSequence(output, capacity, &written, input + anchor, size - anchor, 0, 0)) return 0;
+    return written;
+}
+
+//Reads a length that didn't fit in its half of the token. Returns 0 if the input ends first
+static int getLength(const unsigned char *input, size_t size, size_t *position, size_t *length) {
+    while (1) {
+        if (*position >= size) return 0;
+        unsigned char byte = input[(*position)++];
+        *length += byte;
+        if (byte != 255) return 1;
+    }
+}
+
+//Decompresses a chunk into exactly size bytes. Returns 1 if successful and 0 if the chunk is damaged
+int decompressChunk(const unsigned char *input, size_t storedSize, unsigned char *output, size_t size) {
+    size_t in = 0, out = 0;
+    while (in < storedSize) {
+        unsigned char token = input[in++];
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !getLength(input, storedSize, &in, &literalCount)) return 0;
+        if (literalCount > storedSize - in || literalCount > size - out) return 0;
+        memcpy(output + out, input + in, literalCount);
+        in += literalCount;
+        out += literalCount;
+        if (in == storedSize) break; //Last sequence
+        if (storedSize - in < 2) return 0;
+        size_t distance = input[in] | input[in + 1] << 8;
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !getLength(input, storedSize, &in, &length)) return 0;
+        length += 4;
+        if (distance == 0 || distance > out || length > size - out) return 0;
+        if (distance >= length) memcpy(output + out, output + out - distance, length);
+        else for (size_t i = 0; i < length; i++) output[out + i] = output[out + i - distance]; //Overlapping copy repeats a pattern
+        out += length;
+    }
+    return out == size;
+}
+
+//Adds an entry and its chunks to the builder, compressing every chunk that gets smaller
+static void addEntry(AssetPackBuilder *builder, AssetEntry entry, const unsigned char *data) {
+    int chunkCount = (int)((entry.size + PACK_CHUNK_SIZE - 1)/PACK_CHUNK_SIZE);
+    if (builder->entryCount == builder->entryCapacity) {
+        int capacity = builder->entryCapacity > 0 ? builder->entryCapacity*2 : 16;
+        AssetEntry *grown = realloc(builder->entries, capacity*sizeof(AssetEntry));
+        if (grown == NULL) builder->failed = 1;
+        else {
+            builder->entries = grown;
+            builder->entryCapacity = capacity;
+        }
+    }
+    if (builder->chunkCount + chunkCount > builder->chunkCapacity) {
+        int capacity = builder->chunkCapacity > 0 ? builder->chunkCapacity : 64;
+        while (capacity < builder->chunkCount + chunkCount) capacity *= 2;
+        AssetChunk *grown = realloc(builder->chunks, capacity*sizeof(AssetChunk));
+        if (grown == NULL) builder->failed = 1;
+        else {
+            builder->chunks = grown;
+            builder->chunkCapacity = capacity;
+        }
+    }
+    unsigned char *compressed = malloc(PACK_CHUNK_SIZE);
+    if (compressed == NULL) builder->failed = 1;
+    if (builder->failed) {
+        free(compressed);
+        return;
+    }
+    entry.firstChunk = builder->chunkCount;
+    entry.chunkCount = chunkCount;
+    entry.data = NULL;
+    builder->entries[builder->entryCount++] = entry;
+    for (int i = 0; i < chunkCount; i++) {
+        size_t offset = (size_t)i*PACK_CHUNK_SIZE;
+        uint32_t size = entry.size - offset < PACK_CHUNK_SIZE ? entry.size - offset : PACK_CHUNK_SIZE;
+        size_t storedSize = compressChunk(data + offset, size, compressed, size - 1); //Only kept if it saves something
+        builder->chunks[builder->chunkCount++] = (AssetChunk){builder->data.size, storedSize > 0 ? storedSize : size, size, builder->entryCount - 1};
+        putBytes(&builder->data, storedSize > 0 ? compressed : data + offset, storedSize > 0 ? storedSize : size);
+    }
+    free(compressed);
+}
+
+//Adds a file that is stored as it is, like a sound
+void addPackedFile(AssetPackBuilder *builder, const char *name, const void *data, size_t size) {
+    AssetEntry entry = {"", ASSET_FILE, 0, 0, size};
+    snprintf(entry.name, sizeof(entry.name), "%s", name);
+    addEntry(builder, entry, data);
+}
+
+//Adds an image from its RGBA pixels
+void addPackedImage(AssetPackBuilder *builder, const char *name, const unsigned char *pixels, int width, int height) {
+    AssetEntry entry = {"", ASSET_IMAGE, width, height, (size_t)width*height*4};
+    snprintf(entry.name, sizeof(entry.name), "%s", name);
+    addEntry(builder, entry, pixels);
+}
+
+//Writes the header, the index and the chunks of the builder to a file. Returns 1 if successful and 0 if not
+int writeAssetPack(const char *fileName, const AssetPackBuilder *builder) {
+    if (builder->failed || builder->data.failed) {
+        printf("Out of memory building %s\n", fileName);
+        return 0;
+    }
+    ByteBuffer index = {0};
+    for (int i = 0; i < builder->entryCount; i++) {
+        const AssetEntry *entry = &builder->entries[i];
+        size_t nameLength = strlen(entry->name);
+        putU8(&index, nameLength);
+        putBytes(&index, entry->name, nameLength);
+        putU8(&index, entry->type);
+        putU32(&index, entry->width);
+        putU32(&index, entry->height);
+        putU64(&index, entry->size);
+        putU32(&index, entry->firstChunk);
+        putU32(&index, entry->chunkCount);
+    }
+    for (int i = 0; i < builder->chunkCount; i++) {
+        putU64(&index, builder->chunks[i].offset);
+        putU32(&index, builder->chunks[i].storedSize);
+        putU32(&index, builder->chunks[i].size);
+    }
+    ByteBuffer header = {0};
+    putBytes(&header, "SBPK", 4);
+    putU16(&header, PACK_VERSION);
+    putU16(&header, 0); //Flags
+    putU32(&header, builder->entryCount);
+    putU32(&header, builder->chunkCount);
+    putU32(&header, index.size);
+    putU64(&header, builder->data.size);
+    FILE *f = fopen(fileName, "wb");
+    int written = f != NULL && !index.failed && !header.failed && fwrite(header.data, 1, header.size, f) == header.size
+                  && fwrite(index.data, 1, index.size, f) == index.size && fwrite(builder->data.data, 1, builder->data.size, f) == builder->data.size;
+    if (f == NULL || fclose(f) != 0 || !written) {
+        perror("Error writing asset pack");
+        written = 0;
+    }
+    freeByteBuffer(&index);
+    freeByteBuffer(&header);
+    return written;
+}
+
+void freeAssetPackBuilder(AssetPackBuilder *builder) {
+    freeByteBuffer(&builder->data);
+    free(builder->entries);
+    free(builder->chunks);
+    *builder = (AssetPackBuilder){0};
+}
+
+//Reads the index and checks that every entry is made of whole chunks inside the file. Returns 1 if the pack is valid and 0 if not
+static int readIndex(AssetPack *pack) {
+    ByteReader reader = createByteReader(pack->file, pack->fileSize);
+    char magic[4];
+    getBytes(&reader, magic, 4);
+    uint16_t version = getU16(&reader);
+    uint16_t flags = getU16(&reader);
+    uint32_t entryCount = getU32(&reader);
+    uint32_t chunkCount = getU32(&reader);
+    uint32_t indexSize = getU32(&reader);
+    uint64_t dataSize = getU64(&reader);
+    if (reader.failed || memcmp(magic, "SBPK", 4) != 0 || version != PACK_VERSION || flags != 0 || indexSize > pack->fileSize - PACK_HEADER_SIZE
+        || dataSize != pack->fileSize - PACK_HEADER_SIZE - indexSize || entryCount > indexSize || chunkCount > indexSize/16) return 0;
+    pack->chunkData = pack->file + PACK_HEADER_SIZE + indexSize;
+    pack->entries = calloc(entryCount > 0 ? entryCount : 1, sizeof(AssetEntry));
+    pack->chunks = calloc(chunkCount > 0 ? chunkCount : 1, sizeof(AssetChunk));
+    if (pack->entries == NULL || pack->chunks == NULL) return 0;
+    pack->entryCount = entryCount;
+    pack->chunkCount = chunkCount;
+    for (uint32_t i = 0; i < entryCount; i++) {
+        AssetEntry *entry = &pack->entries[i];
+        size_t nameLength = getU8(&reader);
+        if (nameLength >= PACK_MAX_NAME) return 0;
+        getBytes(&reader, entry->name, nameLength);
+        entry->type = getU8(&reader);
+        entry->width = getU32(&reader);
+        entry->height = getU32(&reader);
+        entry->size = getU64(&reader);
+        uint32_t firstChunk = getU32(&reader);
+        uint32_t entryChunks = getU32(&reader);
+        if (firstChunk > chunkCount || entryChunks > chunkCount - firstChunk || entry->size > (uint64_t)entryChunks*PACK_CHUNK_SIZE) return 0;
+        if (entry->type != ASSET_FILE && (entry->type != ASSET_IMAGE || entry->width <= 0 || entry->height <= 0
+            || entry->size != (uint64_t)entry->width*entry->height*4)) return 0;
+        entry->firstChunk = firstChunk;
+        entry->chunkCount = entryChunks;
+    }
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        AssetChunk *chunk = &pack->chunks[i];
+        chunk->offset = getU64(&reader);
+        chunk->storedSize = getU32(&reader);
+        chunk->size = getU32(&reader);
+        chunk->entry = -1;
+        if (chunk->offset > dataSize || chunk->storedSize > dataSize - chunk->offset || chunk->storedSize > chunk->size) return 0;
+    }
+    //Every chunk belongs to one entry, and is full sized unless it is the entry's last
+    for (int i = 0; i < pack->entryCount; i++) {
+        AssetEntry *entry = &pack->entries[i];
+        if ((uint64_t)entry->chunkCount != (entry->size + PACK_CHUNK_SIZE - 1)/PACK_CHUNK_SIZE) return 0;
+        for (int j = 0; j < entry->chunkCount; j++) {
+            AssetChunk *chunk = &pack->chunks[entry->firstChunk + j];
+            size_t expected = entry->size - (size_t)j*PACK_CHUNK_SIZE < PACK_CHUNK_SIZE ? entry->size - (size_t)j*PACK_CHUNK_SIZE : PACK_CHUNK_SIZE;
+            if (chunk->entry >= 0 || chunk->size != expected) return 0;
+            chunk->entry = i;
+        }
+    }
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        if (pack->chunks[i].entry < 0) return 0; //A chunk no entry owns would be decoded into nothing
+    }
+    return !reader.failed && reader.position == PACK_HEADER_SIZE + indexSize;
+}
+
+//Reads a whole asset pack with one sequential read and checks its index. Returns 1 if successful and 0 if not
+int openAssetPack(AssetPack *pack, const char *fileName) {
+    *pack = (AssetPack){0};
+    FILE *f = fopen(fileName, "rb");
+    if (f == NULL) {
+        perror("Failed to open asset pack");
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    pack->file = size > 0 ? malloc(size) : NULL;
+    pack->fileSize = size > 0 ? size : 0;
+    int read = pack->file != NULL && fread(pack->file, 1, size, f) == (size_t)size;
+    fclose(f);
+    if (!read || pack->fileSize < PACK_HEADER_SIZE || !readIndex(pack)) {
+        printf("%s is not a valid asset pack\n", fileName);
+        closeAssetPack(pack);
+        return 0;
+    }
+    return 1;
+}
+
+//Decodes a single chunk into its entry
+static void decodeChunk(void *context, int task, int worker) {
+    (void)worker;
+    AssetPack *pack = context;
+    const AssetChunk *chunk = &pack->chunks[task];
+    AssetEntry *entry = &pack->entries[chunk->entry];
+    unsigned char *output = entry->data + (size_t)(task - entry->firstChunk)*PACK_CHUNK_SIZE;
+    const unsigned char *input = pack->chunkData + chunk->offset;
+    int decoded = 1;
+    if (chunk->storedSize == chunk->size) memcpy(output, input, chunk->size); //Stored as it is
+    else decoded = decompressChunk(input, chunk->storedSize, output, chunk->size);
+    pthread_mutex_lock(&pack->lock);
+    pack->decodedChunks++;
+    pack->failed |= !decoded;
+    pthread_mutex_unlock(&pack->lock);
+}
+
+static void *runDecode(void *argument) {
+    AssetPack *pack = argument;
+    int ran = runTasks(pack->chunkCount, pack->threadCount, decodeChunk, pack);
+    pthread_mutex_lock(&pack->lock);
+    pack->failed |= !ran;
+    pack->isDecoding = 0;
+    pthread_mutex_unlock(&pack->lock);
+    return NULL;
+}
+
+//Allocates every entry and starts decoding the chunks on the provided number of worker threads. Returns right away, the caller
+//polls getAssetDecodeProgress and then calls finishAssetDecode. Returns 0 if out of memory
+int startAssetDecode(AssetPack *pack, int threadCount) {
+    for (int i = 0; i < pack->entryCount; i++) {
+        pack->entries[i].data = malloc(pack->entries[i].size > 0 ? pack->entries[i].size : 1);
+        if (pack->entries[i].data == NULL) return 0;
+    }
+    pthread_mutex_init(&pack->lock, NULL);
+    pack->threadCount = threadCount;
+    pack->isDecoding = 1;
+    pack->isThreaded = pthread_create(&pack->thread, NULL, runDecode, pack) == 0;
+    if (!pack->isThreaded) runDecode(pack); //Decode on the calling thread instead
+    return 1;
+}
+
+//Returns the fraction of chunks decoded so far, 1 once decoding has finished
+float getAssetDecodeProgress(AssetPack *pack) {
+    pthread_mutex_lock(&pack->lock);
+    float progress = pack->isDecoding ? (float)pack->decodedChunks/(pack->chunkCount > 0 ? pack->chunkCount : 1) : 1;
+    pthread_mutex_unlock(&pack->lock);
+    return progress;
+}
+
+//Waits for decoding to finish and frees the file, which isn't needed anymore. Returns 1 if every chunk decoded and 0 if not
+int finishAssetDecode(AssetPack *pack) {
+    if (pack->isThreaded) pthread_join(pack->thread, NULL);
+    pack->isThreaded = 0;
+    pthread_mutex_destroy(&pack->lock);
+    free(pack->file);
+    pack->file = NULL;
+    pack->chunkData = NULL;
+    if (pack->failed) printf("Asset pack is damaged\n");
+    return !pack->failed;
+}
+
+//Returns the index of the entry with the provided name, or -1 if the pack doesn't have it
+int findAsset(const AssetPack *pack, const char *name) {
+    for (int i = 0; i < pack->entryCount; i++) {
+        if (strcmp(pack->entries[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+//Returns the index of the entry the data is the decoded contents of, or -1 if it doesn't belong to the pack
+int findPackedData(const AssetPack *pack, const void *data) {
+    for (int i = 0; data != NULL && i < pack->entryCount; i++) {
+        if (pack->entries[i].data == data) return i;
+    }
+    return -1;
+}
+
+//Frees the decoded contents of an entry once they have been handed over, like image pixels uploaded to a texture
+void releaseAsset(AssetPack *pack, int entry) {
+    free(pack->entries[entry].data);
+    pack->entries[entry].data = NULL;
+}
+
+void closeAssetPack(AssetPack *pack) {
+    for (int i = 0; pack->entries != NULL && i < pack->entryCount; i++) {
+        free(pack->entries[i].data);
+    }
+    free(pack->entries);
+    free(pack->chunks);
+    free(pack->file);
+    *pack = (AssetPack){0};
+}
@@ -0,0 +1,99 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Asset packs. Every image and sound of the game in one file, read with a single sequential read and decoded on worker threads.
+//Images are stored as decoded RGBA pixels, and every entry is split into chunks compressed on their own so a big image spreads
+//across every thread
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "byteBuffer.h"
+#define PACK_VERSION 1
+#define PACK_HEADER_SIZE 28 //Magic, version, flags, entry count, chunk count, index size and data size
+#define PACK_CHUNK_SIZE (256*1024) //Decoded bytes per chunk, only the last chunk of an entry is smaller
+#define PACK_MAX_NAME 64
+
+typedef enum AssetType {ASSET_FILE = 1, ASSET_IMAGE} AssetType; //Files are stored as they are, images as RGBA pixels
+
+typedef struct AssetEntryStruct {
+    char name[PACK_MAX_NAME];
+    AssetType type;
+    int width; //Of images
+    int height;
+    size_t size; //Decoded bytes
+    int firstChunk;
+    int chunkCount;
+    unsigned char *data; //Decoded contents, NULL until decoded or once released
+} AssetEntry;
+
+typedef struct AssetChunkStruct {
+    uint64_t offset; //Of the stored bytes in the data section
+    uint32_t storedSize; //Equal to size when the chunk didn't compress and is stored as it is
+    uint32_t size;
+    int entry;
+} AssetChunk;
+
+typedef struct AssetPackStruct {
+    unsigned char *file; //The whole file, freed once everything is decoded
+    size_t fileSize;
+    const unsigned char *chunkData; //Data section of the file
+    AssetEntry *entries;
+    int entryCount;
+    AssetChunk *chunks;
+    int chunkCount;
+    pthread_t thread; //Runs the decode so the caller can keep drawing
+    pthread_mutex_t lock; //Protects every field below it
+    int decodedChunks;
+    int isDecoding;
+    int isThreaded;
+    int failed; //Set if a chunk was damaged
+    int threadCount; //Workers the chunks are decoded on
+} AssetPack;
+
+typedef struct AssetPackBuilderStruct {
+    ByteBuffer data; //Stored chunks
+    AssetEntry *entries;
+    int entryCount;
+    int entryCapacity;
+    AssetChunk *chunks;
+    int chunkCount;
+    int chunkCapacity;
+    int failed; //Set if the builder ran out of memory
+} AssetPackBuilder;
+
+size_t compressChunk(const unsigned char *input, size_t size, unsigned char *output, size_t capacity);
+int decompressChunk(const unsigned char *input, size_t storedSize, unsigned char *output, size_t size);
+void addPackedFile(AssetPackBuilder *builder, const char *name, const void *data, size_t size);
+void addPackedImage(AssetPackBuilder *builder, const char *name, const unsigned char *pixels, int width, int height);
+int writeAssetPack(const char *fileName, const AssetPackBuilder *builder);
+void freeAssetPackBuilder(AssetPackBuilder *builder);
+int openAssetPack(AssetPack *pack, const char *fileName);
+int startAssetDecode(AssetPack *pack, int threadCount);
+float getAssetDecodeProgress(AssetPack *pack);
+int finishAssetDecode(AssetPack *pack);
+int findAsset(const AssetPack *pack, const char *name);
+int findPackedData(const AssetPack *pack, const void *data);
+void releaseAsset(AssetPack *pack, int entry);
+void closeAssetPack(AssetPack *pack);
+#endif //ASSETPACK_H
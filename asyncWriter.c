@@ -0,0 +1,215 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "asyncWriter.h"
+
+static pthread_mutex_t closingLock = PTHREAD_MUTEX_INITIALIZER; //Protects closingCount
+static pthread_cond_t closingDone = PTHREAD_COND_INITIALIZER; //Signalled when a detached writer has closed its file
+static int closingCount = 0; //Detached writers that haven't closed their file yet
+
+//Makes sure everything written to the file has reached the disk. Returns 1 if successful and 0 otherwise
+int syncFile(FILE *file) {
+    if (fflush(file) != 0) return 0;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+//Writes a chunk to the file and puts it back on the spare list
+static void writeChunk(AsyncWriter *writer, AsyncChunk *chunk) {
+    int written = fwrite(chunk->data, 1, chunk->size, writer->file) == chunk->size;
+    chunk->size = 0;
+    pthread_mutex_lock(&writer->lock);
+    if (!written) writer->failed = 1;
+    chunk->next = writer->spare;
+    writer->spare = chunk;
+    pthread_mutex_unlock(&writer->lock);
+}
+
+//Closes the file of a stopped writer and frees its chunks, syncing the file to the disk first if sync is set. Returns 1 if every write succeeded and 0 otherwise
+static int releaseWriter(AsyncWriter *writer, int sync) {
+    int succeeded = !writer->failed;
+    if (sync && succeeded) succeeded = syncFile(writer->file);
+    if (fclose(writer->file) != 0) succeeded = 0;
+    free(writer->current);
+    while (writer->spare != NULL) {
+        AsyncChunk *chunk = writer->spare;
+        writer->spare = chunk->next;
+        free(chunk);
+    }
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->wake);
+    *writer = (AsyncWriter){0};
+    return succeeded;
+}
+
+//Writes queued chunks until the writer is closed and nothing is left
+static void *runWriter(void *argument) {
+    AsyncWriter *writer = argument;
+    pthread_mutex_lock(&writer->lock);
+    while (1) {
+        while (writer->queued == NULL && !writer->isClosing) {
+            pthread_cond_wait(&writer->wake, &writer->lock);
+        }
+        AsyncChunk *chunk = writer->queued;
+        if (chunk == NULL) break; //Closing and everything is written
+        writer->queued = chunk->next;
+        if (writer->queued == NULL) writer->lastQueued = NULL;
+        pthread_mutex_unlock(&writer->lock); //The file is written without holding the lock so the caller is never held up
+        writeChunk(writer, chunk);
+        pthread_mutex_lock(&writer->lock);
+    }
+    int isDetached = writer->isDetached;
+    pthread_mutex_unlock(&writer->lock);
+    if (isDetached) { //Nobody joins this thread, so it closes the file and frees the writer itself
+        const char *failureMessage = writer->failureMessage;
+        if (!releaseWriter(writer, 0)) printf("%s\n", failureMessage);
+        free(writer);
+        pthread_mutex_lock(&closingLock);
+        closingCount--;
+        pthread_cond_broadcast(&closingDone);
+        pthread_mutex_unlock(&closingLock);
+    }
+    return NULL;
+}
+
+//Opens a file for writing and starts its writer thread. Returns 1 if successful and 0 if the file couldn't be opened
+int openAsyncWriter(AsyncWriter *writer, const char *fileName) {
+    *writer = (AsyncWriter){0};
+    writer->file = fopen(fileName, "wb");
+    if (writer->file == NULL) {
+        perror("Error opening file");
+        return 0;
+    }
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->wake, NULL);
+    writer->isThreaded = pthread_create(&writer->thread, NULL, runWriter, writer) == 0;
+    return 1;
+}
+
+//Returns an empty chunk, reusing a written one if there is any. Never waits for the writer thread
+static AsyncChunk *takeChunk(AsyncWriter *writer) {
+    pthread_mutex_lock(&writer->lock);
+    AsyncChunk *chunk = writer->spare;
+    if (chunk != NULL) writer->spare = chunk->next;
+    pthread_mutex_unlock(&writer->lock);
+    if (chunk == NULL) chunk = malloc(sizeof(AsyncChunk)); //The disk is behind, buffer more instead of waiting
+    if (chunk != NULL) chunk->size = 0;
+    return chunk;
+}
+
+//Hands the chunk being filled to the writer thread, or writes it right away if there is no thread
+void flushAsyncWriter(AsyncWriter *writer) {
+    AsyncChunk *chunk = writer->current;
+    if (chunk == NULL || chunk->size == 0) return;
+    writer->current = NULL;
+    if (!writer->isThreaded) {
+        writeChunk(writer, chunk);
+        return;
+    }
+    chunk->next = NULL;
+    pthread_mutex_lock(&writer->lock);
+    if (writer->lastQueued != NULL) writer->lastQueued->next = chunk;
+    else writer->queued = chunk;
+    writer->lastQueued = chunk;
+    pthread_cond_signal(&writer->wake);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+//Copies data into the writer's buffer. Full buffers are written by the writer thread
+void asyncWrite(AsyncWriter *writer, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    while (size > 0) {
+        if (writer->current == NULL) {
+            writer->current = takeChunk(writer);
+            if (writer->current == NULL) { //Out of memory, the rest of the data is lost
+                pthread_mutex_lock(&writer->lock);
+                writer->failed = 1;
+                pthread_mutex_unlock(&writer->lock);
+                return;
+            }
+        }
+        AsyncChunk *chunk = writer->current;
+        size_t copied = ASYNC_CHUNK_SIZE - chunk->size;
+        if (copied > size) copied = size;
+        memcpy(chunk->data + chunk->size, bytes, copied);
+        chunk->size += copied;
+        bytes += copied;
+        size -= copied;
+        if (chunk->size == ASYNC_CHUNK_SIZE) flushAsyncWriter(writer);
+    }
+}
+
+//Writes everything that is left, stops the writer thread and closes the file, syncing it to the disk first if sync is set.
+//Waits for the disk, so it should be called once the data is no longer needed by the frame. Returns 1 if every write succeeded and 0 otherwise
+int closeAsyncWriter(AsyncWriter *writer, int sync) {
+    if (writer->file == NULL) return 0;
+    flushAsyncWriter(writer);
+    if (writer->isThreaded) {
+        pthread_mutex_lock(&writer->lock);
+        writer->isClosing = 1;
+        pthread_cond_signal(&writer->wake);
+        pthread_mutex_unlock(&writer->lock);
+        pthread_join(writer->thread, NULL);
+    }
+    return releaseWriter(writer, sync);
+}
+
+//Hands the rest of the writing and the close to the writer thread and returns right away, so the frame never waits for the disk.
+//The writer must have been allocated with malloc and is freed once its file is closed. failureMessage is printed if a write failed
+void closeAsyncWriterLater(AsyncWriter *writer, const char *failureMessage) {
+    if (writer->file == NULL || !writer->isThreaded) { //Nothing to hand over, close it here
+        if (writer->file != NULL && !closeAsyncWriter(writer, 0)) printf("%s\n", failureMessage);
+        free(writer);
+        return;
+    }
+    flushAsyncWriter(writer);
+    pthread_mutex_lock(&closingLock);
+    closingCount++;
+    pthread_mutex_unlock(&closingLock);
+    pthread_detach(writer->thread);
+    pthread_mutex_lock(&writer->lock);
+    writer->failureMessage = failureMessage;
+    writer->isDetached = 1;
+    writer->isClosing = 1;
+    pthread_cond_signal(&writer->wake);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+//Waits until every writer handed to closeAsyncWriterLater has closed its file. Called before the program exits
+void waitForAsyncWriters(void) {
+    pthread_mutex_lock(&closingLock);
+    while (closingCount > 0) {
+        pthread_cond_wait(&closingDone, &closingLock);
+    }
+    pthread_mutex_unlock(&closingLock);
+}
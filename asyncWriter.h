@@ -0,0 +1,59 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Buffered file writer that hands full buffers to a background thread, so writing never waits for the disk
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+#include <pthread.h>
+#include <stdio.h>
+#define ASYNC_CHUNK_SIZE 65536 //Bytes gathered before they are handed to the writer thread
+
+typedef struct AsyncChunkStruct {
+    struct AsyncChunkStruct *next;
+    size_t size; //Bytes used
+    unsigned char data[ASYNC_CHUNK_SIZE];
+} AsyncChunk;
+
+typedef struct AsyncWriterStruct {
+    FILE *file;
+    pthread_t thread;
+    pthread_mutex_t lock; //Protects every field below it
+    pthread_cond_t wake; //Signalled when a chunk is queued or the writer is closed
+    AsyncChunk *current; //Chunk being filled by the caller, only touched by the calling thread
+    AsyncChunk *queued; //Full chunks waiting to be written, oldest first
+    AsyncChunk *lastQueued;
+    AsyncChunk *spare; //Written chunks ready to be filled again
+    int isThreaded; //0 if the thread couldn't be started, chunks are then written on the calling thread
+    int isClosing;
+    int isDetached; //Set by closeAsyncWriterLater, the writer thread then closes the file and frees the writer itself
+    const char *failureMessage; //Printed by a detached writer if a write failed, since nobody waits for its result
+    int failed; //Set if a write failed or a chunk couldn't be allocated
+} AsyncWriter;
+
+int syncFile(FILE *file);
+int openAsyncWriter(AsyncWriter *writer, const char *fileName);
+void asyncWrite(AsyncWriter *writer, const void *data, size_t size);
+void flushAsyncWriter(AsyncWriter *writer);
+int closeAsyncWriter(AsyncWriter *writer, int sync);
+void closeAsyncWriterLater(AsyncWriter *writer, const char *failureMessage);
+void waitForAsyncWriters(void);
+#endif //ASYNCWRITER_H
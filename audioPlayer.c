@@ -0,0 +1,222 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "audioPlayer.h"
+
+//Hands a music track to the player, which unloads it when stopped. Only call before startAudioPlayer
+void setPlayerMusic(AudioPlayer *player, MusicTrack track, Music music) {
+    player->music[track] = music;
+}
+
+//Hands a sound effect to the player, which unloads it when stopped. The effect gets voiceCount voices, aliases of the sound that
+//share its samples, so that many plays overlap instead of cutting each other off. Only call before startAudioPlayer
+void setPlayerEffect(AudioPlayer *player, SoundEffect effect, Sound sound, int voiceCount, int priority) {
+    Effect *added = &player->effects[effect];
+    added->sound = sound;
+    added->priority = priority;
+    added->firstVoice = player->voiceCount;
+    added->voiceCount = 0;
+    added->lastPlayTime = -EFFECT_MERGE_TIME;
+    for (int i = 0; i < voiceCount && player->voiceCount < MAX_VOICES; i++) {
+        player->voices[player->voiceCount++] = (Voice){LoadSoundAlias(sound), effect, 0};
+        added->voiceCount++;
+    }
+}
+
+//Generates a burst of low passed noise over a sine thump that fades out, used for the effects that have no recording.
+//Brightness from 0 to 1 sets how much of the high frequencies are kept, decay how fast it fades
+Sound generateBurstSound(float duration, float decay, float brightness, float thumpFrequency, unsigned int seed) {
+    const int sampleRate = 44100;
+    const int frameCount = (int)(duration*sampleRate);
+    float *burst = malloc(frameCount*sizeof(float));
+    short *samples = malloc(frameCount*sizeof(short));
+    if (burst == NULL || samples == NULL) {
+        free(burst);
+        free(samples);
+        return (Sound){0};
+    }
+    float noise = 0, peak = 1e-6f;
+    for (int i = 0; i < frameCount; i++) {
+        float time = (float)i/sampleRate;
+        seed = seed*1664525u + 1013904223u; //Linear congruential generator, the same burst every run
+        noise += brightness*((float)(seed >> 8)/(1 << 23) - 1 - noise); //One pole low pass over white noise
+        float thump = sinf(2*PI*thumpFrequency*time)*expf(-time*decay);
+        burst[i] = (noise + thump)*expf(-time*decay)*fminf(time/0.002f, 1); //Faded in over 2 ms so the start doesn't click
+        peak = fmaxf(peak, fabsf(burst[i]));
+    }
+    for (int i = 0; i < frameCount; i++) {
+        samples[i] = (short)(burst[i]/peak*0.7f*32767); //Normalized with headroom for the voices playing alongside
+    }
+    free(burst);
+    Sound sound = LoadSoundFromWave((Wave){frameCount, sampleRate, 16, 1, samples});
+    free(samples);
+    return sound;
+}
+
+//Plays an effect on a free voice. Plays of the same effect that come together are merged, and once MAX_ACTIVE_VOICES are playing
+//the oldest voice of the lowest priority is stopped for it, or the play is dropped if every voice playing is more important
+static void startEffect(AudioPlayer *player, SoundEffect effect) {
+    Effect *started = &player->effects[effect];
+    double now = GetTime();
+    if (started->voiceCount == 0 || now - started->lastPlayTime < EFFECT_MERGE_TIME) return;
+    int voice = -1; //Free voice of the effect
+    int victim = -1; //Playing voice to stop if too many are playing
+    int activeCount = 0;
+    for (int i = 0; i < player->voiceCount; i++) {
+        Voice *current = &player->voices[i];
+        if (!IsSoundPlaying(current->sound)) {
+            if (current->effect == effect && voice < 0) voice = i;
+            continue;
+        }
+        activeCount++;
+        if (victim < 0) {
+            victim = i;
+            continue;
+        }
+        int priority = player->effects[current->effect].priority, victimPriority = player->effects[player->voices[victim].effect].priority;
+        if (priority < victimPriority || (priority == victimPriority && current->startTime < player->voices[victim].startTime)) victim = i;
+    }
+    if (activeCount >= MAX_ACTIVE_VOICES) {
+        if (player->effects[player->voices[victim].effect].priority > started->priority) return; //Every voice playing is more important
+        StopSound(player->voices[victim].sound);
+        if (voice < 0 && player->voices[victim].effect == effect) voice = victim;
+    }
+    if (voice < 0) { //Every voice of the effect is playing, restart the oldest one
+        voice = started->firstVoice;
+        for (int i = started->firstVoice + 1; i < started->firstVoice + started->voiceCount; i++) {
+            if (player->voices[i].startTime < player->voices[voice].startTime) voice = i;
+        }
+        StopSound(player->voices[voice].sound);
+    }
+    player->voices[voice].startTime = now;
+    started->lastPlayTime = now;
+    PlaySound(player->voices[voice].sound);
+}
+
+//Runs every command queued since the last update
+static void runCommands(AudioPlayer *player) {
+    AudioQueue *queue = &player->queue;
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire); //Commands before the tail are fully written
+    for (; head != tail; head++) {
+        AudioCommand command = queue->commands[head % AUDIO_QUEUE_SIZE];
+        switch (command.type) {
+            case AUDIO_PLAY_EFFECT:
+                startEffect(player, command.target);
+                break;
+            case AUDIO_PLAY_MUSIC:
+                PlayMusicStream(player->music[command.target]);
+                break;
+            case AUDIO_STOP_MUSIC:
+                StopMusicStream(player->music[command.target]);
+                break;
+            case AUDIO_MUSIC_VOLUME:
+                for (int i = 0; i < MUSIC_TRACK_COUNT; i++) SetMusicVolume(player->music[i], command.value);
+                break;
+            case AUDIO_EFFECT_VOLUME:
+                for (int i = 0; i < player->voiceCount; i++) SetSoundVolume(player->voices[i].sound, command.value);
+                break;
+        }
+    }
+    atomic_store_explicit(&queue->head, head, memory_order_release); //Hands the slots back to the game thread
+}
+
+//Refills the buffers of the tracks that are playing
+static void updateMusic(AudioPlayer *player) {
+    for (int i = 0; i < MUSIC_TRACK_COUNT; i++) {
+        if (IsMusicStreamPlaying(player->music[i])) UpdateMusicStream(player->music[i]);
+    }
+}
+
+static void *runAudio(void *argument) {
+    AudioPlayer *player = argument;
+    while (atomic_load(&player->isRunning)) {
+        runCommands(player);
+        updateMusic(player);
+        WaitTime(AUDIO_UPDATE_INTERVAL);
+    }
+    return NULL;
+}
+
+//Starts the audio thread. From here on only the audio thread touches the tracks and effects until stopAudioPlayer
+void startAudioPlayer(AudioPlayer *player) {
+    atomic_store(&player->isRunning, 1);
+    player->isThreaded = pthread_create(&player->thread, NULL, runAudio, player) == 0;
+}
+
+//Adds a command to the queue without waiting. The command is dropped if the audio thread is too far behind
+static void queueCommand(AudioPlayer *player, AudioCommand command) {
+    AudioQueue *queue = &player->queue;
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&queue->head, memory_order_acquire) >= AUDIO_QUEUE_SIZE) {
+        player->dropped++;
+        return;
+    }
+    queue->commands[tail % AUDIO_QUEUE_SIZE] = command;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release); //Publishes the command to the audio thread
+}
+
+void playEffect(AudioPlayer *player, SoundEffect effect) {
+    queueCommand(player, (AudioCommand){AUDIO_PLAY_EFFECT, effect, 0});
+}
+
+void playMusic(AudioPlayer *player, MusicTrack track) {
+    queueCommand(player, (AudioCommand){AUDIO_PLAY_MUSIC, track, 0});
+}
+
+void stopMusic(AudioPlayer *player, MusicTrack track) {
+    queueCommand(player, (AudioCommand){AUDIO_STOP_MUSIC, track, 0});
+}
+
+void setPlayerMusicVolume(AudioPlayer *player, float volume) {
+    queueCommand(player, (AudioCommand){AUDIO_MUSIC_VOLUME, 0, volume});
+}
+
+void setPlayerEffectVolume(AudioPlayer *player, float volume) {
+    queueCommand(player, (AudioCommand){AUDIO_EFFECT_VOLUME, 0, volume});
+}
+
+//Does the work of the audio thread on the calling thread if it couldn't be started, like on the Web. Does nothing otherwise
+void updateAudioPlayer(AudioPlayer *player) {
+    if (player->isThreaded) return;
+    runCommands(player);
+    updateMusic(player);
+}
+
+//Stops the audio thread and unloads every track and effect
+void stopAudioPlayer(AudioPlayer *player) {
+    atomic_store(&player->isRunning, 0);
+    if (player->isThreaded) pthread_join(player->thread, NULL);
+    player->isThreaded = 0;
+    for (int i = 0; i < player->voiceCount; i++) {
+        UnloadSoundAlias(player->voices[i].sound);
+    }
+    for (int i = 0; i < SOUND_EFFECT_COUNT; i++) {
+        UnloadSound(player->effects[i].sound);
+    }
+    for (int i = 0; i < MUSIC_TRACK_COUNT; i++) {
+        UnloadMusicStream(player->music[i]);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Plays the music and sound effects of the game on its own thread. The game thread queues commands on a lock-free queue and never
+//waits for the audio device, the audio thread refills the music buffers and hands sound effects to a fixed pool of voices
+#ifndef AUDIOPLAYER_H
+#define AUDIOPLAYER_H
+#include <pthread.h>
+#include <stdatomic.h>
+#include "raylib.h"
+#define AUDIO_QUEUE_SIZE 256 //Commands that can be waiting at once, a power of two
+#define AUDIO_UPDATE_INTERVAL 0.005 //Seconds the audio thread sleeps between updates, far shorter than a music buffer lasts
+#define MAX_VOICES 24 //Sound effects that can be loaded for playing at once, across every effect
+#define MAX_ACTIVE_VOICES 12 //Sound effects that can be heard at once, more would add up past full scale and clip
+#define EFFECT_MERGE_TIME 0.03 //Plays of the same effect closer together than this in seconds are heard as one
+
+typedef enum MusicTrack {MUSIC_BACKGROUND, MUSIC_GAME, MUSIC_TRACK_COUNT} MusicTrack; //Every music track
+
+typedef enum SoundEffect {SOUND_SELECTION, SOUND_CONFIRM, SOUND_CANNON_FIRE, SOUND_HIT, SOUND_SPLASH, SOUND_EFFECT_COUNT} SoundEffect; //Every sound effect
+
+typedef enum AudioCommandType {AUDIO_PLAY_EFFECT, AUDIO_PLAY_MUSIC, AUDIO_STOP_MUSIC, AUDIO_MUSIC_VOLUME, AUDIO_EFFECT_VOLUME} AudioCommandType;
+
+typedef struct AudioCommandStruct {
+    AudioCommandType type;
+    int target; //Effect or track the command is for
+    float value; //Volume of the volume commands
+} AudioCommand;
+
+typedef struct AudioQueueStruct {
+    AudioCommand commands[AUDIO_QUEUE_SIZE];
+    atomic_uint head; //Next command to run, only moved by the audio thread
+    atomic_uint tail; //Next free slot, only moved by the game thread
+} AudioQueue;
+
+typedef struct VoiceStruct {
+    Sound sound; //Alias sharing the samples of its effect
+    SoundEffect effect;
+    double startTime; //Of the last play, the oldest voice is stolen first
+} Voice;
+
+typedef struct EffectStruct {
+    Sound sound; //Owns the samples
+    int priority; //Higher priority effects take voices from lower priority ones when too many are playing
+    int firstVoice; //Voices of the effect in the pool
+    int voiceCount;
+    double lastPlayTime;
+} Effect;
+
+typedef struct AudioPlayerStruct {
+    AudioQueue queue;
+    Music music[MUSIC_TRACK_COUNT];
+    Effect effects[SOUND_EFFECT_COUNT];
+    Voice voices[MAX_VOICES];
+    int voiceCount;
+    pthread_t thread;
+    atomic_int isRunning; //Cleared to stop the audio thread
+    int isThreaded; //0 if the thread couldn't be started, updateAudioPlayer then does the work on the game thread
+    int dropped; //Commands lost because the queue was full, only touched by the game thread. Shown in the profiler overlay
+} AudioPlayer;
+
+void setPlayerMusic(AudioPlayer *player, MusicTrack track, Music music);
+void setPlayerEffect(AudioPlayer *player, SoundEffect effect, Sound sound, int voiceCount, int priority);
+Sound generateBurstSound(float duration, float decay, float brightness, float thumpFrequency, unsigned int seed);
+void startAudioPlayer(AudioPlayer *player);
+void playEffect(AudioPlayer *player, SoundEffect effect);
+void playMusic(AudioPlayer *player, MusicTrack track);
+void stopMusic(AudioPlayer *player, MusicTrack track);
+void setPlayerMusicVolume(AudioPlayer *player, float volume);
+void setPlayerEffectVolume(AudioPlayer *player, float volume);
+void updateAudioPlayer(AudioPlayer *player);
+void stopAudioPlayer(AudioPlayer *player);
+#endif //AUDIOPLAYER_H
@@ -0,0 +1,127 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+
+#include "ballistics.h"
+
+typedef struct Interval {
+    float start;
+    float end;
+} Interval; //Range of times, empty if start > end
+
+static const Interval emptyInterval = {INFINITY, -INFINITY};
+
+//Returns the times at which a point starting at start and moving by speed every second is within radius of center
+static Interval pointInCircle(Vector2 start, Vector2 speed, Vector2 center, float radius) {
+    Vector2 offset = Vector2Subtract(start, center);
+    float a = Vector2DotProduct(speed, speed);
+    float b = Vector2DotProduct(offset, speed);
+    float c = Vector2DotProduct(offset, offset) - radius*radius;
+    if (a == 0) return c <= 0 ? (Interval){-INFINITY, INFINITY} : emptyInterval; //Not moving
+    float discriminant = b*b - a*c;
+    if (discriminant < 0) return emptyInterval;
+    float root = sqrtf(discriminant);
+    return (Interval){(-b - root)/a, (-b + root)/a};
+}
+
+//Returns the times at which a point moving along one axis is between min and max on that axis
+static Interval pointInRange(float start, float speed, float min, float max) {
+    if (speed == 0) return start >= min && start <= max ? (Interval){-INFINITY, INFINITY} : emptyInterval;
+    float enter = (min - start)/speed;
+    float exit = (max - start)/speed;
+    return enter < exit ? (Interval){enter, exit} : (Interval){exit, enter};
+}
+
+//Returns the times at which a point is within radius of the segment running along the x axis from (-halfLength, y) to (halfLength, y).
+//The region is convex so the point enters and leaves it only once
+static Interval pointInCapsule(Vector2 start, Vector2 speed, float halfLength, float y, float radius) {
+    Interval alongX = pointInRange(start.x, speed.x, -halfLength, halfLength);
+    Interval alongY = pointInRange(start.y, speed.y, y - radius, y + radius);
+    Interval body = {fmaxf(alongX.start, alongY.start), fminf(alongX.end, alongY.end)};
+    if (body.start > body.end) body = emptyInterval; //Never inside both ranges at once
+    Interval front = pointInCircle(start, speed, (Vector2){halfLength, y}, radius);
+    Interval back = pointInCircle(start, speed, (Vector2){-halfLength, y}, radius);
+    return (Interval){fminf(body.start, fminf(front.start, back.start)), fmaxf(body.end, fmaxf(front.end, back.end))};
+}
+
+//Returns the time until a projectile at the provided height and vertical speed reaches the water
+float getLandingTime(float height, float speedZ) {
+    if (height <= 0) return 0;
+    return (speedZ + sqrtf(speedZ*speedZ + 2*GRAVITY*height))/GRAVITY;
+}
+
+//Returns how long ago the projectile would have left the water if its parabola is followed backwards, as a negative time
+static float getRisingTime(float height, float speedZ) {
+    return (speedZ - sqrtf(speedZ*speedZ + 2*GRAVITY*fmaxf(height, 0)))/GRAVITY;
+}
+
+//Returns the first time after the provided time at which a projectile with the provided position and speed hits the ship,
+//or INFINITY if it never does. Times are measured from when the projectile had that position and may be negative.
+//The projectile follows its parabola exactly and the ship doesn't move while projectiles fly
+float findImpactTime(const ShipGeometry *geometry, Vector3 position, Vector3 speed, float after) {
+    //Times at which the projectile is low enough to hit but still above the water. Going up it may pass through this range once more
+    float rising = getRisingTime(position.z, speed.z);
+    float landing = getLandingTime(position.z, speed.z);
+    Interval windows[2] = {{rising, landing}, emptyInterval};
+    float discriminant = speed.z*speed.z - 2*GRAVITY*(SHELL_HIT_HEIGHT - position.z);
+    if (discriminant > 0) { //The projectile rises above the hit height at some point
+        float root = sqrtf(discriminant);
+        windows[0] = (Interval){rising, (speed.z - root)/GRAVITY}; //Before it climbs past the hit height
+        windows[1] = (Interval){(speed.z + root)/GRAVITY, landing}; //After it drops back below it
+    }
+    //Move into the ship's frame, where x runs towards the bow and y towards the left side
+    Vector2 offset = Vector2Subtract((Vector2){position.x, position.y}, geometry->position);
+    Vector2 start = {Vector2DotProduct(offset, geometry->forward), Vector2DotProduct(offset, geometry->side)};
+    Vector2 velocity = {speed.x*geometry->forward.x + speed.y*geometry->forward.y, speed.x*geometry->side.x + speed.y*geometry->side.y};
+    //The hull is checked as the same 4 lines along the ship that the per frame check used
+    const float offsets[4] = {SHIP_HALF_WIDTH, 7, -7, -SHIP_HALF_WIDTH};
+    float impact = INFINITY;
+    for (int i = 0; i < 4; i++) {
+        Interval hull = pointInCapsule(start, velocity, SHIP_HALF_LENGTH, offsets[i], SHELL_HIT_RADIUS);
+        for (int j = 0; j < 2; j++) {
+            float enter = fmaxf(fmaxf(hull.start, windows[j].start), after);
+            float exit = fminf(hull.end, windows[j].end);
+            if (enter <= exit && enter < impact) impact = enter;
+        }
+    }
+    return impact;
+}
+
+//Finds the first alive enemy ship the projectile will hit after the provided time, when it will hit it and when it will land.
+//now is the time of the projectile's current position, all times are on the same clock
+void scheduleImpact(ProjectileList *projectiles, int projectile, const Fleet *ships, const ShipGeometry *geometry, float now, float after) {
+    int i = projectile;
+    Vector3 position = {projectiles->positionX[i], projectiles->positionY[i], projectiles->positionZ[i]};
+    Vector3 speed = {projectiles->speedX[i], projectiles->speedY[i], projectiles->speedZ[i]};
+    projectiles->landingTime[i] = now + getLandingTime(position.z, speed.z);
+    projectiles->target[i] = -1;
+    projectiles->impactTime[i] = INFINITY;
+    for (int ship = 0; ship < ships->count; ship++) {
+        if (ships->isAlive[ship] == 0 || ships->team[ship] == projectiles->team[i]) continue; //Ships can't hit themselves
+        float impact = now + findImpactTime(&geometry[ship], position, speed, after - now);
+        if (impact < projectiles->impactTime[i]) {
+            projectiles->impactTime[i] = impact;
+            projectiles->target[i] = ship;
+        }
+    }
+}
@@ -0,0 +1,33 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Exact time of impact between projectiles and ship hulls
+#ifndef BALLISTICS_H
+#define BALLISTICS_H
+#define SHELL_HIT_RADIUS 15.0f //A projectile hits a ship if it passes this close to one of the ship's hull lines
+#define SHELL_HIT_HEIGHT 15.0f //Projectiles can only hit ships below this height
+#include "gameCalculations.h"
+
+float getLandingTime(float height, float speedZ);
+float findImpactTime(const ShipGeometry *geometry, Vector3 position, Vector3 speed, float after);
+void scheduleImpact(ProjectileList *projectiles, int projectile, const Fleet *ships, const ShipGeometry *geometry, float now, float after);
+#endif //BALLISTICS_H
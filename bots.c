@@ -0,0 +1,165 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+
+#include "bots.h"
+#include "fireControl.h"
+#include "navGraph.h"
+#define PILOT_COURSES 8 //Random courses the pilot bot tries before settling for the one that goes furthest
+#define NAVIGATOR_RANGE 400.0f //Distance from the closest enemy the navigator bot stops closing in at
+
+//Returns the next number of a xorshift random sequence. Each match keeps its own seed so results can be reproduced
+unsigned int nextRandom(unsigned int *seed) {
+    unsigned int x = *seed ? *seed : 0x9E3779B9u; //A seed of 0 would get stuck at 0
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x;
+}
+
+//Returns a random number between min and max
+float randomFloat(unsigned int *seed, float min, float max) {
+    return min + (max - min)*(float)(nextRandom(seed) >> 8)/(float)(1u << 24);
+}
+
+//Gives the provided ship a random heading and speed
+void randomMovementOrder(Match *match, int ship, unsigned int *seed) {
+    float heading = randomFloat(seed, 0, 2*M_PI);
+    float speed = randomFloat(seed, 0, maxShipSpeed);
+    setMovementOrder(match, ship, heading, speed);
+}
+
+//Aims the provided ship's shot towards the end position of a random enemy with a random elevation
+void randomFireOrder(Match *match, int ship, unsigned int *seed) {
+    Fleet *ships = &match->ships;
+    int enemies = playersAlive(ships) - ships->isAlive[ship]; //Number of enemies that can be targeted
+    float heading = randomFloat(seed, 0, 2*M_PI);
+    if (enemies > 0) {
+        int pick = nextRandom(seed) % enemies; //Which of the alive enemies to shoot at
+        for (int i = 0; i < match->playerCount; i++) {
+            if (i == ship || ships->isAlive[i] == 0) continue;
+            if (pick-- == 0) {
+                float fromX = ships->positionX[ship] + ships->distanceMovedX[ship];
+                float fromY = ships->positionY[ship] + ships->distanceMovedY[ship];
+                float toX = ships->positionX[i] + ships->distanceMovedX[i];
+                float toY = ships->positionY[i] + ships->distanceMovedY[i];
+                heading = atan2f(toY - fromY, toX - fromX);
+                break;
+            }
+        }
+    }
+    setFireOrder(match, ship, heading, randomFloat(seed, 0, M_PI/4));
+}
+
+//Gives the provided ship a random course that stays clear of the terrain for the whole round. If none of the courses it tries is clear
+//it takes the one that gets furthest and slows down to stop short of the coast
+void pilotMovementOrder(Match *match, int ship, unsigned int *seed) {
+    Vector2 position = {match->ships.positionX[ship], match->ships.positionY[ship]};
+    float bestHeading = match->ships.heading[ship], bestSpeed = 0;
+    for (int i = 0; i < PILOT_COURSES; i++) {
+        float heading = randomFloat(seed, 0, 2*M_PI);
+        float speed = randomFloat(seed, 0, maxShipSpeed);
+        float clearLength = getClearCourseLength(match->terrain, position, heading, speed*ROUND_LENGTH);
+        if (clearLength >= speed*ROUND_LENGTH) { //The whole course is clear
+            bestHeading = heading;
+            bestSpeed = speed;
+            break;
+        }
+        float safeSpeed = fmaxf(clearLength - COURSE_STEP, 0)/ROUND_LENGTH; //Speed that stops a step before the coast
+        if (safeSpeed > bestSpeed) {
+            bestHeading = heading;
+            bestSpeed = safeSpeed;
+        }
+    }
+    setMovementOrder(match, ship, bestHeading, bestSpeed);
+}
+
+//Sails the provided ship around the islands towards the closest enemy, one leg of the planned route every round.
+//Once in range, or when the match has no route planner or no route is found, it moves like the pilot bot
+void navigatorMovementOrder(Match *match, int ship, unsigned int *seed) {
+    Fleet *ships = &match->ships;
+    Vector2 position = {ships->positionX[ship], ships->positionY[ship]};
+    int target = -1;
+    float closest = INFINITY;
+    for (int i = 0; i < match->playerCount; i++) {
+        if (i == ship || ships->isAlive[i] == 0) continue;
+        float distance = Vector2Distance(position, (Vector2){ships->positionX[i], ships->positionY[i]});
+        if (distance < closest) {
+            closest = distance;
+            target = i;
+        }
+    }
+    Vector2 waypoint;
+    if (match->pathFinder == NULL || target < 0 || closest < NAVIGATOR_RANGE
+        || !findPath(match->pathFinder, position, (Vector2){ships->positionX[target], ships->positionY[target]}, &waypoint, 1)) {
+        pilotMovementOrder(match, ship, seed);
+        return;
+    }
+    float heading = atan2f(waypoint.y - position.y, waypoint.x - position.x);
+    float length = fminf(Vector2Distance(position, waypoint), maxShipSpeed*ROUND_LENGTH);
+    //The route keeps its distance from the coast, but the hull can still clip a corner where the route turns
+    float clearLength = getClearCourseLength(match->terrain, position, heading, length);
+    if (clearLength < length) length = fmaxf(clearLength - COURSE_STEP, 0);
+    setMovementOrder(match, ship, heading, length/ROUND_LENGTH);
+}
+
+//Keeps the provided ship where it is. Used as a baseline the other bots should beat
+void holdPositionOrder(Match *match, int ship, unsigned int *seed) {
+    (void)seed; //Holding position needs no randomness
+    setMovementOrder(match, ship, match->ships.heading[ship], 0);
+}
+
+//Fires the provided ship's shot so it lands on the end position of the closest enemy, using the fire control solver
+void aimedFireOrder(Match *match, int ship, unsigned int *seed) {
+    Fleet *ships = &match->ships;
+    Vector2 from = {ships->positionX[ship] + ships->distanceMovedX[ship], ships->positionY[ship] + ships->distanceMovedY[ship]};
+    int target = -1;
+    float closest = INFINITY;
+    for (int i = 0; i < match->playerCount; i++) {
+        if (i == ship || ships->isAlive[i] == 0) continue;
+        Vector2 to = {ships->positionX[i] + ships->distanceMovedX[i], ships->positionY[i] + ships->distanceMovedY[i]};
+        if (Vector2DistanceSqr(from, to) < closest) {
+            closest = Vector2DistanceSqr(from, to);
+            target = i;
+        }
+    }
+    if (target < 0) { //No enemies left to aim at
+        randomFireOrder(match, ship, seed);
+        return;
+    }
+    Vector2 to = {ships->positionX[target] + ships->distanceMovedX[target], ships->positionY[target] + ships->distanceMovedY[target]};
+    //Ships don't move while projectiles fly so the target is aimed at where it stops
+    FiringSolution solution = solveFiringSolution(from, to, Vector2Zero(), 0);
+    setFireOrder(match, ship, solution.heading, solution.angle);
+}
+
+//Every bot the tournament runner can pit against each other
+const Bot bots[] = {
+    {"random", randomMovementOrder, randomFireOrder},
+    {"anchored", holdPositionOrder, randomFireOrder},
+    {"gunner", randomMovementOrder, aimedFireOrder},
+    {"pilot", pilotMovementOrder, aimedFireOrder},
+    {"navigator", navigatorMovementOrder, aimedFireOrder},
+};
+const int botCount = sizeof(bots)/sizeof(bots[0]);
@@ -0,0 +1,45 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Computer controlled players used by the headless tools
+#ifndef BOTS_H
+#define BOTS_H
+#include "match.h"
+
+typedef struct BotStruct {
+    const char *name;
+    void (*movementOrder)(Match *match, int ship, unsigned int *seed);
+    void (*fireOrder)(Match *match, int ship, unsigned int *seed);
+} Bot; //Strategy a computer controlled ship plays with
+
+extern const Bot bots[];
+extern const int botCount;
+
+unsigned int nextRandom(unsigned int *seed);
+float randomFloat(unsigned int *seed, float min, float max);
+void randomMovementOrder(Match *match, int ship, unsigned int *seed);
+void randomFireOrder(Match *match, int ship, unsigned int *seed);
+void pilotMovementOrder(Match *match, int ship, unsigned int *seed);
+void navigatorMovementOrder(Match *match, int ship, unsigned int *seed);
+void holdPositionOrder(Match *match, int ship, unsigned int *seed);
+void aimedFireOrder(Match *match, int ship, unsigned int *seed);
+#endif //BOTS_H
@@ -0,0 +1,80 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "broadPhase.h"
+
+//Allocates the arrays of the broad phase from the provided arena. Returns 1 if successful and 0 if the arena is full
+int allocateSweepAndPrune(SweepAndPrune *sweep, int shipCount, Arena *arena) {
+    sweep->count = shipCount;
+    sweep->order = arenaAlloc(arena, shipCount*sizeof(int));
+    sweep->min = arenaAlloc(arena, shipCount*sizeof(Vector2));
+    sweep->max = arenaAlloc(arena, shipCount*sizeof(Vector2));
+    sweep->collided = arenaAlloc(arena, shipCount*sizeof(int));
+    return sweep->collided != NULL;
+}
+
+//Starts the sorted order over with the ships in index order
+void resetSweepAndPrune(SweepAndPrune *sweep) {
+    for (int i = 0; i < sweep->count; i++) {
+        sweep->order[i] = i;
+    }
+}
+
+//Checks for ship-ship collisions. Ships that collide with each other are destroyed
+void checkShipCollisions(Fleet *ships, const ShipGeometry *geometry, SweepAndPrune *sweep) {
+    int playerCount = ships->count;
+    //Measure the bounding box of every ship
+    for (int i = 0; i < playerCount; i++) {
+        const Vector2 *corners = geometry[i].corners;
+        sweep->min[i] = Vector2Min(Vector2Min(corners[0], corners[1]), Vector2Min(corners[2], corners[3]));
+        sweep->max[i] = Vector2Max(Vector2Max(corners[0], corners[1]), Vector2Max(corners[2], corners[3]));
+        sweep->collided[i] = 0;
+    }
+    //Ships only move a little every tick, so insertion sort on last tick's order is close to linear
+    for (int i = 1; i < playerCount; i++) {
+        int ship = sweep->order[i];
+        int j = i - 1;
+        while (j >= 0 && sweep->min[sweep->order[j]].x > sweep->min[ship].x) {
+            sweep->order[j + 1] = sweep->order[j];
+            j--;
+        }
+        sweep->order[j + 1] = ship;
+    }
+    //Sweep along the x axis. Each ship is only paired with the ships starting before it ends, so every pair is tested at most once
+    for (int i = 0; i < playerCount; i++) {
+        int a = sweep->order[i];
+        if (ships->isAlive[a] == 0) continue;
+        for (int j = i + 1; j < playerCount && sweep->min[sweep->order[j]].x <= sweep->max[a].x; j++) {
+            int b = sweep->order[j];
+            if (ships->isAlive[b] == 0) continue;
+            if (sweep->min[b].y > sweep->max[a].y || sweep->max[b].y < sweep->min[a].y) continue; //No overlap on the y axis
+            if (checkShipPairCollision(&geometry[a], &geometry[b])) {
+                sweep->collided[a] = 1;
+                sweep->collided[b] = 1;
+            }
+        }
+    }
+    //Destroy the ships only after every pair was tested so the result doesn't depend on the order of the ships
+    for (int i = 0; i < playerCount; i++) {
+        if (sweep->collided[i]) ships->isAlive[i] = 0;
+    }
+}
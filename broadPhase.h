@@ -0,0 +1,39 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Sort and sweep broad phase for ship-ship collisions
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+#include "gameCalculations.h"
+
+typedef struct SweepAndPruneStruct {
+    int *order; //Ship indices sorted by the left edge of their bounding box, kept between ticks
+    int count; //Number of ships in order
+    Vector2 *min; //Bounding box of every ship for the current tick
+    Vector2 *max;
+    int *collided; //Set for ships that hit another ship this tick
+} SweepAndPrune;
+
+int allocateSweepAndPrune(SweepAndPrune *sweep, int shipCount, Arena *arena);
+void resetSweepAndPrune(SweepAndPrune *sweep);
+void checkShipCollisions(Fleet *ships, const ShipGeometry *geometry, SweepAndPrune *sweep);
+#endif //BROADPHASE_H
@@ -0,0 +1,169 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "byteBuffer.h"
+
+//Makes room for size more bytes. Returns 1 if successful and 0 if out of memory
+static int reserve(ByteBuffer *buffer, size_t size) {
+    if (buffer->failed) return 0;
+    if (buffer->size + size <= buffer->capacity) return 1;
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (capacity < buffer->size + size) capacity *= 2;
+    unsigned char *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        buffer->failed = 1;
+        return 0;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+void putBytes(ByteBuffer *buffer, const void *data, size_t size) {
+    if (!reserve(buffer, size)) return;
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+void putU8(ByteBuffer *buffer, uint8_t value) {
+    if (!reserve(buffer, 1)) return;
+    buffer->data[buffer->size++] = value;
+}
+
+void putU16(ByteBuffer *buffer, uint16_t value) {
+    putU8(buffer, value & 0xFF);
+    putU8(buffer, value >> 8);
+}
+
+void putU32(ByteBuffer *buffer, uint32_t value) {
+    putU16(buffer, value & 0xFFFF);
+    putU16(buffer, value >> 16);
+}
+
+void putU64(ByteBuffer *buffer, uint64_t value) {
+    putU32(buffer, value & 0xFFFFFFFFu);
+    putU32(buffer, value >> 32);
+}
+
+//Floats are stored as their IEEE 754 bits
+void putF32(ByteBuffer *buffer, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putU32(buffer, bits);
+}
+
+//Stores 7 bits per byte, small values take a single byte
+void putVarint(ByteBuffer *buffer, uint64_t value) {
+    while (value >= 0x80) {
+        putU8(buffer, (value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    putU8(buffer, value);
+}
+
+//Zigzag encoding keeps small negative values small too
+void putSignedVarint(ByteBuffer *buffer, int64_t value) {
+    putVarint(buffer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+void freeByteBuffer(ByteBuffer *buffer) {
+    free(buffer->data);
+    *buffer = (ByteBuffer){0};
+}
+
+ByteReader createByteReader(const void *data, size_t size) {
+    return (ByteReader){data, size, 0, 0};
+}
+
+void getBytes(ByteReader *reader, void *data, size_t size) {
+    if (reader->failed || reader->size - reader->position < size) {
+        reader->failed = 1;
+        memset(data, 0, size);
+        return;
+    }
+    memcpy(data, reader->data + reader->position, size);
+    reader->position += size;
+}
+
+uint8_t getU8(ByteReader *reader) {
+    if (reader->failed || reader->position >= reader->size) {
+        reader->failed = 1;
+        return 0;
+    }
+    return reader->data[reader->position++];
+}
+
+uint16_t getU16(ByteReader *reader) {
+    uint16_t low = getU8(reader);
+    return low | (uint16_t)getU8(reader) << 8;
+}
+
+uint32_t getU32(ByteReader *reader) {
+    uint32_t low = getU16(reader);
+    return low | (uint32_t)getU16(reader) << 16;
+}
+
+uint64_t getU64(ByteReader *reader) {
+    uint64_t low = getU32(reader);
+    return low | (uint64_t)getU32(reader) << 32;
+}
+
+float getF32(ByteReader *reader) {
+    uint32_t bits = getU32(reader);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint64_t getVarint(ByteReader *reader) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = getU8(reader);
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    reader->failed = 1; //Longer than any value that was written
+    return 0;
+}
+
+int64_t getSignedVarint(ByteReader *reader) {
+    uint64_t value = getVarint(reader);
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+//Returns the CRC-32 of the provided bytes, the same checksum zip and png files use. Works through half a byte at a time so the table stays small
+uint32_t computeCrc32(const void *data, size_t size) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const unsigned char *bytes = data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,63 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Little endian encoding of numbers into growable byte buffers, so files written on one machine read the same on any other
+#ifndef BYTEBUFFER_H
+#define BYTEBUFFER_H
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ByteBufferStruct {
+    unsigned char *data;
+    size_t size; //Bytes written
+    size_t capacity; //Bytes allocated
+    int failed; //Set if the buffer couldn't grow, everything written after that is dropped
+} ByteBuffer;
+
+typedef struct ByteReaderStruct {
+    const unsigned char *data;
+    size_t size;
+    size_t position; //Next byte to read
+    int failed; //Set if a read went past the end, every read after that returns 0
+} ByteReader;
+
+void putBytes(ByteBuffer *buffer, const void *data, size_t size);
+void putU8(ByteBuffer *buffer, uint8_t value);
+void putU16(ByteBuffer *buffer, uint16_t value);
+void putU32(ByteBuffer *buffer, uint32_t value);
+void putU64(ByteBuffer *buffer, uint64_t value);
+void putF32(ByteBuffer *buffer, float value);
+void putVarint(ByteBuffer *buffer, uint64_t value);
+void putSignedVarint(ByteBuffer *buffer, int64_t value);
+void freeByteBuffer(ByteBuffer *buffer);
+
+ByteReader createByteReader(const void *data, size_t size);
+void getBytes(ByteReader *reader, void *data, size_t size);
+uint8_t getU8(ByteReader *reader);
+uint16_t getU16(ByteReader *reader);
+uint32_t getU32(ByteReader *reader);
+uint64_t getU64(ByteReader *reader);
+float getF32(ByteReader *reader);
+uint64_t getVarint(ByteReader *reader);
+int64_t getSignedVarint(ByteReader *reader);
+uint32_t computeCrc32(const void *data, size_t size);
+#endif //BYTEBUFFER_H
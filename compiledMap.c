@@ -0,0 +1,259 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "byteBuffer.h"
+#include "compiledMap.h"
+
+_Static_assert(sizeof(MapHeader) == 104, "MapHeader must not have padding");
+_Static_assert(sizeof(MapSection) == 32, "MapSection must not have padding");
+
+static const char mapMagic[4] = {'S', 'B', 'M', 'P'}; //Start of every compiled map
+
+//Grows an array so it can hold needed elements. Returns 1 if successful and 0 if out of memory
+static int growArray(void **array, int *capacity, int needed, size_t elementSize) {
+    if (needed <= *capacity) return 1;
+    int grown = *capacity > 0 ? *capacity : 64;
+    while (grown < needed) grown *= 2;
+    void *memory = realloc(*array, grown*elementSize);
+    if (memory == NULL) return 0;
+    *array = memory;
+    *capacity = grown;
+    return 1;
+}
+
+//Adds a terrain polyline going through the provided points to the map
+void addMapPolyline(MapBuilder *builder, const Vector2 *points, int pointCount) {
+    if (builder->failed || pointCount < 2) return;
+    if (!growArray((void **)&builder->sections, &builder->sectionCapacity, builder->sectionCount + 1, sizeof(MapSection))
+        || !growArray((void **)&builder->points, &builder->pointCapacity, builder->pointCount + pointCount, sizeof(Vector2))
+        || !growArray((void **)&builder->segments, &builder->segmentCapacity, builder->segmentCount + pointCount - 1, sizeof(Line))) {
+        builder->failed = 1;
+        return;
+    }
+    MapSection *section = &builder->sections[builder->sectionCount++];
+    *section = (MapSection){points[0], points[0], builder->pointCount, pointCount, builder->segmentCount, pointCount - 1};
+    for (int i = 0; i < pointCount; i++) {
+        builder->points[builder->pointCount++] = points[i];
+        section->min = Vector2Min(section->min, points[i]);
+        section->max = Vector2Max(section->max, points[i]);
+        if (i > 0) builder->segments[builder->segmentCount++] = (Line){points[i - 1], points[i]};
+    }
+}
+
+//Frees the memory of the builder
+void freeMapBuilder(MapBuilder *builder) {
+    free(builder->sections);
+    free(builder->points);
+    free(builder->segments);
+    *builder = (MapBuilder){0};
+}
+
+//Appends an array to the file contents at the next aligned offset. Returns its offset
+static uint32_t putArray(ByteBuffer *buffer, const void *data, size_t size) {
+    static const unsigned char padding[MAP_ALIGNMENT] = {0};
+    putBytes(buffer, padding, (MAP_ALIGNMENT - buffer->size % MAP_ALIGNMENT) % MAP_ALIGNMENT);
+    uint32_t offset = buffer->size;
+    putBytes(buffer, data, size);
+    return offset;
+}
+
+//Builds the terrain grid and water mask of the map and writes everything to a compiled map file. Returns 1 if successful and 0 if not
+int writeCompiledMap(const char *fileName, const MapBuilder *builder, float cellSize) {
+    uint32_t byteOrder = MAP_BYTE_ORDER;
+    if (builder->failed || *(unsigned char *)&byteOrder != 0x04) { //Maps are only written on little endian machines, the ones the game runs on
+        printf("Failed to compile the map\n");
+        return 0;
+    }
+    TerrainGrid grid;
+    if (!buildTerrainGrid(&grid, builder->segments, builder->segmentCount, cellSize)) {
+        printf("Failed to build the terrain grid\n");
+        return 0;
+    }
+    int cellCount = grid.columns*grid.rows;
+    MapHeader header = {{0}, MAP_VERSION, MAP_BYTE_ORDER, 0, grid.origin, grid.cellSize, grid.columns, grid.rows,
+                        WATER_CELL_SIZE, grid.waterColumns, grid.waterRows, TERRAIN_DISTANCE_CELL_SIZE, grid.distanceColumns, grid.distanceRows,
+                        builder->sectionCount, builder->pointCount, builder->segmentCount, grid.cellStart[cellCount]};
+    memcpy(header.magic, mapMagic, sizeof(mapMagic));
+    ByteBuffer buffer = {0};
+    putBytes(&buffer, &header, sizeof(header)); //Written again once the offsets are known
+    header.sectionOffset = putArray(&buffer, builder->sections, builder->sectionCount*sizeof(MapSection));
+    header.pointOffset = putArray(&buffer, builder->points, builder->pointCount*sizeof(Vector2));
+    header.segmentOffset = putArray(&buffer, grid.segments, grid.segmentCount*sizeof(Line));
+    header.cellStartOffset = putArray(&buffer, grid.cellStart, (cellCount + 1)*sizeof(int));
+    header.cellSegmentOffset = putArray(&buffer, grid.cellSegments, header.cellEntryCount*sizeof(int));
+    header.waterOffset = putArray(&buffer, grid.water, (size_t)grid.waterColumns*grid.waterRows);
+    header.distanceOffset = putArray(&buffer, grid.distance, (size_t)grid.distanceColumns*grid.distanceRows*sizeof(float));
+    header.fileSize = buffer.size;
+    freeTerrainGrid(&grid);
+    if (!buffer.failed) memcpy(buffer.data, &header, sizeof(header));
+
+    FILE *f = fopen(fileName, "wb");
+    int written = f != NULL && !buffer.failed && fwrite(buffer.data, 1, buffer.size, f) == buffer.size;
+    if (f != NULL && fclose(f) != 0) written = 0;
+    if (!written) perror("Failed to write the compiled map");
+    freeByteBuffer(&buffer);
+    return written;
+}
+
+//Checks that an array of the file lies inside it and is aligned. Returns 1 if it does and 0 if not
+static int checkArray(const CompiledMap *map, uint32_t offset, uint64_t count, size_t elementSize) {
+    return offset % MAP_ALIGNMENT == 0 && offset >= sizeof(MapHeader) && offset <= map->size && count*elementSize <= map->size - offset;
+}
+
+//Checks every count, offset and index of the file, so a damaged file can't make the game read outside it. Returns 1 if the file is valid and 0 if not
+static int validateMap(const CompiledMap *map) {
+    const MapHeader *header = map->header;
+    if (map->size < sizeof(MapHeader) || memcmp(header->magic, mapMagic, 4) != 0 || header->version != MAP_VERSION
+        || header->byteOrder != MAP_BYTE_ORDER || header->fileSize != map->size) return 0;
+    uint64_t cellCount = (uint64_t)header->columns*header->rows;
+    uint64_t waterCellCount = (uint64_t)header->waterColumns*header->waterRows;
+    uint64_t distanceSampleCount = (uint64_t)header->distanceColumns*header->distanceRows;
+    if (!(header->cellSize > 0) || header->columns == 0 || header->rows == 0 || header->waterCellSize != WATER_CELL_SIZE
+        || header->distanceCellSize != TERRAIN_DISTANCE_CELL_SIZE || header->distanceColumns < 2 || header->distanceRows < 2
+        || header->sectionCount > INT32_MAX || header->pointCount > INT32_MAX || header->segmentCount > INT32_MAX || header->cellEntryCount > INT32_MAX
+        || !checkArray(map, header->sectionOffset, header->sectionCount, sizeof(MapSection))
+        || !checkArray(map, header->pointOffset, header->pointCount, sizeof(Vector2))
+        || !checkArray(map, header->segmentOffset, header->segmentCount, sizeof(Line))
+        || !checkArray(map, header->cellStartOffset, cellCount + 1, sizeof(int))
+        || !checkArray(map, header->cellSegmentOffset, header->cellEntryCount, sizeof(int))
+        || !checkArray(map, header->waterOffset, waterCellCount, 1)
+        || !checkArray(map, header->distanceOffset, distanceSampleCount, sizeof(float))) return 0;
+    //Polylines must use points and segments that exist
+    const MapSection *sections = (const MapSection *)(map->data + header->sectionOffset);
+    for (uint32_t i = 0; i < header->sectionCount; i++) {
+        const MapSection *section = &sections[i];
+        if (section->pointCount < 2 || section->segmentCount != section->pointCount - 1
+            || section->firstPoint > header->pointCount - section->pointCount || section->firstSegment > header->segmentCount - section->segmentCount) return 0;
+    }
+    //Grid cells must cover the entry list in order and point at segments that exist
+    const int *cellStart = (const int *)(map->data + header->cellStartOffset);
+    const int *cellSegments = (const int *)(map->data + header->cellSegmentOffset);
+    if (cellStart[0] != 0 || (uint32_t)cellStart[cellCount] != header->cellEntryCount) return 0;
+    for (uint64_t cell = 0; cell < cellCount; cell++) {
+        if (cellStart[cell] > cellStart[cell + 1]) return 0;
+    }
+    for (uint32_t i = 0; i < header->cellEntryCount; i++) {
+        if ((uint32_t)cellSegments[i] >= header->segmentCount) return 0;
+    }
+    return 1;
+}
+
+//Maps the file into memory, or reads it if it can't be mapped. Returns 1 if successful and 0 if not
+static int mapFile(CompiledMap *map, const char *fileName) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        void *data = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (data != NULL) {
+            map->data = data;
+            map->size = size.QuadPart;
+            map->isMapped = 1;
+            map->fileHandle = file;
+            map->mappingHandle = mapping;
+            return 1;
+        }
+        if (mapping != NULL) CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+    int file = open(fileName, O_RDONLY);
+    struct stat status;
+    if (file >= 0 && fstat(file, &status) == 0 && status.st_size > 0) {
+        void *data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED) {
+            close(file); //The mapping stays valid after the file is closed
+            map->data = data;
+            map->size = status.st_size;
+            map->isMapped = 1;
+            return 1;
+        }
+    }
+    if (file >= 0) close(file);
+#endif
+    //Mapping isn't available everywhere, fall back to reading the whole file
+    FILE *f = fopen(fileName, "rb");
+    if (f == NULL) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    map->data = size > 0 ? malloc(size) : NULL;
+    map->size = map->data != NULL && fread(map->data, 1, size, f) == (size_t)size ? size : 0;
+    fclose(f);
+    return map->size > 0;
+}
+
+//Opens a compiled map and points the terrain grid at its arrays, nothing is copied. The map has to stay open while the grid is used.
+//Returns 1 if successful and 0 if the file is missing or damaged
+int openCompiledMap(CompiledMap *map, const char *fileName, TerrainGrid *grid) {
+    *map = (CompiledMap){0};
+    if (!mapFile(map, fileName)) {
+        perror("Failed to open the map");
+        return 0;
+    }
+    map->header = (const MapHeader *)map->data;
+    if (!validateMap(map)) {
+        printf("%s is not a valid compiled map\n", fileName);
+        closeCompiledMap(map);
+        return 0;
+    }
+    const MapHeader *header = map->header;
+    map->sections = (const MapSection *)(map->data + header->sectionOffset);
+    map->points = (const Vector2 *)(map->data + header->pointOffset);
+    map->sectionCount = header->sectionCount;
+    //The grid only reads its arrays, so they can point into the read only mapping
+    *grid = (TerrainGrid){header->origin, header->cellSize, header->columns, header->rows,
+                          (int *)(map->data + header->cellStartOffset), (int *)(map->data + header->cellSegmentOffset),
+                          (Line *)(map->data + header->segmentOffset), header->segmentCount,
+                          map->data + header->waterOffset, header->waterColumns, header->waterRows,
+                          (float *)(map->data + header->distanceOffset), header->distanceColumns, header->distanceRows, 1};
+    return 1;
+}
+
+//Unmaps the file. Grids pointing into it can no longer be used
+void closeCompiledMap(CompiledMap *map) {
+    if (map->isMapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(map->data);
+        CloseHandle(map->mappingHandle);
+        CloseHandle(map->fileHandle);
+#else
+        munmap(map->data, map->size);
+#endif
+    }
+    else free(map->data);
+    *map = (CompiledMap){0};
+}
@@ -0,0 +1,100 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Compiled map files. The terrain polylines, their bounding boxes, the terrain grid, the water mask and the distance field are stored
+//ready to use, so a map is opened by mapping the file into memory and checking it instead of building anything
+#ifndef COMPILEDMAP_H
+#define COMPILEDMAP_H
+#include <stdint.h>
+#include "terrainGrid.h"
+#define MAP_VERSION 3 //Version 2 marks the land inside islands in the water mask, version 3 adds the distance field
+#define MAP_ALIGNMENT 32 //Every array in the file starts on this boundary
+#define MAP_BYTE_ORDER 0x01020304u //Stored as written, so files from a machine with another byte order are rejected
+
+typedef struct MapSectionStruct {
+    Vector2 min; //Bounding box of the polyline
+    Vector2 max;
+    uint32_t firstPoint; //Index of the first point of the polyline
+    uint32_t pointCount;
+    uint32_t firstSegment; //Index of the segment between the first two points, segments follow the points in order
+    uint32_t segmentCount; //Always pointCount - 1
+} MapSection; //A terrain polyline
+
+typedef struct MapHeaderStruct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder; //MAP_BYTE_ORDER
+    uint32_t fileSize;
+    Vector2 origin; //Terrain grid
+    float cellSize;
+    uint32_t columns;
+    uint32_t rows;
+    float waterCellSize; //Water mask
+    uint32_t waterColumns;
+    uint32_t waterRows;
+    float distanceCellSize; //Distance field
+    uint32_t distanceColumns;
+    uint32_t distanceRows;
+    uint32_t sectionCount;
+    uint32_t pointCount;
+    uint32_t segmentCount;
+    uint32_t cellEntryCount; //Entries of the grid's cellSegments
+    uint32_t sectionOffset; //File offsets of every array
+    uint32_t pointOffset;
+    uint32_t segmentOffset;
+    uint32_t cellStartOffset;
+    uint32_t cellSegmentOffset;
+    uint32_t waterOffset;
+    uint32_t distanceOffset;
+} MapHeader;
+
+typedef struct CompiledMapStruct {
+    unsigned char *data; //The whole file
+    size_t size;
+    int isMapped; //0 if the file couldn't be mapped and was read into memory instead
+    void *fileHandle; //Windows handles of the mapping
+    void *mappingHandle;
+    const MapHeader *header;
+    const MapSection *sections;
+    const Vector2 *points;
+    int sectionCount;
+} CompiledMap;
+
+typedef struct MapBuilderStruct {
+    MapSection *sections;
+    int sectionCount;
+    int sectionCapacity;
+    Vector2 *points;
+    int pointCount;
+    int pointCapacity;
+    Line *segments; //Segments between consecutive points of every polyline
+    int segmentCount;
+    int segmentCapacity;
+    int failed; //Set if the builder ran out of memory
+} MapBuilder;
+
+void addMapPolyline(MapBuilder *builder, const Vector2 *points, int pointCount);
+void freeMapBuilder(MapBuilder *builder);
+int writeCompiledMap(const char *fileName, const MapBuilder *builder, float cellSize);
+int openCompiledMap(CompiledMap *map, const char *fileName, TerrainGrid *grid);
+void closeCompiledMap(CompiledMap *map);
+#endif //COMPILEDMAP_H
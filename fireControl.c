@@ -0,0 +1,112 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+
+#include "fireControl.h"
+
+//Returns the largest real root of x^3 + a x^2 + b x + c = 0
+static double largestCubicRoot(double a, double b, double c) {
+    //Substitute x = t - a/3 to get t^3 + p t + q = 0
+    double p = b - a*a/3;
+    double q = 2*a*a*a/27 - a*b/3 + c;
+    double shift = -a/3;
+    double discriminant = q*q/4 + p*p*p/27;
+    if (discriminant > 0) { //One real root
+        double root = sqrt(discriminant);
+        return cbrt(-q/2 + root) + cbrt(-q/2 - root) + shift;
+    }
+    if (p == 0) return shift; //Triple root
+    //Three real roots, the largest one comes from the trigonometric form
+    double r = sqrt(-p/3);
+    double phi = acos(fmax(-1, fmin(1, -q/(2*r*r*r))));
+    return 2*r*cos(phi/3) + shift;
+}
+
+//Finds the real roots of the depressed quartic x^4 + p x^2 + q x + r = 0 with Ferrari's method. Returns the number of roots written to roots
+static int solveDepressedQuartic(double p, double q, double r, double roots[4]) {
+    int count = 0;
+    if (fabs(q) < 1e-12) { //Biquadratic, solve for x^2
+        double discriminant = p*p - 4*r;
+        if (discriminant < 0) return 0;
+        double squares[2] = {(-p - sqrt(discriminant))/2, (-p + sqrt(discriminant))/2};
+        for (int i = 0; i < 2; i++) {
+            if (squares[i] < 0) continue;
+            roots[count++] = -sqrt(squares[i]);
+            roots[count++] = sqrt(squares[i]);
+        }
+        return count;
+    }
+    //Resolvent cubic m^3 + p m^2 + (p^2/4 - r) m - q^2/8 = 0 always has a positive root when q isn't 0
+    double m = largestCubicRoot(p, p*p/4 - r, -q*q/8);
+    if (m <= 0) return 0;
+    double s = sqrt(2*m);
+    for (int sign = -1; sign <= 1; sign += 2) {
+        //x = (sign*s +- sqrt(-(2p + 2m + sign*sqrt(2)*q/sqrt(m))))/2
+        double inner = -(2*p + 2*m + sign*M_SQRT2*q/sqrt(m));
+        if (inner < 0) continue;
+        roots[count++] = (sign*s - sqrt(inner))/2;
+        roots[count++] = (sign*s + sqrt(inner))/2;
+    }
+    return count;
+}
+
+//Returns the heading and elevation that make a projectile fired from the shooter reach the target when it crosses AIM_HEIGHT.
+//The target moves with the provided velocity while the projectile flies. The flight time t solves
+//g^2/4 t^4 + (|v|^2 - P^2 + g dh) t^2 + 2 (D.v) t + |D|^2 + dh^2 = 0
+//where D is the offset to the target, v its velocity, P the projectile speed and dh the height difference, so no search is needed.
+//The shortest flight time gives the flat shot and the longest one the high arc
+FiringSolution solveFiringSolution(Vector2 shooter, Vector2 target, Vector2 targetVelocity, int highArc) {
+    Vector2 offset = Vector2Subtract(target, shooter);
+    double heightDifference = AIM_HEIGHT - LAUNCH_HEIGHT;
+    double a = GRAVITY*GRAVITY/4.0; //Divide every coefficient by the t^4 one
+    double p = (Vector2DotProduct(targetVelocity, targetVelocity) - PROJECTILE_SPEED*PROJECTILE_SPEED + GRAVITY*heightDifference)/a;
+    double q = 2*Vector2DotProduct(offset, targetVelocity)/a;
+    double r = (Vector2DotProduct(offset, offset) + heightDifference*heightDifference)/a;
+    double roots[4];
+    int rootCount = solveDepressedQuartic(p, q, r, roots);
+    double flightTime = -1;
+    for (int i = 0; i < rootCount; i++) {
+        if (roots[i] <= 0) continue;
+        //Both elevations must be usable, fired upwards and not past vertical
+        double rise = heightDifference + GRAVITY*roots[i]*roots[i]/2;
+        if (rise < 0) continue; //Would need to be fired downwards
+        if (flightTime < 0 || (highArc ? roots[i] > flightTime : roots[i] < flightTime)) flightTime = roots[i];
+    }
+    FiringSolution solution;
+    if (flightTime < 0) { //Out of reach, fire at the target's current position at the elevation with the longest range
+        solution.heading = atan2f(offset.y, offset.x);
+        solution.angle = Vector2Length(offset) < PROJECTILE_SPEED ? 0 : M_PI/4; //Too close for any upward shot, or too far for the longest one
+        solution.flightTime = 0;
+        solution.impact = target;
+        solution.reachable = 0;
+        return solution;
+    }
+    Vector2 impact = Vector2Add(target, Vector2Scale(targetVelocity, flightTime));
+    Vector2 travel = Vector2Subtract(impact, shooter);
+    solution.heading = atan2f(travel.y, travel.x);
+    solution.angle = atan2(heightDifference + GRAVITY*flightTime*flightTime/2, Vector2Length(travel));
+    solution.flightTime = flightTime;
+    solution.impact = impact;
+    solution.reachable = 1;
+    return solution;
+}
@@ -0,0 +1,39 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Closed form aiming of projectiles at ships
+#ifndef FIRECONTROL_H
+#define FIRECONTROL_H
+#define LAUNCH_HEIGHT 10.0f //Height projectiles are fired from
+#define AIM_HEIGHT 5.0f //Height the solver aims to cross the target's center at, inside the hit window
+#include "gameCalculations.h"
+
+typedef struct FiringSolutionStruct {
+    float heading; //Direction to fire towards in radians
+    float angle; //Elevation in radians
+    float flightTime; //Time until the projectile reaches the target
+    Vector2 impact; //Where the target will be when the projectile reaches it
+    int reachable; //0 if the target is out of range or too close, the heading and angle then get as close as possible
+} FiringSolution;
+
+FiringSolution solveFiringSolution(Vector2 shooter, Vector2 target, Vector2 targetVelocity, int highArc);
+#endif //FIRECONTROL_H
@@ -21,240 +21,325 @@ Copyright (C) 2025 EverTech1, georgerafa
 
 
 #include <math.h>
-#include "raylib.h"
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include "gameCalculations.h"
+#include "terrainGrid.h"
 
-typedef struct ShipStruct Ship;
-typedef struct ProjectileStruct Projectile;
+//Allocates the arrays of a fleet from the provided arena. Returns 1 if successful and 0 if the arena is full
+int allocateFleet(Fleet *ships, int shipCount, Arena *arena) {
+    ships->count = shipCount;
+    ships->positionX = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->positionY = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->speed = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->heading = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->aimHeading = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->aimAngle = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->velocityX = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->velocityY = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->distanceMovedX = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->distanceMovedY = arenaAlloc(arena, shipCount*sizeof(float));
+    ships->isAlive = arenaAlloc(arena, shipCount*sizeof(int));
+    ships->team = arenaAlloc(arena, shipCount*sizeof(int));
+    return ships->team != NULL;
+}
 
-//The 6 spawn positions on the map
-struct {
-    Vector2 position;
-    float heading;
-} spawnPositions[6] = {
-    {
-        (Vector2){1432, 1068},
-        3*M_PI/2 - M_PI/6
-    },{
-        (Vector2){730, 297},
-        M_PI/3
-    },{
-        (Vector2){683, 1067},
-        -M_PI/4
-    },{
-        (Vector2){1656, 772},
-        M_PI
-    },{
-        (Vector2){470, 780},
+//Allocates a projectile pool with the provided capacity from the provided arena. Returns 1 if successful and 0 if the arena is full
+int allocateProjectiles(ProjectileList *projectiles, int capacity, Arena *arena) {
+    projectiles->capacity = capacity;
+    projectiles->positionX = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->positionY = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->positionZ = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->speedX = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->speedY = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->speedZ = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->team = arenaAlloc(arena, capacity*sizeof(int));
+    projectiles->target = arenaAlloc(arena, capacity*sizeof(int));
+    projectiles->impactTime = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->landingTime = arenaAlloc(arena, capacity*sizeof(float));
+    projectiles->slot = arenaAlloc(arena, capacity*sizeof(int));
+    projectiles->index = arenaAlloc(arena, capacity*sizeof(int));
+    projectiles->freeSlots = arenaAlloc(arena, capacity*sizeof(int));
+    if (projectiles->freeSlots == NULL) return 0;
+    clearProjectiles(projectiles);
+    return 1;
+}
 
-    },{
-        (Vector2){1466, 378},
-        M_PI-M_PI/6
+//Retires every projectile and puts all slots back on the free stack
+void clearProjectiles(ProjectileList *projectiles) {
+    projectiles->count = 0;
+    projectiles->freeCount = projectiles->capacity;
+    for (int i = 0; i < projectiles->capacity; i++) {
+        projectiles->freeSlots[i] = projectiles->capacity - 1 - i; //Slot 0 is handed out first
     }
-};
+}
 
-//Calculate the height of the projectile for the provided x value
-int getLinePoint(Projectile p, int x) {
-    float t = x/(PROJECTILE_SPEED*cosf(p.angle));
-    return (int)(10 + sinf(p.angle)*PROJECTILE_SPEED*t - 0.5*GRAVITY*t*t);
+//Launches a projectile. Returns the slot it was given, or -1 if the pool is full
+int spawnProjectile(ProjectileList *projectiles, Vector3 position, Vector3 speed, int team) {
+    if (projectiles->freeCount == 0) return -1;
+    int slot = projectiles->freeSlots[--projectiles->freeCount];
+    int i = projectiles->count++; //New projectiles go at the end of the packed arrays
+    projectiles->positionX[i] = position.x;
+    projectiles->positionY[i] = position.y;
+    projectiles->positionZ[i] = position.z;
+    projectiles->speedX[i] = speed.x;
+    projectiles->speedY[i] = speed.y;
+    projectiles->speedZ[i] = speed.z;
+    projectiles->team[i] = team;
+    projectiles->target[i] = -1; //Not known until the impact is scheduled
+    projectiles->impactTime[i] = INFINITY;
+    projectiles->landingTime[i] = INFINITY;
+    projectiles->slot[i] = slot;
+    projectiles->index[slot] = i;
+    return slot;
 }
 
-//Updates the positions of the ships provided based on their current position, speed, and time passed (deltaT in seconds) since last update;
-void updateShipPositions(Ship *ships, int shipCount, float deltaT) {
-    for (int i = 0; i < shipCount; i++) {
-        Vector2 oldPos = ships[i].position;
-        float speedX = cosf(ships[i].heading)*ships[i].speed; //Calculate speed on the X axis
-        float speedY = sinf(ships[i].heading)*ships[i].speed; //Calculate speed on the Y axis
-        ships[i].position.x += speedX*deltaT; //Adjust X position
-        ships[i].position.y += speedY*deltaT; //Adjust Y position
-        ships[i].distanceMoved = Vector2Add(Vector2Subtract(ships[i].position, oldPos), ships[i].distanceMoved);
-    }
+//Removes the projectile at the provided index by moving the last projectile into its place
+void retireProjectile(ProjectileList *projectiles, int projectile) {
+    int last = --projectiles->count;
+    projectiles->freeSlots[projectiles->freeCount++] = projectiles->slot[projectile];
+    if (projectile == last) return;
+    projectiles->positionX[projectile] = projectiles->positionX[last];
+    projectiles->positionY[projectile] = projectiles->positionY[last];
+    projectiles->positionZ[projectile] = projectiles->positionZ[last];
+    projectiles->speedX[projectile] = projectiles->speedX[last];
+    projectiles->speedY[projectile] = projectiles->speedY[last];
+    projectiles->speedZ[projectile] = projectiles->speedZ[last];
+    projectiles->team[projectile] = projectiles->team[last];
+    projectiles->target[projectile] = projectiles->target[last];
+    projectiles->impactTime[projectile] = projectiles->impactTime[last];
+    projectiles->landingTime[projectile] = projectiles->landingTime[last];
+    projectiles->slot[projectile] = projectiles->slot[last];
+    projectiles->index[projectiles->slot[projectile]] = projectile;
 }
 
-//Initializes the ships provided by setting their heading and speed values to 0 as well as setting their initial position
-void initializeShips(Ship *ships, int shipCount) {
-    for (int i = 0; i < shipCount; i++) {
-        ships[i] = (Ship){i, spawnPositions[i].position, 0, spawnPositions[i].heading, 1, 0};  // Initialize ships with offset positions
-    }
+//Returns a copy of the state of a single ship
+Ship getShip(const Fleet *ships, int ship) {
+    return (Ship){
+        ships->team[ship],
+        {ships->positionX[ship], ships->positionY[ship]},
+        ships->speed[ship],
+        ships->heading[ship],
+        ships->isAlive[ship],
+        {ships->distanceMovedX[ship], ships->distanceMovedY[ship]}
+    };
 }
 
-//Reset projectile angle and heading back to 0
-void resetProjectiles(Projectile *projectiles, int projectileCount) {
-    for (int i = 0; i < projectileCount; i++) {
-        projectiles[i].angle = 0;
-        projectiles[i].heading = 0;
-    }
+//Returns a copy of the state of a single projectile. Its heading and angle are those of its current direction of travel
+Projectile getProjectile(const ProjectileList *projectiles, int projectile) {
+    Vector3 speed = {projectiles->speedX[projectile], projectiles->speedY[projectile], projectiles->speedZ[projectile]};
+    return (Projectile){
+        projectiles->team[projectile],
+        {projectiles->positionX[projectile], projectiles->positionY[projectile], projectiles->positionZ[projectile]},
+        speed,
+        atan2f(speed.y, speed.x),
+        atan2f(speed.z, sqrtf(speed.x*speed.x + speed.y*speed.y))
+    };
 }
 
-//Initialize all projectiles by setting their speed based on heading and angle and also set their z position to 10 if their origin ship is alive and -10 if their origin ship is dead
-void initializeProjectiles(Projectile *projectiles, Ship ships[], int playerCount) { //Initialize the provided projectiles by setting calculating their speed on each axis based on where they are looking
-    for (int i = 0; i < playerCount; i++) {
-        projectiles[i].speed.x = cosf(projectiles[i].heading)*cosf(projectiles[i].angle)*PROJECTILE_SPEED;
-        projectiles[i].speed.y = sinf(projectiles[i].heading)*cosf(projectiles[i].angle)*PROJECTILE_SPEED;
-        projectiles[i].speed.z = sinf(projectiles[i].angle)*PROJECTILE_SPEED;
-        projectiles[i].position.z = 10-20*(1-ships[i].isAlive);
-        projectiles[i].team = i;
-    }
+//Checks if two line segments intersect. Returns 1 if they do and 0 if they don't
+int checkLineCollision(Vector2 startA, Vector2 endA, Vector2 startB, Vector2 endB) {
+    Vector2 dirA = Vector2Subtract(endA, startA); //Direction of the first segment
+    Vector2 dirB = Vector2Subtract(endB, startB); //Direction of the second segment
+    float div = dirA.x*dirB.y - dirA.y*dirB.x;
+    if (fabsf(div) < 1e-6f) return 0; //Parallel segments are never reported as colliding
+    Vector2 offset = Vector2Subtract(startB, startA);
+    float t = (offset.x*dirB.y - offset.y*dirB.x)/div; //Intersection position along the first segment
+    float u = (offset.x*dirA.y - offset.y*dirA.x)/div; //Intersection position along the second segment
+    return t >= 0 && t <= 1 && u >= 0 && u <= 1;
 }
 
-//Update the projectiles' speeds and positions while also applying gravity
-void updateProjectiles(Projectile *projectiles, int projectileCount, float deltaT) {
-    for (int i = 0; i < projectileCount; i++) {
-        Projectile projectile = projectiles[i];
-        if (projectiles[i].position.z > 0) {
-            projectiles[i].position = (Vector3){projectile.position.x+projectile.speed.x*deltaT, projectile.position.y+projectile.speed.y*deltaT, projectile.position.z+projectile.speed.z*deltaT};
-            projectiles[i].speed.z -= GRAVITY*deltaT;
-        }
-    }
+//Checks if a circle touches a line segment. Returns 1 if it does and 0 if it doesn't
+int checkCircleLineCollision(Vector2 center, float radius, Vector2 start, Vector2 end) {
+    Vector2 dir = Vector2Subtract(end, start);
+    float lengthSqr = Vector2LengthSqr(dir);
+    float t = lengthSqr > 0 ? Vector2DotProduct(Vector2Subtract(center, start), dir)/lengthSqr : 0; //Closest point along the segment
+    t = Clamp(t, 0, 1);
+    Vector2 closest = Vector2Add(start, Vector2Scale(dir, t));
+    return Vector2LengthSqr(Vector2Subtract(center, closest)) <= radius*radius;
 }
 
-//Checks if the provided ship is colliding with any terrain. Returns 1 if it detects collision and 0 if it doesn't
-int checkTerrainCollision(Ship ship, struct CollisionSection sections[], int sectionCount){
-    Vector2 shipPos = ship.position;//Position of the provided ship
-    Line shipLines[4] = { //The line segments that make up the hitbox of the ship
-        {
-            {(-40*cosf(ship.heading)-15*sinf(ship.heading)+shipPos.x),(-40*sinf(ship.heading)+15*cosf(ship.heading)+shipPos.y)},
-           {(40*cosf(ship.heading)-15*sinf(ship.heading)+shipPos.x),(40*sinf(ship.heading)+15*cosf(ship.heading)+shipPos.y)}
-        },
-        {
-            {(-40*cosf(ship.heading)+15*sinf(ship.heading)+shipPos.x), (-40*sinf(ship.heading)-15*cosf(ship.heading)+shipPos.y)},
-            {(40*cosf(ship.heading)+15*sinf(ship.heading)+shipPos.x), (40*sinf(ship.heading)-15*cosf(ship.heading)+shipPos.y)}
-        },
-        {
-            {(-40*cosf(ship.heading)-15*sinf(ship.heading)+shipPos.x), (-40*sinf(ship.heading)+15*cosf(ship.heading)+shipPos.y)},
-            {(-40*cosf(ship.heading)+15*sinf(ship.heading)+shipPos.x), (-40*sinf(ship.heading)-15*cosf(ship.heading)+shipPos.y)}
-        },
-        {
-            {40*cosf(ship.heading)-15*sinf(ship.heading)+shipPos.x, 40*sinf(ship.heading)+15*cosf(ship.heading)+shipPos.y},
-            {(40*cosf(ship.heading)+15*sinf(ship.heading)+shipPos.x), (40*sinf(ship.heading)-15*cosf(ship.heading)+shipPos.y)}
-        }
-    };
+//Calculate the height of the projectile for the provided x value
+int getLinePoint(float angle, int x) {
+    float t = x/(PROJECTILE_SPEED*cosf(angle));
+    return (int)(10 + sinf(angle)*PROJECTILE_SPEED*t - 0.5*GRAVITY*t*t);
+}
+
+//Returns the heading of a ship spawned at the provided position. Ships face the middle of the map, or along the x axis when packed in tight rows
+static float getSpawnHeading(Vector2 position, Vector2 mapBounds, int packed) {
+    Vector2 center = Vector2Scale(mapBounds, 0.5f);
+    if (packed) return position.x < center.x ? 0 : M_PI;
+    return atan2f(center.y - position.y, center.x - position.x);
+}
 
-    for (int i = 0; i < sectionCount; i++) {//Iterate through all obstacles
-        struct CollisionSection section = sections[i]; //Current obstacle
-        Vector2 centerPos = section.centerPosition; //Obstacle offset from (0,0)
-        //If the distance, between the ship and the obstacle, is less than 200 pixels check for collision
-        if(Vector2Length(Vector2Subtract(centerPos,ship.position)) < (float)section.minimumDistance) {
-            //Iterate through section hitbox lines
-            for (int j = 0; j<10; j++) {
-                //Temporary collision point variable
-                Vector2 colP;
-                //Iterate through ship hitbox lines
-                for (int k = 0; k<4; k++) {
-                    //If there is a collision between the terrain and ship lines then return 1
-                    if (CheckCollisionLines(
-                    section.Lines[j].start, //Island line start point
-                    section.Lines[j].end, //Island line end point
-                    shipLines[k].start, //Ship line start point
-                    shipLines[k].end, //Ship line end point
-                        &colP)) //Collision point variable
-                        return 1;
-                }
+//Finds every position on a lattice where a ship can spawn on open water. Returns the number of positions found
+static int findSpawnCandidates(const TerrainGrid *terrain, Vector2 mapBounds, float rowSpacing, Vector2 *candidates, int capacity) {
+    int count = 0;
+    for (float y = SPAWN_SPACING/2; y < mapBounds.y - SPAWN_SPACING/2; y += rowSpacing) {
+        for (float x = SPAWN_SPACING/2; x < mapBounds.x - SPAWN_SPACING/2 && count < capacity; x += SPAWN_SPACING) {
+            Vector2 position = {x, y};
+            //Try the ship at that spot and make sure its whole hitbox is on water and clear of the coast
+            float heading = getSpawnHeading(position, mapBounds, rowSpacing < SPAWN_SPACING);
+            Fleet ship = {.count = 1, .positionX = &position.x, .positionY = &position.y, .heading = &heading};
+            ShipGeometry geometry;
+            updateShipGeometry(&ship, &geometry);
+            int open = isWater(terrain, position) && !checkTerrainCollision(&geometry, terrain);
+            for (int k = 0; k < 4 && open; k++) {
+                open = isWater(terrain, geometry.corners[k]);
             }
+            if (open) candidates[count++] = position;
         }
     }
-    return 0; //Return 0 if no collision is detected
+    return count;
 }
 
-//Check if the provided ship has been hit by any projectiles
-int checkProjectileCollision(Ship ship, Projectile *projectiles, int playerCount) {
-    Vector2 shipPos = ship.position;//Position of the provided ship
-    if (ship.isAlive==0) return 0;
-    Line shipLines[4] = { //The line segments that make up the hitbox of the ship
-        {
-            {-40*cosf(ship.heading)-15*sinf(ship.heading)+shipPos.x,-40*sinf(ship.heading)+15*cosf(ship.heading)+shipPos.y},
-           {40*cosf(ship.heading)-15*sinf(ship.heading)+shipPos.x,40*sinf(ship.heading)+15*cosf(ship.heading)+shipPos.y}
-        },
-        {
-            {-40*cosf(ship.heading)-7*sinf(ship.heading)+shipPos.x,-40*sinf(ship.heading)+7*cosf(ship.heading)+shipPos.y},
-            {40*cosf(ship.heading)-7*sinf(ship.heading)+shipPos.x, 40*sinf(ship.heading)+7*cosf(ship.heading)+shipPos.y}
-        },
-        {
-            {-40*cosf(ship.heading)+7*sinf(ship.heading)+shipPos.x, -40*sinf(ship.heading)-7*cosf(ship.heading)+shipPos.y},
-            {40*cosf(ship.heading)+7*sinf(ship.heading)+shipPos.x, 40*sinf(ship.heading)-7*cosf(ship.heading)+shipPos.y}
-        },
-        {
-            {-40*cosf(ship.heading)+15*sinf(ship.heading)+shipPos.x, -40*sinf(ship.heading)-15*cosf(ship.heading)+shipPos.y},
-            {40*cosf(ship.heading)+15*sinf(ship.heading)+shipPos.x, 40*sinf(ship.heading)-15*cosf(ship.heading)+shipPos.y}
+//Places the ships on generated spawn positions spread as far apart as possible, sets their speed to 0 and makes them alive.
+//Ships that don't fit on the open water of the map start destroyed
+void initializeShips(Fleet *ships, const TerrainGrid *terrain, Vector2 mapBounds) {
+    int capacity = (int)(mapBounds.x/SPAWN_SPACING + 1)*(int)(mapBounds.y/(SPAWN_SPACING/2) + 1);
+    Vector2 *candidates = malloc(capacity*sizeof(Vector2));
+    float *nearest = malloc(capacity*sizeof(float)); //Distance from every candidate to the closest picked position
+    int candidateCount = 0;
+    float rowSpacing = SPAWN_SPACING;
+    if (candidates != NULL && nearest != NULL) {
+        candidateCount = findSpawnCandidates(terrain, mapBounds, rowSpacing, candidates, capacity);
+        if (candidateCount < ships->count) { //Pack the ships into tighter rows if there isn't enough room
+            rowSpacing = SPAWN_SPACING/2;
+            candidateCount = findSpawnCandidates(terrain, mapBounds, rowSpacing, candidates, capacity);
         }
-    };
-    for (int i = 0; i < playerCount; i++) {
-        Projectile projectile = projectiles[i]; //Current projectile
-        for (int j = 0; j < 4; j++) {
-            //Check for collision
-            //The projectile can only hit a ship if it is at a height of 15 or below
-            if (CheckCollisionCircleLine((Vector2){projectile.position.x, projectile.position.y}, 15, shipLines[i].start, shipLines[i].end)&&projectile.position.z<15&&projectile.position.z>0&&projectile.team!=ship.team) {
-                projectiles[i].position.z = -10;//If a ship has been hit set its height to -10
-                return 1;
-            }
+    }
+    //Start from the candidate furthest from the middle of the map
+    Vector2 center = Vector2Scale(mapBounds, 0.5f);
+    int pick = 0;
+    for (int i = 0; i < candidateCount; i++) {
+        nearest[i] = INFINITY;
+        if (Vector2DistanceSqr(candidates[i], center) > Vector2DistanceSqr(candidates[pick], center)) pick = i;
+    }
+    for (int i = 0; i < ships->count; i++) {
+        ships->team[i] = i;
+        ships->speed[i] = 0;
+        ships->aimHeading[i] = 0;
+        ships->aimAngle[i] = 0;
+        ships->velocityX[i] = 0;
+        ships->velocityY[i] = 0;
+        ships->distanceMovedX[i] = 0;
+        ships->distanceMovedY[i] = 0;
+        ships->isAlive[i] = i < candidateCount;
+        if (i >= candidateCount) { //No room left for this ship
+            ships->positionX[i] = -1000;
+            ships->positionY[i] = -1000;
+            ships->heading[i] = 0;
+            continue;
+        }
+        ships->positionX[i] = candidates[pick].x;
+        ships->positionY[i] = candidates[pick].y;
+        ships->heading[i] = getSpawnHeading(candidates[pick], mapBounds, rowSpacing < SPAWN_SPACING);
+        //Pick the next position as the candidate furthest from every position picked so far
+        int next = pick;
+        for (int j = 0; j < candidateCount; j++) {
+            nearest[j] = fminf(nearest[j], Vector2DistanceSqr(candidates[j], candidates[pick]));
+            if (nearest[j] > nearest[next]) next = j;
+        }
+        pick = next;
+    }
+    free(candidates);
+    free(nearest);
+}
+
+//Every alive ship fires volleySize projectiles from a height of 10, fanned out around its aim heading
+void fireVolleys(ProjectileList *projectiles, const Fleet *ships, int volleySize) {
+    for (int i = 0; i < ships->count; i++) {
+        if (ships->isAlive[i] == 0) continue; //Destroyed ships don't fire
+        float angle = ships->aimAngle[i];
+        for (int k = 0; k < volleySize; k++) {
+            float heading = ships->aimHeading[i] + (k - (volleySize - 1)/2.0f)*VOLLEY_SPREAD;
+            Vector3 position = {ships->positionX[i], ships->positionY[i], 10};
+            //Calculate the speed on each axis based on where the ship is aiming
+            Vector3 speed = {cosf(heading)*cosf(angle)*PROJECTILE_SPEED, sinf(heading)*cosf(angle)*PROJECTILE_SPEED, sinf(angle)*PROJECTILE_SPEED};
+            if (spawnProjectile(projectiles, position, speed, ships->team[i]) < 0) return; //The pool is full
         }
     }
-    return 0;
+}
+
+//Computes the hull of every ship once per tick so all collision checks can share it
+void updateShipGeometry(const Fleet *ships, ShipGeometry *geometry) {
+    for (int i = 0; i < ships->count; i++) {
+        //cosf and sinf of the same angle are merged into a single sincos call by the compiler
+        Vector2 forward = {cosf(ships->heading[i]), sinf(ships->heading[i])}; //Towards the bow
+        Vector2 side = {-forward.y, forward.x}; //Towards the left side
+        Vector2 halfLength = Vector2Scale(forward, SHIP_HALF_LENGTH);
+        Vector2 halfWidth = Vector2Scale(side, SHIP_HALF_WIDTH);
+        Vector2 position = {ships->positionX[i], ships->positionY[i]};
+        geometry[i].position = position;
+        geometry[i].forward = forward;
+        geometry[i].side = side;
+        geometry[i].corners[0] = Vector2Add(Vector2Subtract(position, halfLength), halfWidth); //Rear left
+        geometry[i].corners[1] = Vector2Add(Vector2Add(position, halfLength), halfWidth); //Front left
+        geometry[i].corners[2] = Vector2Subtract(Vector2Add(position, halfLength), halfWidth); //Front right
+        geometry[i].corners[3] = Vector2Subtract(Vector2Subtract(position, halfLength), halfWidth); //Rear right
+    }
 }
 
 //Return the number of ships that are still alive
-int playersAlive(Ship ships[], int playerCount) {
+int playersAlive(const Fleet *ships) {
     int playersAlive = 0;
-    for (int i = 0; i < playerCount; i++) {
-        if (ships[i].isAlive == 1) playersAlive++;
+    for (int i = 0; i < ships->count; i++) {
+        if (ships->isAlive[i] == 1) playersAlive++;
     }
     return playersAlive;
 }
 
-//Checks for ship-ship collisions
-void checkShipCollisions(Ship *ships, int playerCount) {
-    //Iterate through all ships
-    for (int i = 0; i < playerCount; i++) {
-        for (int j = 0; j < playerCount; j++) {
-            if (i!=j && ships[i].isAlive == 1 && ships[j].isAlive == 1 && Vector2Length(Vector2Subtract(ships[i].position, ships[j].position))<120) {
-                Line shipLinesI[4] = {//Line segments making up the hitbox of the ship with index i
-                    {
-                        {(-40*cosf(ships[i].heading)-15*sinf(ships[i].heading)+ships[i].position.x),(-40*sinf(ships[i].heading)+15*cosf(ships[i].heading)+ships[i].position.y)},
-                       {(40*cosf(ships[i].heading)-15*sinf(ships[i].heading)+ships[i].position.x),(40*sinf(ships[i].heading)+15*cosf(ships[i].heading)+ships[i].position.y)}
-                    },
-                    {
-                    {(-40*cosf(ships[i].heading)+15*sinf(ships[i].heading)+ships[i].position.x), (-40*sinf(ships[i].heading)-15*cosf(ships[i].heading)+ships[i].position.y)},
-                    {(40*cosf(ships[i].heading)+15*sinf(ships[i].heading)+ships[i].position.x), (40*sinf(ships[i].heading)-15*cosf(ships[i].heading)+ships[i].position.y)}
-                    },
-                    {
-                    {(-40*cosf(ships[i].heading)-15*sinf(ships[i].heading)+ships[i].position.x), (-40*sinf(ships[i].heading)+15*cosf(ships[i].heading)+ships[i].position.y)},
-                    {(-40*cosf(ships[i].heading)+15*sinf(ships[i].heading)+ships[i].position.x), (-40*sinf(ships[i].heading)-15*cosf(ships[i].heading)+ships[i].position.y)}
-                    },
-                    {
-                    {40*cosf(ships[i].heading)-15*sinf(ships[i].heading)+ships[i].position.x, 40*sinf(ships[i].heading)+15*cosf(ships[i].heading)+ships[i].position.y},
-                    {(40*cosf(ships[i].heading)+15*sinf(ships[i].heading)+ships[i].position.x), (40*sinf(ships[i].heading)-15*cosf(ships[i].heading)+ships[i].position.y)}
-                    }
-                };
+//Checks if the hitboxes of two ships overlap. Returns 1 if they do and 0 if they don't
+//Separating axis test: two boxes are apart exactly when the gap between their centers along one of their four side
+//directions is larger than their combined half extents along it, which also catches one hull lying inside the other
+int checkShipPairCollision(const ShipGeometry *a, const ShipGeometry *b) {
+    Vector2 offset = Vector2Subtract(b->position, a->position);
+    //Alignment of the axes of the two ships, shared by every projection
+    float forwardForward = fabsf(Vector2DotProduct(a->forward, b->forward));
+    float forwardSide = fabsf(Vector2DotProduct(a->forward, b->side));
+    float sideForward = fabsf(Vector2DotProduct(a->side, b->forward));
+    float sideSide = fabsf(Vector2DotProduct(a->side, b->side));
+    //Axes of the first ship
+    if (fabsf(Vector2DotProduct(offset, a->forward)) > SHIP_HALF_LENGTH + SHIP_HALF_LENGTH*forwardForward + SHIP_HALF_WIDTH*forwardSide) return 0;
+    if (fabsf(Vector2DotProduct(offset, a->side)) > SHIP_HALF_WIDTH + SHIP_HALF_LENGTH*sideForward + SHIP_HALF_WIDTH*sideSide) return 0;
+    //Axes of the second ship
+    if (fabsf(Vector2DotProduct(offset, b->forward)) > SHIP_HALF_LENGTH + SHIP_HALF_LENGTH*forwardForward + SHIP_HALF_WIDTH*sideForward) return 0;
+    if (fabsf(Vector2DotProduct(offset, b->side)) > SHIP_HALF_WIDTH + SHIP_HALF_LENGTH*forwardSide + SHIP_HALF_WIDTH*sideSide) return 0;
+    return 1; //No separating axis, so the hulls overlap
+}
 
-                Line shipLinesJ[4] = {//Line segments making up the hitbox of the ship with index j
-                    {
-                        {(-40*cosf(ships[j].heading)-15*sinf(ships[j].heading)+ships[j].position.x),(-40*sinf(ships[j].heading)+15*cosf(ships[j].heading)+ships[j].position.y)},
-                       {(40*cosf(ships[j].heading)-15*sinf(ships[j].heading)+ships[j].position.x),(40*sinf(ships[j].heading)+15*cosf(ships[j].heading)+ships[j].position.y)}
-                    },
-                    {
-                        {(-40*cosf(ships[j].heading)+15*sinf(ships[j].heading)+ships[j].position.x), (-40*sinf(ships[j].heading)-15*cosf(ships[j].heading)+ships[j].position.y)},
-                        {(40*cosf(ships[j].heading)+15*sinf(ships[j].heading)+ships[j].position.x), (40*sinf(ships[j].heading)-15*cosf(ships[j].heading)+ships[j].position.y)}
-                    },
-                    {
-                        {(-40*cosf(ships[j].heading)-15*sinf(ships[j].heading)+ships[j].position.x), (-40*sinf(ships[j].heading)+15*cosf(ships[j].heading)+ships[j].position.y)},
-                        {(-40*cosf(ships[j].heading)+15*sinf(ships[j].heading)+ships[j].position.x), (-40*sinf(ships[j].heading)-15*cosf(ships[j].heading)+ships[j].position.y)}
-                    },
-                    {
-                        {40*cosf(ships[j].heading)-15*sinf(ships[j].heading)+ships[j].position.x, 40*sinf(ships[j].heading)+15*cosf(ships[j].heading)+ships[j].position.y},
-                        {(40*cosf(ships[j].heading)+15*sinf(ships[j].heading)+ships[j].position.x), (40*sinf(ships[j].heading)-15*cosf(ships[j].heading)+ships[j].position.y)}
-                    }
-                };
-                for (int k = 0; k < 4; k++) {
-                    for (int l = 0; l < 4; l++) {
-                        if (CheckCollisionLines(shipLinesI[k].start, shipLinesI[k].end, shipLinesJ[l].start, shipLinesJ[l].end, NULL)) {
-                            ships[i].isAlive = 0;
-                            ships[j].isAlive = 0;
-                        }
-                    }
-                }
-            }
-        }
+//Loads the collision sections stored in the provided file. Returns NULL if the file is missing or corrupted
+struct CollisionSection *loadCollisionSections(const char *fileName, int *sectionCount) {
+    //Open the file in read binary mode
+    FILE *f = fopen(fileName, "rb");
+    //Check if file was opened correctly
+    if (f == NULL) {
+        perror("collisions.dat file is missing!");
+        return NULL;
+    }
+    //Measure file length
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    rewind(f);
+    //Check if file has contents
+    if (length < (long)sizeof(struct CollisionSection)) {
+        perror("collisions.dat file is corrupted!");
+        fclose(f);
+        return NULL;
     }
-}
\ No newline at end of file
+    //Calculate the number of collision sections stored in the file
+    int count = length/sizeof(struct CollisionSection);
+    //Sections are kept on the heap so large maps don't overflow the stack
+    struct CollisionSection *sections = malloc(count*sizeof(struct CollisionSection));
+    if (sections == NULL || fread(sections, sizeof(struct CollisionSection), count, f) != (size_t)count) {
+        perror("collisions.dat file is corrupted!");
+        free(sections);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *sectionCount = count;
+    return sections;
+}
@@ -26,8 +26,13 @@ Copyright (C) 2025 EverTech1, georgerafa
 #define PROJECTILE_SPEED  200.0f //The initial projectile speed
 #define GRAVITY  45.0f //Gravitational acceleration
 #define maxShipSpeed 75
-#define MAX_PLAYERS 6
+#define MAX_PLAYERS 6 //Most players that can be picked in the menu, headless matches can have many more ships
+#define SHIP_HALF_LENGTH 40.0f //Distance from the center of a ship's hitbox to its bow
+#define SHIP_HALF_WIDTH 15.0f //Distance from the center of a ship's hitbox to its sides
+#define SPAWN_SPACING 90.0f //Distance between neighbouring spawn positions
+#define VOLLEY_SPREAD 0.06f //Heading difference in radians between neighbouring shells of a volley
 #include "raymath.h"
+#include "arena.h"
 typedef struct ShipStruct {
     int team; //Ship team
     Vector2 position; //Current ship position
@@ -35,7 +40,7 @@ typedef struct ShipStruct {
     float heading; //Direction in radians
     int isAlive;
     Vector2 distanceMoved;
-} Ship; //Ship object
+} Ship; //Copy of a single ship's state
 
 typedef struct ProjectileStruct {
     int team; //Origin ship team
@@ -43,27 +48,77 @@ typedef struct ProjectileStruct {
     Vector3 speed; //Current projectile speed
     float heading; //Direction in radians
     float angle; //Elevation angle in radians
-} Projectile;
+} Projectile; //Copy of a single projectile's state
+
+typedef struct FleetStruct {
+    int count; //Number of ships
+    float *positionX; //Current ship positions
+    float *positionY;
+    float *speed; //Current ship speeds
+    float *heading; //Directions in radians
+    float *aimHeading; //Direction the ship's next shot will be fired towards in radians
+    float *aimAngle; //Elevation of the ship's next shot in radians
+    float *velocityX; //Speed on each axis, worked out from the heading and speed once per round
+    float *velocityY;
+    float *distanceMovedX; //Distance moved during the current round
+    float *distanceMovedY;
+    int *isAlive;
+    int *team; //Ship teams
+} Fleet; //State of all ships, one array per field so the update loops read contiguous memory
+
+typedef struct ProjectileListStruct {
+    int capacity; //Most projectiles that can be in the air at once
+    int count; //Number of projectiles in the air, they are always packed at the start of the arrays
+    float *positionX; //Current projectile positions
+    float *positionY;
+    float *positionZ;
+    float *speedX; //Current projectile speeds
+    float *speedY;
+    float *speedZ;
+    int *team; //Origin ship teams
+    int *target; //Ship each projectile will hit, or -1 if it will land in the water
+    float *impactTime; //Time at which each projectile hits its target
+    float *landingTime; //Time at which each projectile reaches the water
+    int *slot; //Pool slot of every projectile in the air, stays the same while the projectile flies
+    int *index; //Index in the arrays above of the projectile using each slot
+    int *freeSlots; //Stack of the slots not in use
+    int freeCount;
+} ProjectileList; //Pool of projectiles, one array per field. Spawning and retiring a projectile never allocates
 
 typedef struct Line {
     Vector2 start;
     Vector2 end;
 } Line;
 
+typedef struct ShipGeometryStruct {
+    Vector2 position; //Ship position the geometry was computed for
+    Vector2 forward; //Unit vector towards the bow
+    Vector2 side; //Unit vector towards the left side
+    Vector2 corners[4]; //Hitbox corners in order rear left, front left, front right, rear right
+} ShipGeometry; //Hitbox of a ship, computed once per tick
+
 struct CollisionSection {
     Vector2 centerPosition;
     int minimumDistance;
     Line Lines[10];
 };
 
-int playersAlive(Ship ships[], int playerCount);
-void checkShipCollisions(Ship *ships, int playerCount);
-int checkProjectileCollision(Ship ship, Projectile *projectiles, int playerCount);
-int checkTerrainCollision(Ship ship, struct CollisionSection[], int sectionCount);
-int getLinePoint(Projectile p, int x);
-void updateShipPositions(Ship *ships, int shipCount, float deltaT);
-void updateProjectiles(Projectile *projectiles, int projectileCount, float deltaT);
-void initializeProjectiles(Projectile *projectiles, Ship ships[], int playerCount);
-void resetProjectiles(Projectile *projectiles, int projectileCount);
-void initializeShips(Ship *ships, int shipCount);
+struct TerrainGridStruct;
+
+int allocateFleet(Fleet *ships, int shipCount, Arena *arena);
+int allocateProjectiles(ProjectileList *projectiles, int capacity, Arena *arena);
+int spawnProjectile(ProjectileList *projectiles, Vector3 position, Vector3 speed, int team);
+void retireProjectile(ProjectileList *projectiles, int projectile);
+void clearProjectiles(ProjectileList *projectiles);
+Ship getShip(const Fleet *ships, int ship);
+Projectile getProjectile(const ProjectileList *projectiles, int projectile);
+int checkLineCollision(Vector2 startA, Vector2 endA, Vector2 startB, Vector2 endB);
+int checkCircleLineCollision(Vector2 center, float radius, Vector2 start, Vector2 end);
+int playersAlive(const Fleet *ships);
+void updateShipGeometry(const Fleet *ships, ShipGeometry *geometry);
+int checkShipPairCollision(const ShipGeometry *a, const ShipGeometry *b);
+int getLinePoint(float angle, int x);
+void fireVolleys(ProjectileList *projectiles, const Fleet *ships, int volleySize);
+void initializeShips(Fleet *ships, const struct TerrainGridStruct *terrain, Vector2 mapBounds);
+struct CollisionSection *loadCollisionSections(const char *fileName, int *sectionCount);
 #endif //GAMECALCULATIONS_H
@@ -0,0 +1,185 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "integration.h"
+
+//The SSE2 and AVX2 kernels are only built for x86 compilers that can target them per function
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define INTEGRATION_X86 1
+#include <immintrin.h>
+#endif
+
+typedef struct IntegrationKernelsStruct {
+    const char *name;
+    void (*ships)(Fleet *ships, float deltaT, int start);
+    void (*projectiles)(ProjectileList *projectiles, float deltaT, int start);
+} IntegrationKernels;
+
+//Every kernel takes the index it starts from so the wide kernels can leave the remainder to the scalar ones
+static void updateShipsScalar(Fleet *ships, float deltaT, int start) {
+    for (int i = start; i < ships->count; i++) {
+        float oldX = ships->positionX[i];
+        float oldY = ships->positionY[i];
+        ships->positionX[i] += ships->velocityX[i]*deltaT; //Adjust X position
+        ships->positionY[i] += ships->velocityY[i]*deltaT; //Adjust Y position
+        ships->distanceMovedX[i] += ships->positionX[i] - oldX;
+        ships->distanceMovedY[i] += ships->positionY[i] - oldY;
+    }
+}
+
+static void updateProjectilesScalar(ProjectileList *projectiles, float deltaT, int start) {
+    for (int i = start; i < projectiles->count; i++) { //Every projectile in the pool is in the air
+        projectiles->positionX[i] += projectiles->speedX[i]*deltaT;
+        projectiles->positionY[i] += projectiles->speedY[i]*deltaT;
+        projectiles->positionZ[i] += projectiles->speedZ[i]*deltaT - 0.5f*GRAVITY*deltaT*deltaT; //Exact for constant gravity so the projectile stays on its parabola
+        projectiles->speedZ[i] -= GRAVITY*deltaT;
+    }
+}
+
+#ifdef INTEGRATION_X86
+//Every lane does the same multiply then add as the scalar kernel, so all kernels give identical results.
+//FMA is deliberately not enabled since fusing would change the rounding
+__attribute__((target("sse2")))
+static void updateShipsSse2(Fleet *ships, float deltaT, int start) {
+    __m128 dt = _mm_set1_ps(deltaT);
+    int i = start;
+    for (; i + 4 <= ships->count; i += 4) {
+        __m128 oldX = _mm_loadu_ps(ships->positionX + i);
+        __m128 oldY = _mm_loadu_ps(ships->positionY + i);
+        __m128 newX = _mm_add_ps(oldX, _mm_mul_ps(_mm_loadu_ps(ships->velocityX + i), dt));
+        __m128 newY = _mm_add_ps(oldY, _mm_mul_ps(_mm_loadu_ps(ships->velocityY + i), dt));
+        _mm_storeu_ps(ships->positionX + i, newX);
+        _mm_storeu_ps(ships->positionY + i, newY);
+        _mm_storeu_ps(ships->distanceMovedX + i, _mm_add_ps(_mm_loadu_ps(ships->distanceMovedX + i), _mm_sub_ps(newX, oldX)));
+        _mm_storeu_ps(ships->distanceMovedY + i, _mm_add_ps(_mm_loadu_ps(ships->distanceMovedY + i), _mm_sub_ps(newY, oldY)));
+    }
+    updateShipsScalar(ships, deltaT, i);
+}
+
+__attribute__((target("sse2")))
+static void updateProjectilesSse2(ProjectileList *projectiles, float deltaT, int start) {
+    __m128 dt = _mm_set1_ps(deltaT);
+    __m128 gravity = _mm_set1_ps(GRAVITY*deltaT);
+    __m128 drop = _mm_set1_ps(0.5f*GRAVITY*deltaT*deltaT);
+    int i = start;
+    for (; i + 4 <= projectiles->count; i += 4) {
+        __m128 speedZ = _mm_loadu_ps(projectiles->speedZ + i);
+        _mm_storeu_ps(projectiles->positionX + i, _mm_add_ps(_mm_loadu_ps(projectiles->positionX + i), _mm_mul_ps(_mm_loadu_ps(projectiles->speedX + i), dt)));
+        _mm_storeu_ps(projectiles->positionY + i, _mm_add_ps(_mm_loadu_ps(projectiles->positionY + i), _mm_mul_ps(_mm_loadu_ps(projectiles->speedY + i), dt)));
+        _mm_storeu_ps(projectiles->positionZ + i, _mm_add_ps(_mm_loadu_ps(projectiles->positionZ + i), _mm_sub_ps(_mm_mul_ps(speedZ, dt), drop)));
+        _mm_storeu_ps(projectiles->speedZ + i, _mm_sub_ps(speedZ, gravity));
+    }
+    updateProjectilesScalar(projectiles, deltaT, i);
+}
+
+__attribute__((target("avx2")))
+static void updateShipsAvx2(Fleet *ships, float deltaT, int start) {
+    __m256 dt = _mm256_set1_ps(deltaT);
+    int i = start;
+    for (; i + 8 <= ships->count; i += 8) {
+        __m256 oldX = _mm256_loadu_ps(ships->positionX + i);
+        __m256 oldY = _mm256_loadu_ps(ships->positionY + i);
+        __m256 newX = _mm256_add_ps(oldX, _mm256_mul_ps(_mm256_loadu_ps(ships->velocityX + i), dt));
+        __m256 newY = _mm256_add_ps(oldY, _mm256_mul_ps(_mm256_loadu_ps(ships->velocityY + i), dt));
+        _mm256_storeu_ps(ships->positionX + i, newX);
+        _mm256_storeu_ps(ships->positionY + i, newY);
+        _mm256_storeu_ps(ships->distanceMovedX + i, _mm256_add_ps(_mm256_loadu_ps(ships->distanceMovedX + i), _mm256_sub_ps(newX, oldX)));
+        _mm256_storeu_ps(ships->distanceMovedY + i, _mm256_add_ps(_mm256_loadu_ps(ships->distanceMovedY + i), _mm256_sub_ps(newY, oldY)));
+    }
+    _mm256_zeroupper(); //Avoids the AVX to SSE transition penalty in the narrower kernel
+    updateShipsSse2(ships, deltaT, i); //At most 7 ships are left
+}
+
+__attribute__((target("avx2")))
+static void updateProjectilesAvx2(ProjectileList *projectiles, float deltaT, int start) {
+    __m256 dt = _mm256_set1_ps(deltaT);
+    __m256 gravity = _mm256_set1_ps(GRAVITY*deltaT);
+    __m256 drop = _mm256_set1_ps(0.5f*GRAVITY*deltaT*deltaT);
+    int i = start;
+    for (; i + 8 <= projectiles->count; i += 8) {
+        __m256 speedZ = _mm256_loadu_ps(projectiles->speedZ + i);
+        _mm256_storeu_ps(projectiles->positionX + i, _mm256_add_ps(_mm256_loadu_ps(projectiles->positionX + i), _mm256_mul_ps(_mm256_loadu_ps(projectiles->speedX + i), dt)));
+        _mm256_storeu_ps(projectiles->positionY + i, _mm256_add_ps(_mm256_loadu_ps(projectiles->positionY + i), _mm256_mul_ps(_mm256_loadu_ps(projectiles->speedY + i), dt)));
+        _mm256_storeu_ps(projectiles->positionZ + i, _mm256_add_ps(_mm256_loadu_ps(projectiles->positionZ + i), _mm256_sub_ps(_mm256_mul_ps(speedZ, dt), drop)));
+        _mm256_storeu_ps(projectiles->speedZ + i, _mm256_sub_ps(speedZ, gravity));
+    }
+    _mm256_zeroupper();
+    updateProjectilesSse2(projectiles, deltaT, i);
+}
+#endif
+
+static const IntegrationKernels scalarKernels = {"scalar", updateShipsScalar, updateProjectilesScalar};
+#ifdef INTEGRATION_X86
+static const IntegrationKernels sse2Kernels = {"sse2", updateShipsSse2, updateProjectilesSse2};
+static const IntegrationKernels avx2Kernels = {"avx2", updateShipsAvx2, updateProjectilesAvx2};
+#endif
+
+static const IntegrationKernels *kernels = &scalarKernels; //Set once by selectKernels before any caller reads it
+static pthread_once_t kernelsOnce = PTHREAD_ONCE_INIT; //Makes the selection safe when several match threads start together
+
+//Picks the widest kernels the CPU supports.
+//SHIPBATTLE_SIMD=scalar, sse2 or avx2 forces a narrower set, which is useful to compare them
+static void selectKernels(void) {
+    const char *forced = getenv("SHIPBATTLE_SIMD");
+    const IntegrationKernels *selected = &scalarKernels;
+#ifdef INTEGRATION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) selected = &sse2Kernels;
+    if (__builtin_cpu_supports("avx2") && (forced == NULL || strcmp(forced, "sse2") != 0)) selected = &avx2Kernels;
+#endif
+    if (forced != NULL && strcmp(forced, "scalar") == 0) selected = &scalarKernels;
+    kernels = selected;
+}
+
+//Returns the kernels, selecting them the first time any thread needs them
+static const IntegrationKernels *getKernels(void) {
+    pthread_once(&kernelsOnce, selectKernels); //pthread_once also orders the write above before every later read
+    return kernels;
+}
+
+//Converts every ship's heading and speed into a velocity. Called once per round instead of every tick
+void updateShipVelocities(Fleet *ships) {
+    for (int i = 0; i < ships->count; i++) {
+        ships->velocityX[i] = cosf(ships->heading[i])*ships->speed[i]; //Calculate speed on the X axis
+        ships->velocityY[i] = sinf(ships->heading[i])*ships->speed[i]; //Calculate speed on the Y axis
+    }
+}
+
+//Moves every ship by its velocity and logs the distance it moved this round
+void updateShipPositions(Fleet *ships, float deltaT) {
+    getKernels()->ships(ships, deltaT, 0);
+}
+
+//Moves every projectile in the pool and applies gravity to it
+void updateProjectiles(ProjectileList *projectiles, float deltaT) {
+    getKernels()->projectiles(projectiles, deltaT, 0);
+}
+
+//Returns the name of the kernels in use
+const char *getIntegrationKernelName(void) {
+    return getKernels()->name;
+}
@@ -0,0 +1,32 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Movement kernels for whole fleets and projectile lists, vectorized where the CPU supports it
+#ifndef INTEGRATION_H
+#define INTEGRATION_H
+#include "gameCalculations.h"
+
+void updateShipVelocities(Fleet *ships);
+void updateShipPositions(Fleet *ships, float deltaT);
+void updateProjectiles(ProjectileList *projectiles, float deltaT);
+const char *getIntegrationKernelName(void);
+#endif //INTEGRATION_H
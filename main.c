@@ -27,50 +27,69 @@ Copyright (C) 2025 EverTech1, georgerafa
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
-
-#include "gameCalculations.h"
+#include <time.h>
+
+#include "assetPack.h"
+#include "audioPlayer.h"
+#include "compiledMap.h"
+#include "fireControl.h"
+#include "match.h"
+#include "matchClient.h"
+#include "profiler.h"
+#include "replay.h"
+#include "saveFile.h"
+#include "spriteBatch.h"
+#include "threadPool.h"
+#include "trajectoryPreview.h"
 
 float countdownTimer = 3.0f; // Countdown timer for 3-2-1-Go
-float roundTimer = 10.0f; //Timer for round length
 
-struct { //Settings are stored in this struct for easy saving
+struct SettingsStruct { //Settings are stored in this struct for easy saving
     bool enableTargetLine;
     float musicVolume;
     float soundVolume;
-} settings = {true, 0.5f, 0.5f};
+    bool enableAimAssist; //Kept last so settings saved before it existed still load
+} settings = {true, 0.5f, 0.5f, false};
+#define SETTINGS_FIRST_SIZE offsetof(struct SettingsStruct, enableAimAssist) //Size of settings.dat before aim assist was added
 
 //isMidGame is true when a game is currently ongoing
 bool isMidGame = false;
 
-typedef enum GameState {DIRECTION_INSTR, MOVEMENT_A, FIRE_INSTR, MOVEMENT_B, FIRE} GameState; //All game states
+const char *serverAddress = NULL; //Set with --connect, new matches are then played on a shipbattle_server
+int serverSeats = 0; //Ships of every online match played from this game, set with --seats. 0 plays all of them
+MatchClient matchClient; //Connection to the server during an online match
+bool isOnline = false; //True while the current match is played on the server
+
 typedef enum GameScreen {TITLE, PLAYER_SELECT, COUNTDOWN, GAME, SETTINGS, HOW_TO_PLAY, END} GameScreen; //All screen states
 
 
 
 //Declare function prototypes
-Line getTargetLine(Ship ships[], int shipA, int shipB);
-void saveGame(Ship *ships, Projectile *projectiles, int selectedPlayers, int targetPlayer, int picking, float roundTimer, GameState gameState);
-bool loadGame(Ship *ships, Projectile *projectiles, int *selectedPlayers, int *targetPlayer, int *picking, float *roundTimer, GameState *gameState);
+Line getTargetLine(const Fleet *ships, int shipA, int shipB);
+void saveGame(const Match *match, int targetPlayer, int picking);
+bool loadGame(Match *match, const TerrainGrid *terrain, Vector2 mapBounds, int *targetPlayer, int *picking);
 void saveSettings();
 void loadSettings();
 
 
-//Sound variables
-Music backgroundMusic;
-Music gameMusic;
-Sound selectionSound;
-Sound confirmSound;
+AudioPlayer audioPlayer; //Plays the music and sound effects on its own thread
+
+//Every image and sound of the game, empty when there is no assets.sbpk and the files in assets are loaded instead
+AssetPack assetPack;
 
 //Texture variables
-Texture2D shipTexture;
 Texture2D gameMapTexture;
 Texture2D backgroundTexture;
-Texture2D cannonBallTexture;
 Texture2D endTexture;
+SpriteAtlas spriteAtlas; //Ships, cannon balls and trajectory dots in one texture
+SpriteBatch spriteBatch; //Sprites of the current frame, drawn together
+TrajectoryPreview trajectoryPreview; //Path of the projectile the picking ship is aiming
 
 //Initial states
 GameScreen currentScreen = TITLE;
-GameState currentState = DIRECTION_INSTR;
+Match match; //The match currently being played, its state holds the current game state
+ReplayRecorder replay; //Recording of the current match
+SaveWriter saveWriter; //Writes save.dat in the background
 
 //Previous and next screen states
 GameScreen previousScreen = TITLE;
@@ -83,41 +102,169 @@ int screenWidth;
 int screenHeight;
 Camera2D camera = {0}; //Initialize 2D top down camera
 
-void endGame(){
-    currentScreen = END;
-    remove("save.dat");
-    isMidGame = false;
-    StopMusicStream(gameMusic);
-    PlayMusicStream(backgroundMusic);
+#ifdef SHIPBATTLE_PROFILER
+Profiler profiler; //Times the stages of every frame
+bool showProfiler = false; //Toggled with F3
+
+//Draws the median and 99th percentile time of every stage over the last frames
+void drawProfilerOverlay(){
+    DrawRectangle(10, 10, 430, 72 + 22*PROFILE_STAGE_COUNT, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("Stage (last %d frames)", profiler.historyCount), 20, 20, 18, WHITE);
+    DrawText("p50 ms", 260, 20, 18, WHITE);
+    DrawText("p99 ms", 350, 20, 18, WHITE);
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        float median, worst;
+        getProfileStats(&profiler, i, &median, &worst);
+        DrawText(getProfileStageName(i), 20 + (i > PROFILE_FRAME)*10, 46 + 22*i, 18, WHITE); //Stages inside the frame are indented
+        DrawText(TextFormat("%.3f", median), 260, 46 + 22*i, 18, WHITE);
+        DrawText(TextFormat("%.3f", worst), 350, 46 + 22*i, 18, worst > 1000.0f/GetMonitorRefreshRate(GetCurrentMonitor()) ? RED : WHITE); //Stages that can miss a refresh are red
+    }
+    DrawText(TextFormat("Audio commands dropped: %d", audioPlayer.dropped), 20, 46 + 22*PROFILE_STAGE_COUNT, 18, audioPlayer.dropped > 0 ? RED : WHITE); //The audio thread fell behind
+    if (profiler.isCapturing) DrawText(profiler.format == PROFILE_CSV ? "Capturing CSV, F4 to stop" : "Capturing trace, F5 to stop", 20, 68 + 22*PROFILE_STAGE_COUNT, 18, RED);
 }
 
-void main(void){
-    //Open collisions.dat file in read binary mode
-    FILE *f = fopen("collisions.dat", "rb");
-    //Check if file was opened correctly
-    if (f == NULL) {
-        perror("collisions.dat file is missing!");
+//F3 toggles the overlay, F4 starts and stops capturing frame times to a CSV file and F5 to a Chrome trace
+void updateProfilerKeys(){
+    if (IsKeyPressed(KEY_F3)) showProfiler = !showProfiler;
+    int format = IsKeyPressed(KEY_F4) ? PROFILE_CSV : IsKeyPressed(KEY_F5) ? PROFILE_CHROME_TRACE : -1;
+    if (format < 0) return;
+    if (profiler.isCapturing && (int)profiler.format == format) {
+        stopProfileCapture(&profiler);
         return;
     }
-    //Measure file length
-    fseek(f, 0, SEEK_END);
-    int length = ftell(f);
-    rewind(f);
-    //Check if file has contents
-    if (length <= 0) {
-        perror("collisions.dat file is corrupted!");
+    char fileName[64];
+    time_t now = time(NULL);
+    strftime(fileName, sizeof(fileName), format == PROFILE_CSV ? "profile_%Y%m%d_%H%M%S.csv" : "profile_%Y%m%d_%H%M%S.json", localtime(&now));
+    startProfileCapture(&profiler, fileName);
+}
+#endif
+
+//Reads assets.sbpk in one go and decodes it on every core while a loading bar is drawn
+void loadAssetPack(){
+    if (!openAssetPack(&assetPack, "assets.sbpk")) return; //Use the loose files
+    if (!startAssetDecode(&assetPack, getCoreCount())) {
+        closeAssetPack(&assetPack);
         return;
     }
-    //Calculate the number of collision segments stored in the file
-    int segmentCount = length/sizeof(struct CollisionSection);
-    //Create variable to store the read collision sections from the file
-    struct CollisionSection readSections[segmentCount];
-    //Get the data from the file and close it
-    fread(&readSections, sizeof(readSections), 1, f);
-    fclose(f);
+    float progress;
+    while ((progress = getAssetDecodeProgress(&assetPack)) < 1.0f) {
+        BeginDrawing();
+        ClearBackground(DARKBLUE);
+        DrawText("Loading", screenWidth/2 - MeasureText("Loading", 40)/2, screenHeight/2 - 60, 40, WHITE);
+        DrawRectangleLines(screenWidth/4, screenHeight/2, screenWidth/2, 30, WHITE);
+        DrawRectangle(screenWidth/4, screenHeight/2, (int)(progress*screenWidth/2), 30, WHITE);
+        EndDrawing();
+    }
+    if (!finishAssetDecode(&assetPack)) closeAssetPack(&assetPack); //Fall back to the loose files if the pack is damaged
+}
+
+//Returns the decoded contents of a packed file, or NULL if the pack doesn't have it
+unsigned char *getPackedFile(const char *name, int *size){
+    int entry = findAsset(&assetPack, name);
+    if (entry < 0 || assetPack.entries[entry].type != ASSET_FILE || assetPack.entries[entry].data == NULL) return NULL;
+    *size = (int)assetPack.entries[entry].size;
+    return assetPack.entries[entry].data;
+}
+
+//Returns an image from the asset pack without copying its pixels, or loads it from the assets folder
+Image loadAssetImage(const char *name){
+    int entry = findAsset(&assetPack, name);
+    if (entry >= 0 && assetPack.entries[entry].type == ASSET_IMAGE && assetPack.entries[entry].data != NULL) {
+        const AssetEntry *image = &assetPack.entries[entry];
+        return (Image){image->data, image->width, image->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    }
+    int size;
+    unsigned char *data = getPackedFile(name, &size); //Images the packer couldn't decode are stored as files
+    if (data != NULL) return LoadImageFromMemory(GetFileExtension(name), data, size);
+    return LoadImage(TextFormat("assets/%s", name));
+}
+
+//Frees an image returned by loadAssetImage, pixels owned by the asset pack are released from it
+void unloadAssetImage(Image image){
+    int entry = findPackedData(&assetPack, image.data);
+    if (entry >= 0) releaseAsset(&assetPack, entry);
+    else UnloadImage(image);
+}
+
+//Returns a sound from the asset pack, or loads it from the assets folder
+Sound loadAssetSound(const char *name){
+    int size;
+    unsigned char *data = getPackedFile(name, &size);
+    if (data == NULL) return LoadSound(TextFormat("assets/%s", name));
+    Wave wave = LoadWaveFromMemory(GetFileExtension(name), data, size);
+    Sound sound = LoadSoundFromWave(wave); //The sound keeps its own copy of the samples
+    UnloadWave(wave);
+    releaseAsset(&assetPack, findAsset(&assetPack, name));
+    return sound;
+}
+
+//Returns a music stream from the asset pack, or opens it from the assets folder. Packed music is streamed from the pack, which is kept until exit
+Music loadAssetMusic(const char *name){
+    int size;
+    unsigned char *data = getPackedFile(name, &size);
+    if (data == NULL) return LoadMusicStream(TextFormat("assets/%s", name));
+    return LoadMusicStreamFromMemory(GetFileExtension(name), data, size);
+}
+
+//Starts recording the current match to a replay file named after the current time
+void startRecording(){
+    char fileName[64];
+    time_t now = time(NULL);
+    strftime(fileName, sizeof(fileName), "replay_%Y%m%d_%H%M%S.sbr", localtime(&now));
+    startReplayRecording(&replay, &match, fileName);
+}
+
+//Finishes the replay of the current match if it is being recorded
+void stopRecording(){
+    if (match.replay != NULL) finishReplayRecording(&replay, &match, 0); //The writer thread finishes the file on its own
+}
+
+//Disconnects from the server if the current match is played online
+void leaveOnlineMatch(){
+    if (isOnline) closeMatchClient(&matchClient);
+    isOnline = false;
+}
+
+//Returns true if the ship is given its orders on this computer
+bool isLocalShip(int ship){
+    return !isOnline || isClientShip(&matchClient, ship);
+}
+
+//Follows the online match. The orders the server sent start the phase they are for, and the state it resolved to replaces the local
+//one once the phase has been played out here. Returns false if the connection to the server was lost
+bool updateOnlineMatch(const TerrainGrid *terrain){
+    if (!updateMatchClient(&matchClient)) return false;
+    if (match.state != DIRECTION_INSTR && match.state != FIRE_INSTR && !match.isOver) return true; //Still playing out a phase
+    if (applyServerOrders(&matchClient, &match)) return true;
+    applyServerState(&matchClient, &match, terrain);
+    return !matchClient.connection.failed;
+}
+
+void endGame(){
+    currentScreen = END;
+    stopRecording();
+    leaveOnlineMatch();
+    requestSaveRemoval(&saveWriter);
+    isMidGame = false;
+    stopMusic(&audioPlayer, MUSIC_GAME);
+    playMusic(&audioPlayer, MUSIC_BACKGROUND);
+}
+
+void main(int argc, char **argv){
+    //Read the command line options. --connect ADDRESS plays new matches on a shipbattle_server, --seats N plays only N ships of each
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--connect") == 0) serverAddress = argv[i + 1];
+        else if (strcmp(argv[i], "--seats") == 0) serverSeats = atoi(argv[i + 1]);
+    }
+
+    //Map the compiled map into memory, its terrain grid is ready to use
+    CompiledMap map;
+    TerrainGrid terrain;
+    if (!openCompiledMap(&map, "collisions.sbm", &terrain)) return;
 
     //Load saved settings
     loadSettings();
+    startSaveWriter(&saveWriter, "save.dat"); //Saves are written on their own thread
 
     InitWindow(800, 800, "POLYNAYMAXIA"); //Initialize the game window
     SetExitKey(0); //Remove exit key
@@ -136,48 +283,56 @@ void main(void){
     //Calculate map edges
     const Vector2 mapBounds = GetScreenToWorld2D((Vector2){screenWidth, screenHeight}, camera);
 
+    //Decode every asset before loading them
+    loadAssetPack();
+
     // Initialize audio
     InitAudioDevice();
 
     //Load music
-    backgroundMusic = LoadMusicStream("assets/background_music.mp3");
-    gameMusic = LoadMusicStream("assets/game_music.mp3");
-    //Load sound effects
-    selectionSound = LoadSound("assets/selection.wav");
-    confirmSound = LoadSound("assets/confirm.wav");
+    setPlayerMusic(&audioPlayer, MUSIC_BACKGROUND, loadAssetMusic("background_music.mp3"));
+    setPlayerMusic(&audioPlayer, MUSIC_GAME, loadAssetMusic("game_music.mp3"));
+    //Load sound effects, battle sounds have more voices and a higher priority so a full broadside is heard over the menus
+    setPlayerEffect(&audioPlayer, SOUND_SELECTION, loadAssetSound("selection.wav"), 2, 0);
+    setPlayerEffect(&audioPlayer, SOUND_CONFIRM, loadAssetSound("confirm.wav"), 2, 1);
+    setPlayerEffect(&audioPlayer, SOUND_CANNON_FIRE, generateBurstSound(0.9f, 5, 0.08f, 55, 1), 6, 2);
+    setPlayerEffect(&audioPlayer, SOUND_HIT, generateBurstSound(0.7f, 7, 0.35f, 80, 2), 6, 3);
+    setPlayerEffect(&audioPlayer, SOUND_SPLASH, generateBurstSound(0.5f, 9, 0.6f, 0, 3), 6, 1);
+    startAudioPlayer(&audioPlayer);
 
     //Set volume for audio streams
-    SetMusicVolume(gameMusic,settings.musicVolume);
-    SetMusicVolume(backgroundMusic, settings.musicVolume);
-    SetSoundVolume(selectionSound, settings.soundVolume);
-    SetSoundVolume(confirmSound, settings.soundVolume);
+    setPlayerMusicVolume(&audioPlayer, settings.musicVolume);
+    setPlayerEffectVolume(&audioPlayer, settings.soundVolume);
 
     //Start playing main menu music
-    PlayMusicStream(backgroundMusic);
+    playMusic(&audioPlayer, MUSIC_BACKGROUND);
 
     //Load images
-    Image gameMapImage = LoadImage("assets/gameMap.png");
-    Image backgroundImage = LoadImage("assets/background.png");
-    Image shipImage = LoadImage("assets/ship.png");
-    Image cannonBall = LoadImage("assets/cannonBall.png");
-    Image endImage = LoadImage("assets/end.png");
+    Image gameMapImage = loadAssetImage("gameMap.png");
+    Image backgroundImage = loadAssetImage("background.png");
+    Image shipImage = loadAssetImage("ship.png");
+    Image cannonBall = loadAssetImage("cannonBall.png");
+    Image endImage = loadAssetImage("end.png");
 
     //Create textures
     gameMapTexture = LoadTextureFromImage(gameMapImage);
     backgroundTexture = LoadTextureFromImage(backgroundImage);
-    shipTexture = LoadTextureFromImage(shipImage);
-    cannonBallTexture = LoadTextureFromImage(cannonBall);
+    Image dotImage = GenImageColor(16, 16, BLANK); //White circle tinted for every trajectory dot
+    ImageDrawCircle(&dotImage, 8, 8, 7, WHITE);
+    buildSpriteAtlas(&spriteAtlas, (Image[SPRITE_COUNT]){[SPRITE_SHIP] = shipImage, [SPRITE_CANNON_BALL] = cannonBall, [SPRITE_DOT] = dotImage});
+    spriteBatch.atlas = &spriteAtlas;
     endTexture = LoadTextureFromImage(endImage);
 
     //Unload images
-    UnloadImage(gameMapImage);
-    UnloadImage(backgroundImage);
-    UnloadImage(shipImage);
-    UnloadImage(cannonBall);
-    UnloadImage(endImage);
+    unloadAssetImage(gameMapImage);
+    unloadAssetImage(backgroundImage);
+    unloadAssetImage(shipImage);
+    unloadAssetImage(cannonBall);
+    UnloadImage(dotImage);
+    unloadAssetImage(endImage);
 
-    Ship ships[MAX_PLAYERS]; //Create array for storing ships
-    Projectile projectiles[MAX_PLAYERS]; //Create array for storing projectiles
+    Fleet *ships = &match.ships; //Ships of the match
+    ProjectileList *projectiles = &match.projectiles; //Projectiles of the match
 
     //Counter variable for selected ship animation
     double selectAnimation = 0;
@@ -187,10 +342,16 @@ void main(void){
     bool shouldExit = 0;
 
 
+#ifdef SHIPBATTLE_PROFILER
+    startProfiler(&profiler); //Frames are timed on this thread
+#endif
+
     while (!(WindowShouldClose()||shouldExit)){ //While the game is running
-        //Update the streaming buffers
-        UpdateMusicStream(backgroundMusic);
-        UpdateMusicStream(gameMusic);
+        PROFILE_BEGIN(PROFILE_FRAME);
+        //Update the streaming buffers, only when there is no audio thread
+        PROFILE_BEGIN(PROFILE_AUDIO);
+        updateAudioPlayer(&audioPlayer);
+        PROFILE_END(PROFILE_AUDIO);
 
         switch (currentScreen) {
             //Change what is displayed based on current screen state
@@ -198,35 +359,37 @@ void main(void){
                 static int selectedOption = 0; //Currently selected option
             //Handle key presses
             if (IsKeyPressed(KEY_UP)) { //Navigate up
-                PlaySound(selectionSound);
+                playEffect(&audioPlayer, SOUND_SELECTION);
                 selectedOption = (selectedOption - 1 + 4) % 4;
             }
             if (IsKeyPressed(KEY_DOWN)) { //Navigate down
-                PlaySound(selectionSound);
+                playEffect(&audioPlayer, SOUND_SELECTION);
                 selectedOption = (selectedOption + 5) % 4;
             }
             if (IsKeyPressed(KEY_ESCAPE)){ // Open settings menu
-                PlaySound(confirmSound);
+                playEffect(&audioPlayer, SOUND_CONFIRM);
                 previousScreen = TITLE;
                 currentScreen = SETTINGS;
             }
             if (IsKeyPressed(KEY_ENTER)) {
                 switch (selectedOption) {
                     case 0://New game
-                        PlaySound(confirmSound);
+                        playEffect(&audioPlayer, SOUND_CONFIRM);
                         currentScreen = PLAYER_SELECT;
                     break;
                     case 1://Load game
-                        PlaySound(confirmSound);
-                        if (loadGame(ships, projectiles, &selectedPlayers, &targetPlayer, &picking, &roundTimer, &currentState)) {
+                        playEffect(&audioPlayer, SOUND_CONFIRM);
+                        if (loadGame(&match, &terrain, mapBounds, &targetPlayer, &picking)) {
+                            startRecording(); //The replay carries on from the saved state
+                            selectedPlayers = match.playerCount;
                             isMidGame = true;
                             currentScreen = GAME;
-                            PlayMusicStream(gameMusic);
-                            StopMusicStream(backgroundMusic);
+                            playMusic(&audioPlayer, MUSIC_GAME);
+                            stopMusic(&audioPlayer, MUSIC_BACKGROUND);
                         }
                     break;
                     case 2://Settings
-                        PlaySound(confirmSound);
+                        playEffect(&audioPlayer, SOUND_CONFIRM);
                         previousScreen = TITLE;
                         currentScreen = SETTINGS;
                         selectedOption = 0;
@@ -260,7 +423,7 @@ void main(void){
                 const int totalOptions = MAX_PLAYERS + 1; //Total available options
             //Handle key presses
             if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_DOWN)) { //Navigate through available options
-                PlaySound(selectionSound);
+                playEffect(&audioPlayer, SOUND_SELECTION);
                 if (IsKeyPressed(KEY_UP) && selectedPlayers > 2) {
                     selectedPlayers--;
                 } else if (IsKeyPressed(KEY_DOWN) && selectedPlayers < totalOptions) {
@@ -269,27 +432,24 @@ void main(void){
             }
 
             if (IsKeyPressed(KEY_ENTER)) { //Confirm choice
-                PlaySound(confirmSound);
+                playEffect(&audioPlayer, SOUND_CONFIRM);
                 if (selectedPlayers <= MAX_PLAYERS) {
                     //Set which screen to go to next
                     currentScreen = COUNTDOWN;
                     //Change which music is playing
-                    PlayMusicStream(gameMusic);
-                    StopMusicStream(backgroundMusic);
+                    playMusic(&audioPlayer, MUSIC_GAME);
+                    stopMusic(&audioPlayer, MUSIC_BACKGROUND);
                     //Reset all game variables
                     selectAnimation = 0;
                     countdownTimer = 3;
-                    roundTimer = 10.0f;
                     targetPlayer = 1;
-                    //Set the next game state
-                    currentState = DIRECTION_INSTR;
                 } else if (selectedPlayers == totalOptions) { //If last option is selected go to the main menu
                     currentScreen = TITLE;
                 }
             }
 
             if (IsKeyPressed(KEY_ESCAPE)){ //Go to settings menu
-                PlaySound(confirmSound);
+                playEffect(&audioPlayer, SOUND_CONFIRM);
                 previousScreen = PLAYER_SELECT;
                 currentScreen = SETTINGS;
             }
@@ -330,7 +490,19 @@ void main(void){
             if (countdownTimer <= -1) { //When the timer reaches -1 start the game
                 isMidGame = true;
                 currentScreen = GAME; // Transition to game screen
-                initializeShips(ships, selectedPlayers); //Initialize all ships
+                initializeMatch(&match, selectedPlayers, 1, &terrain, mapBounds, SIMULATION_TICK_RATE); //Initialize all ships
+                if (serverAddress != NULL) { //The server runs the match, it is only played out here
+                    isOnline = connectMatchClient(&matchClient, serverAddress, selectedPlayers, serverSeats > 0 && serverSeats < selectedPlayers ? serverSeats : selectedPlayers, mapBounds);
+                    matchClient.isWaiting = 1; //Until the server sends the starting state
+                    if (!isOnline) { //Go back to the main menu
+                        closeMatchClient(&matchClient);
+                        isMidGame = false;
+                        currentScreen = TITLE;
+                        stopMusic(&audioPlayer, MUSIC_GAME);
+                        playMusic(&audioPlayer, MUSIC_BACKGROUND);
+                    }
+                }
+                else startRecording();
             }
 
             BeginDrawing();
@@ -345,7 +517,7 @@ void main(void){
             break;
             case GAME:
                 if (IsKeyPressed(KEY_ESCAPE)) { //Go to settings menu
-                    PlaySound(confirmSound);
+                    playEffect(&audioPlayer, SOUND_CONFIRM);
                     previousScreen = GAME;
                     currentScreen = SETTINGS;
                 }
@@ -356,187 +528,168 @@ void main(void){
             BeginMode2D(camera); //Begin rendering in the 2D camera mode
             DrawTexture(gameMapTexture, 0, 0, WHITE); //Draw game map
 
-            switch (currentState) {//Current game state
+            PROFILE_BEGIN(PROFILE_GAME_LOGIC); //Orders and simulation
+            if (isOnline && !updateOnlineMatch(&terrain)) { //End the game if the server is gone
+                printf("Lost the connection to the server\n");
+                endGame();
+            }
+            else if (isOnline && match.isOver) endGame(); //Ended by the server
+            switch (match.state) {//Current game state
                 case DIRECTION_INSTR: { //Giving direction and speed instructions
                     selectAnimation = fmod(selectAnimation + GetFrameTime()*M_PI, M_PI*2); //Increase selectAnimation counter until 2*Pi is reached then reset
                     Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), camera); //Get the mouse position on the game map as the camera sees it
-                    while (ships[picking].isAlive == 0) picking ++; //Make sure the ship currently selected is alive
-                    ships[picking].heading = atan2f(mousePos.y-ships[picking].position.y, mousePos.x-ships[picking].position.x); //Set ship heading to where the mouse points
-                    if (picking >= selectedPlayers) { //If all ships have given their instructions start movement
-                        currentState = MOVEMENT_A;
+                    if (isOnline && matchClient.isWaiting) { //Nothing to do until the server has every order
+                        DrawText("Waiting for the other players", 20, 20, 40, WHITE);
+                        break;
+                    }
+                    while (picking < selectedPlayers && (ships->isAlive[picking] == 0 || !isLocalShip(picking))) picking ++; //Make sure the ship currently selected is alive and played here
+                    if (picking >= selectedPlayers) { //If all ships have given their instructions start movement, or send them to the server
+                        if (isOnline) submitOrders(&matchClient, &match);
+                        else confirmOrders(&match);
                         picking = 0;
+                        break;
                     }
+                    Vector2 position = {ships->positionX[picking], ships->positionY[picking]};
+                    ships->heading[picking] = atan2f(mousePos.y-position.y, mousePos.x-position.x); //Set ship heading to where the mouse points
                     if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) { //Confirm choice
                         //Set ship speed based on cursor distance from center of ship
-                        ships[picking].speed = fminf(Vector2Length(Vector2Subtract(GetScreenToWorld2D(GetMousePosition(), camera), ships[picking].position)), maxShipSpeed*2)/2;
+                        setMovementOrder(&match, picking, ships->heading[picking], fminf(Vector2Length(Vector2Subtract(mousePos, position)), maxShipSpeed*2)/2);
                         picking ++;
                     }
                     break;
                 }
-                case MOVEMENT_A: {//First half of movement phase
-                    updateShipPositions(ships, selectedPlayers, GetFrameTime()); //Update the ship positions
-                    roundTimer -= GetFrameTime(); //Decrement the round timer
-                    checkShipCollisions(ships, selectedPlayers); //Check for ship-ship collisions
-                    for (int i = 0; i < selectedPlayers; i++) {
-                        if (ships[i].position.x > mapBounds.x || ships[i].position.y > mapBounds.y) ships[i].isAlive = 0; //Kill any ships that are outside the map
-                        ships[i].isAlive = (1 - checkTerrainCollision(ships[i], readSections, segmentCount))*ships[i].isAlive; //Check for ship-terrain collisions
-                    }
-                    if (playersAlive(ships, selectedPlayers) == 0) { //If no players are alive end the game
-                        endGame();
-                    }
-                    if (roundTimer <= 5 && playersAlive(ships, selectedPlayers) > 1) { //If the round timer has passed the halfway point and there are more than 1 ships alive move on to firing instructions
-                        currentState = FIRE_INSTR;
-                        resetProjectiles(projectiles, selectedPlayers);
-                    }
-                    else if (roundTimer <= 0){ //Otherwise if the round timer has ended end the game
-                        endGame();
-                    }
-                    break;
-                }
                 case FIRE_INSTR: { //Give shooting instructions
                     selectAnimation = fmod(selectAnimation + GetFrameTime()*M_PI, M_PI*2);
                     Vector2 mousePos = GetScreenToWorld2D(GetMousePosition(), camera);
-                    while (ships[picking].isAlive == 0) picking++;
+                    if (isOnline && matchClient.isWaiting) { //Nothing to do until the server has every order
+                        DrawText("Waiting for the other players", 20, 20, 40, WHITE);
+                        break;
+                    }
+                    while (picking < selectedPlayers && (ships->isAlive[picking] == 0 || !isLocalShip(picking))) picking++;
                     //Select a target that is alive and is not the ship currently picking
-                    while (ships[targetPlayer].isAlive == 0 || targetPlayer == picking) targetPlayer = (targetPlayer + 1) % selectedPlayers;
-                    if (picking >= selectedPlayers) { //After all ship shave picked move on to the second part of the movement phase
-                        currentState = MOVEMENT_B;
+                    while (ships->isAlive[targetPlayer] == 0 || targetPlayer == picking) targetPlayer = (targetPlayer + 1) % selectedPlayers;
+                    if (picking >= selectedPlayers) { //After all ship shave picked move on to the second part of the movement phase, or send the orders to the server
+                        if (isOnline) submitOrders(&matchClient, &match);
+                        else confirmOrders(&match);
                         picking = 0;
                         break;
                     }
 
                     //Set the heading of the projectile to where the mouse is pointing
-                    projectiles[picking].heading = atan2f(mousePos.y-ships[picking].position.y, mousePos.x-ships[picking].position.x);
+                    ships->aimHeading[picking] = atan2f(mousePos.y-ships->positionY[picking], mousePos.x-ships->positionX[picking]);
                     //Set the angle of the projectile based on the scroll wheel movement
-                    projectiles[picking].angle = fmaxf(fminf(GetMouseWheelMove()*0.01f+projectiles[picking].angle, M_PI/2), 0);
+                    ships->aimAngle[picking] = fmaxf(fminf(GetMouseWheelMove()*0.01f+ships->aimAngle[picking], M_PI/2), 0);
 
                     Line targetLine; //Initialize the target line variable
 
-                    if (playersAlive(ships, selectedPlayers) > 1) { //If there are more than 1 ships alive change current target
+                    if (playersAlive(ships) > 1) { //If there are more than 1 ships alive change current target
                         if (IsKeyPressed(KEY_DOWN)) {
                             if (--targetPlayer<0) targetPlayer = selectedPlayers-1;
-                            while (ships[targetPlayer].isAlive == 0 || picking == targetPlayer) --targetPlayer < 0 ? targetPlayer = selectedPlayers-1 : targetPlayer;
+                            while (ships->isAlive[targetPlayer] == 0 || picking == targetPlayer) --targetPlayer < 0 ? targetPlayer = selectedPlayers-1 : targetPlayer;
                         }
                         if (IsKeyPressed(KEY_UP)) {
                             if (++targetPlayer>=selectedPlayers) targetPlayer = 0;
-                            while (ships[targetPlayer].isAlive == 0 || picking == targetPlayer) ++targetPlayer >= selectedPlayers ? targetPlayer = 0 : targetPlayer;
+                            while (ships->isAlive[targetPlayer] == 0 || picking == targetPlayer) ++targetPlayer >= selectedPlayers ? targetPlayer = 0 : targetPlayer;
                         }
                         //Calculate the line on which both the picking and target ship will end up on
                         targetLine = getTargetLine(ships, picking,  targetPlayer);
                     }
                     //If the target line is enabled, display it
                     if (settings.enableTargetLine) DrawLineV(targetLine.start, targetLine.end, RED);
+                    //If aim assist is enabled show where to shoot to hit the target, holding space aims there
+                    if (settings.enableAimAssist && playersAlive(ships) > 1) {
+                        Vector2 from = {ships->positionX[picking] + ships->distanceMovedX[picking], ships->positionY[picking] + ships->distanceMovedY[picking]};
+                        Vector2 to = {ships->positionX[targetPlayer] + ships->distanceMovedX[targetPlayer], ships->positionY[targetPlayer] + ships->distanceMovedY[targetPlayer]};
+                        FiringSolution solution = solveFiringSolution(from, to, Vector2Zero(), 0); //Ships don't move while projectiles fly
+                        Color assistColor = solution.reachable ? GREEN : GRAY; //Gray when the target is out of range
+                        DrawLineV(from, solution.impact, assistColor);
+                        DrawCircleLinesV(solution.impact, SHIP_HALF_LENGTH, assistColor);
+                        if (IsKeyDown(KEY_SPACE)) {
+                            ships->aimHeading[picking] = solution.heading;
+                            ships->aimAngle[picking] = solution.angle;
+                        }
+                    }
 
                     if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {//Confirm choice
-                        projectiles[picking].position.x = ships[picking].position.x + ships[picking].distanceMoved.x;
-                        projectiles[picking].position.y = ships[picking].position.y + ships[picking].distanceMoved.y;
+                        setFireOrder(&match, picking, ships->aimHeading[picking], ships->aimAngle[picking]);
                         targetPlayer = (++picking + 1) % selectedPlayers;
                     }
                     break;
                 }
-                case MOVEMENT_B: { //Second half of movement phase
-                    //Mostly same as MOVEMENT_A
-                    updateShipPositions(ships, selectedPlayers, GetFrameTime());
-                    roundTimer -=GetFrameTime();
-                    checkShipCollisions(ships, selectedPlayers);
-                    for (int i = 0; i < selectedPlayers; i++) {
-                        if (ships[i].position.x > mapBounds.x || ships[i].position.y > mapBounds.y) ships[i].isAlive = 0;
-                        ships[i].isAlive = (1 - checkTerrainCollision(ships[i], readSections, segmentCount))*ships[i].isAlive;
-                    }
-                    if (playersAlive(ships, selectedPlayers) == 0) {
+                case MOVEMENT_A: //The movement and shooting phases are resolved by the match
+                case MOVEMENT_B:
+                case FIRE: {
+                    const int shellsBefore = projectiles->count, aliveBefore = playersAlive(ships);
+                    PROFILE_BEGIN(PROFILE_SIMULATION);
+                    updateMatch(&match, GetFrameTime()); //The match runs at a fixed tick rate no matter the frame rate
+                    PROFILE_END(PROFILE_SIMULATION);
+                    //Queue a sound for every shell fired, ship sunk and shell landing in the water, the audio player merges the ones that come together
+                    const int sunk = aliveBefore - playersAlive(ships);
+                    for (int i = shellsBefore; i < projectiles->count; i++) playEffect(&audioPlayer, SOUND_CANNON_FIRE);
+                    for (int i = 0; i < sunk; i++) playEffect(&audioPlayer, SOUND_HIT);
+                    for (int i = projectiles->count; i < shellsBefore - sunk; i++) playEffect(&audioPlayer, SOUND_SPLASH);
+                    if (match.isOver) { //End the game once the match has been decided
                         endGame();
                     }
-                    if (roundTimer <= 0) { //If round timer ends go to shooting phase
-                        currentState = FIRE;
-                        initializeProjectiles(projectiles, ships, selectedPlayers); //Initialize all projectiles
-                    }
-                    break;
-                }
-                case FIRE: { //Shooting phase
-                    updateProjectiles(projectiles, selectedPlayers, GetFrameTime()); //Update projectile positions
-                    //Calculate the number of projectiles still flying
-                    int projectilesAlive = 0;
-                    for (int i = 0; i<selectedPlayers; i++) {
-                        int aliveState = (1-checkProjectileCollision(ships[i], projectiles, selectedPlayers))*ships[i].isAlive; //Check for projectile-ship collisions
-                        ships[i].isAlive = aliveState;
-                        //Projectiles are considered to be flying if their position on the z-axis is above 0
-                        if (projectiles[i].position.z>0)  projectilesAlive++;
-                    }
-                    if (projectilesAlive==0) { //If no projectiles are alive
-                        resetProjectiles(projectiles, selectedPlayers);//Reset the projectiles
-                        if (playersAlive(ships, selectedPlayers) <= 1) { //End the game if there aren't more than 1 players alive
-                            endGame();
-                        }
-                        else { //If there are more than 1 players start a new round
-                            //Reset game variables
-                            currentState = DIRECTION_INSTR;
-                            roundTimer = 10.0f;
-                            picking = 0;
-                            targetPlayer = 1;
-                            for (int i = 0 ; i<selectedPlayers; i++) {
-                                ships[i].distanceMoved = (Vector2){0}; //Reset the logged distance moved by the ships
-                            }
-                        }
+                    else if (match.state == DIRECTION_INSTR) { //If a new round has started reset the picking variables
+                        picking = 0;
+                        targetPlayer = 1;
+                        saveGame(&match, targetPlayer, picking); //Autosave at the start of every round
                     }
                 }
             }
+            PROFILE_END(PROFILE_GAME_LOGIC);
+            PROFILE_BEGIN(PROFILE_QUEUE_SPRITES);
             for (int i = 0; i < selectedPlayers; i++) { //Draw ships
-                Ship ship = ships[i]; //Current ship
+                Ship ship = getShip(ships, i); //Current ship
+                ship.position = getShipRenderPosition(&match, i); //Draw the ship between its last two simulated positions
                 if (ship.isAlive) {//If the ship is alive
                     Vector2 lineStart = ship.position; //Store ship position
-                    if (i==picking && (currentState==DIRECTION_INSTR||currentState==FIRE_INSTR)) { //If current ship is the one picking during the direction or shooting instructions
+                    if (i==picking && (match.state==DIRECTION_INSTR||match.state==FIRE_INSTR)) { //If current ship is the one picking during the direction or shooting instructions
                         float arrowLength = Vector2Length(Vector2Subtract(GetScreenToWorld2D(GetMousePosition(), camera), ship.position)); //Calculate the visualizer arrow length
                         //During the shooting instructions phase calculate arrow length based on projectile angle
-                        arrowLength = currentState == FIRE_INSTR ? 200*(M_PI/2 - projectiles[i].angle)/(M_PI/2) : fminf(arrowLength, maxShipSpeed*2);
+                        arrowLength = match.state == FIRE_INSTR ? 200*(M_PI/2 - ships->aimAngle[i])/(M_PI/2) : fminf(arrowLength, maxShipSpeed*2);
+                        //The movement arrow turns red when the course runs the ship aground before the round ends
+                        Color arrowColor = WHITE;
+                        if (match.state == DIRECTION_INSTR && getClearCourseLength(&terrain, ship.position, ship.heading, arrowLength/2*ROUND_LENGTH) < arrowLength/2*ROUND_LENGTH) arrowColor = RED;
                         //Draw the arrow
-                        DrawRectanglePro((Rectangle){ship.position.x, ship.position.y, 10, arrowLength}, (Vector2){5,0}, (currentState==DIRECTION_INSTR?ship.heading:projectiles[i].heading) * RAD2DEG + 270, WHITE);
-                        DrawTriangle(Vector2Add(lineStart, Vector2Rotate((Vector2){arrowLength, -10}, (currentState==DIRECTION_INSTR?ship.heading:projectiles[i].heading))), Vector2Add(lineStart, Vector2Rotate((Vector2){arrowLength, 10}, (currentState==DIRECTION_INSTR?ship.heading:projectiles[i].heading))), Vector2Add(lineStart, Vector2Rotate((Vector2){arrowLength+40, 0}, (currentState==DIRECTION_INSTR?ship.heading:projectiles[i].heading))), WHITE);
+                        DrawRectanglePro((Rectangle){ship.position.x, ship.position.y, 10, arrowLength}, (Vector2){5,0}, (match.state==DIRECTION_INSTR?ship.heading:ships->aimHeading[i]) * RAD2DEG + 270, arrowColor);
+                        DrawTriangle(Vector2Add(lineStart, Vector2Rotate((Vector2){arrowLength, -10}, (match.state==DIRECTION_INSTR?ship.heading:ships->aimHeading[i]))), Vector2Add(lineStart, Vector2Rotate((Vector2){arrowLength, 10}, (match.state==DIRECTION_INSTR?ship.heading:ships->aimHeading[i]))), Vector2Add(lineStart, Vector2Rotate((Vector2){arrowLength+40, 0}, (match.state==DIRECTION_INSTR?ship.heading:ships->aimHeading[i]))), arrowColor);
                     }
-                    //Draw ship texture
-                    DrawTexturePro(
-                        shipTexture,
-                        (Rectangle){0, 0, (float)shipTexture.width, (float)shipTexture.height},
-                        (Rectangle){ship.position.x, ship.position.y, 100, 100},
-                        (Vector2){50, 50},
-                        ship.heading * RAD2DEG + 270,
+                    //Queue the ship sprite, the sprites are drawn together once the frame is done
+                    addSprite(&spriteBatch, SPRITE_SHIP, ship.position, (Vector2){100, 100}, ship.heading + 3*PI/2,
                         //Change the color of the ship if it is selected
-                        (Color){255, i==targetPlayer&&currentState==FIRE_INSTR? 128 : 255, i==targetPlayer&&currentState==FIRE_INSTR? 128 : 255, (currentState==DIRECTION_INSTR||currentState==FIRE_INSTR)&&i==picking?205-50*cos(selectAnimation) : 255});
+                        (Color){255, i==targetPlayer&&match.state==FIRE_INSTR? 128 : 255, i==targetPlayer&&match.state==FIRE_INSTR? 128 : 255, (match.state==DIRECTION_INSTR||match.state==FIRE_INSTR)&&i==picking?205-50*cos(selectAnimation) : 255});
                 }
             }
             //Draw projectile related objects only during shooting instructions or during shooting phase
-            if (currentState == FIRE_INSTR || currentState == FIRE) {
-                for (int i = 0 ; i<selectedPlayers; i++) {
-                    if (currentState == FIRE&&projectiles[i].position.z>0) //During firing phase draw any flying projectiles
-                        DrawTexturePro(
-                            cannonBallTexture,
-                            (Rectangle){0,0, cannonBallTexture.width, cannonBallTexture.height},
-                            (Rectangle){projectiles[i].position.x, projectiles[i].position.y,10+0.1f*projectiles[i].position.z,10+0.1f*projectiles[i].position.z},
-                            (Vector2){(10+0.1f*projectiles[i].position.z)/2, (10+0.1f*projectiles[i].position.z)/2},
-                            0,
-                            WHITE
-                        );
+            if (match.state == FIRE_INSTR || match.state == FIRE) {
+                for (int i = 0 ; match.state == FIRE && i<projectiles->count; i++) { //During firing phase draw any flying projectiles
+                    Vector3 position = getProjectileRenderPosition(&match, i); //Draw the projectile between its last two simulated positions
+                    float size = 10+0.1f*position.z; //Higher projectiles are drawn bigger
+                    addSprite(&spriteBatch, SPRITE_CANNON_BALL, (Vector2){position.x, position.y}, (Vector2){size, size}, 0, WHITE);
                 }
-                if (currentState == FIRE_INSTR) { //During shooting instructions phase draw 2D illustration of projectile path
-                    float initialZspeed = PROJECTILE_SPEED*sinf(projectiles[picking].angle); //Initial z axis speed of projectile
-                    //Calculate the max distance the projectile will reach
-                    float maxDistance = PROJECTILE_SPEED*cosf(projectiles[picking].angle)*((initialZspeed+sqrtf(20*GRAVITY+initialZspeed*initialZspeed))/GRAVITY);
-                    //Draw individual points on the projectile path
-                    for (float p  = 0; p <= 30; p++) {
-                        //Calculate x and y positions based on the laws of motion
-                        float xPos = p*maxDistance/30;
-                        Ship ship = ships[picking];
-                        float initialX = xPos;
-                        float initialY = getLinePoint(projectiles[picking], xPos);
-                        float projectileHeading = projectiles[picking].heading;
-                        //Rotate the path of the projectile based on its heading
-                        float rotatedX = initialX*cosf(projectileHeading) - initialY*sinf(projectileHeading);
-                        float rotatedY = initialX*sinf(projectileHeading) + initialY*cosf(projectileHeading);
-                        DrawCircle(rotatedX+ship.position.x+ship.distanceMoved.x, rotatedY+ship.position.y+ship.distanceMoved.y, 3, initialY<=15 ? RED : BLACK);
+                if (match.state == FIRE_INSTR) { //During shooting instructions phase draw 2D illustration of projectile path
+                    //The path is only recomputed when the aim or the picking ship changes
+                    Vector2 origin = {ships->positionX[picking] + ships->distanceMovedX[picking], ships->positionY[picking] + ships->distanceMovedY[picking]};
+                    updateTrajectoryPreview(&trajectoryPreview, origin, ships->aimHeading[picking], ships->aimAngle[picking]);
+                    for (int i = 0; i < trajectoryPreview.pointCount; i++) { //Points low enough to hit a ship are red
+                        bool isLow = i < trajectoryPreview.climbIndex || i >= trajectoryPreview.dropIndex;
+                        addSprite(&spriteBatch, SPRITE_DOT, trajectoryPreview.points[i], (Vector2){6, 6}, 0, isLow ? RED : BLACK);
                     }
                 }
             }
+            PROFILE_END(PROFILE_QUEUE_SPRITES);
+            PROFILE_BEGIN(PROFILE_DRAW_SPRITES);
+            drawSpriteBatch(&spriteBatch); //Draw every ship, projectile and trajectory dot of the frame in one batch
+            PROFILE_END(PROFILE_DRAW_SPRITES);
             EndMode2D();
+#ifdef SHIPBATTLE_PROFILER
+            if (showProfiler) drawProfilerOverlay();
+#endif
+            PROFILE_BEGIN(PROFILE_PRESENT); //Includes waiting for the next refresh
             EndDrawing();
+            PROFILE_END(PROFILE_PRESENT);
             break;
             case END: { //End screen
                 BeginDrawing();
@@ -549,17 +702,17 @@ void main(void){
                     0.0f,
                     WHITE);
                 //If there is 1 player alive write "Victory!". If there are no players alive write "Draw"
-                if (playersAlive(ships, selectedPlayers) == 1){
+                if (playersAlive(ships) == 1){
                     DrawText("Victory!", (screenWidth-MeasureText("Victory!", 100))/2, 150, 100, BLACK);
                 }
-                else if (playersAlive(ships, selectedPlayers) == 0){
+                else if (playersAlive(ships) == 0){
                     DrawText("Draw", (screenWidth-MeasureText("Draw", 100))/2, 150, 100, BLACK);
                 }
                 //Draw navigation instructions
                 DrawText("Press Enter to return to the main menu.", (screenWidth-MeasureText("Press Enter to return to the main menu.", 30))/2, 50, 30, WHITE);
                 if (IsKeyPressed(KEY_ENTER)){ //Go back to main menu
                     currentScreen =TITLE;
-                    currentState = DIRECTION_INSTR;
+                    match.state = DIRECTION_INSTR;
                 }
                 EndDrawing();
                 break;
@@ -567,29 +720,27 @@ void main(void){
             case SETTINGS: {//Settings menu
                 //Handle key presses
                 if (IsKeyPressed(KEY_UP)) {
-                    PlaySound(selectionSound);
-                    selectedOption = (selectedOption - 1 + 7) % 7;
+                    playEffect(&audioPlayer, SOUND_SELECTION);
+                    selectedOption = (selectedOption - 1 + 8) % 8;
                 }
                 if (IsKeyPressed(KEY_DOWN)) {
-                    PlaySound(selectionSound);
-                    selectedOption = (selectedOption + 1) % 7;
+                    playEffect(&audioPlayer, SOUND_SELECTION);
+                    selectedOption = (selectedOption + 1) % 8;
                 }
                 if (IsKeyPressed(KEY_LEFT)||IsKeyPressed(KEY_RIGHT)) {
                     if (selectedOption == 2) {
-                        PlaySound(selectionSound);
+                        playEffect(&audioPlayer, SOUND_SELECTION);
                         settings.musicVolume = IsKeyPressed(KEY_RIGHT) ? fminf(settings.musicVolume + 0.1f, 1.0f) : fmaxf(settings.musicVolume - 0.1f, 0.0f);
-                        SetMusicVolume(backgroundMusic, settings.musicVolume);
-                        SetMusicVolume(gameMusic, settings.musicVolume);
+                        setPlayerMusicVolume(&audioPlayer, settings.musicVolume);
                     }
                     if (selectedOption == 3) {
-                        PlaySound(selectionSound);
+                        playEffect(&audioPlayer, SOUND_SELECTION);
                         settings.soundVolume = IsKeyPressed(KEY_RIGHT) ? fminf(settings.soundVolume + 0.1f, 1.0f) : fmaxf(settings.soundVolume - 0.1f, 0.0f);
-                        SetSoundVolume(confirmSound, settings.soundVolume);
-                        SetSoundVolume(selectionSound, settings.soundVolume);
+                        setPlayerEffectVolume(&audioPlayer, settings.soundVolume);
                     }
                 }
                 else if (IsKeyPressed(KEY_ENTER)) {
-                    PlaySound(confirmSound);
+                    playEffect(&audioPlayer, SOUND_CONFIRM);
                     switch (selectedOption) {
                         case 0://Back
                             currentScreen=previousScreen;
@@ -597,26 +748,31 @@ void main(void){
                         case 1://Target line option
                             settings.enableTargetLine = !settings.enableTargetLine;
                             break;
-                        case 4://How to play instructions
+                        case 4://Aim assist option
+                            settings.enableAimAssist = !settings.enableAimAssist;
+                            break;
+                        case 5://How to play instructions
                             currentScreen = HOW_TO_PLAY;
                             break;
-                        case 5://Main menu
-                            if (isMidGame) saveGame(ships, projectiles, selectedPlayers, targetPlayer, picking, roundTimer, currentState); //Save game state
+                        case 6://Main menu
+                            if (isMidGame) saveGame(&match, targetPlayer, picking); //Save game state
+                            stopRecording();
+                            leaveOnlineMatch();
                             isMidGame = false;
-                            PlaySound(selectionSound);
+                            playEffect(&audioPlayer, SOUND_SELECTION);
                             currentScreen = TITLE;
-                            StopMusicStream(gameMusic);
-                            PlayMusicStream(backgroundMusic);
+                            stopMusic(&audioPlayer, MUSIC_GAME);
+                            playMusic(&audioPlayer, MUSIC_BACKGROUND);
                             selectedOption=0;
                             break;
-                        case 6://Exit to desktop
-                            if (isMidGame) saveGame(ships, projectiles, selectedPlayers, targetPlayer, picking, roundTimer, currentState); //Save game state
+                        case 7://Exit to desktop
+                            if (isMidGame) saveGame(&match, targetPlayer, picking); //Save game state
                             shouldExit = 1;
                             break;
                     }
                 }
                 if (IsKeyPressed(KEY_ESCAPE)) {//Go back
-                    PlaySound(confirmSound);
+                    playEffect(&audioPlayer, SOUND_CONFIRM);
                     currentScreen = previousScreen;
                 }
                 //Draw text
@@ -627,11 +783,12 @@ void main(void){
                 DrawText(TextFormat("%s", settings.enableTargetLine ? "Target line enabled" : "Target line disabled"), 100, 250, 30, selectedOption == 1? RED : BLACK);
                 DrawText(TextFormat("Music Volume: %.1f", settings.musicVolume), 100, 300, 30, selectedOption == 2 ? RED : BLACK);
                 DrawText(TextFormat("Sound Volume: %.1f", settings.soundVolume), 100, 350, 30, selectedOption == 3 ? RED : BLACK);
-                DrawText("How to Play Instructions", 100, 400, 30, selectedOption == 4 ? RED : BLACK);
-                DrawText(TextFormat("Go To Main Menu"), 100, 450, 30, selectedOption == 5 ? RED : BLACK);
-                DrawText(TextFormat("Exit to desktop"), 100, 500, 30, selectedOption == 6 ? RED : BLACK);
-                DrawText("Use UP/DOWN to navigate, LEFT/RIGHT to adjust", 100, 600, 20, BLACK);
-                DrawText("Press ENTER to select, ESC to return", 100, 650, 20, BLACK);
+                DrawText(TextFormat("%s", settings.enableAimAssist ? "Aim assist enabled" : "Aim assist disabled"), 100, 400, 30, selectedOption == 4 ? RED : BLACK);
+                DrawText("How to Play Instructions", 100, 450, 30, selectedOption == 5 ? RED : BLACK);
+                DrawText(TextFormat("Go To Main Menu"), 100, 500, 30, selectedOption == 6 ? RED : BLACK);
+                DrawText(TextFormat("Exit to desktop"), 100, 550, 30, selectedOption == 7 ? RED : BLACK);
+                DrawText("Use UP/DOWN to navigate, LEFT/RIGHT to adjust", 100, 650, 20, BLACK);
+                DrawText("Press ENTER to select, ESC to return", 100, 700, 20, BLACK);
                 EndDrawing();
                 break;
             }
@@ -646,6 +803,7 @@ void main(void){
                 DrawText ("as well as a helpful red line for each pair of ships indicating their final positions between them.",100, 400, 30, BLACK );
                 DrawText ("You can wander around each opponent's final position relative to yours by pressing the up and down arrows.",100, 500, 30, BLACK );
                 DrawText("To attack, aim based on the final positions of the ships and fire using Left click.", 100, 550, 30, BLACK);
+                DrawText("With aim assist enabled, hold Space to aim at the selected opponent.", 100, 600, 30, BLACK);
                 DrawText ("Adjust the firing angle with the scroll wheel. After the pause, the ships movement continues, ",100, 650, 30, BLACK );
                 DrawText ("while at the end of the movement the shots are fired. ",100, 700, 30, BLACK );
                 DrawText ("The process repeats until a player is crowned the winner of the game or until all players are eliminated.", 100, 800, 30, BLACK  );
@@ -654,35 +812,48 @@ void main(void){
                 EndDrawing();
 
                 if (IsKeyPressed(KEY_ESCAPE)) {//Go back
-                    PlaySound(confirmSound);
+                    playEffect(&audioPlayer, SOUND_CONFIRM);
                     currentScreen = previousScreen;
                 }
                 break;
             }
         }
+        PROFILE_END(PROFILE_FRAME);
+#ifdef SHIPBATTLE_PROFILER
+        updateProfilerKeys();
+        endProfileFrame(&profiler);
+#endif
     }
+#ifdef SHIPBATTLE_PROFILER
+    stopProfiler(&profiler); //Finish any capture
+#endif
     //Unload all textures
     UnloadTexture(gameMapTexture);
     UnloadTexture(backgroundTexture);
-    UnloadTexture(shipTexture);
-    UnloadTexture(cannonBallTexture);
+    unloadSpriteAtlas(&spriteAtlas);
+    freeSpriteBatch(&spriteBatch);
 
     // Unload audio resources
-    UnloadMusicStream(backgroundMusic);
-    UnloadMusicStream(gameMusic);
-    UnloadSound(selectionSound);
-    UnloadSound(confirmSound);
+    stopAudioPlayer(&audioPlayer);
     CloseAudioDevice();
+    closeAssetPack(&assetPack); //Packed music is streamed from the pack until here
 
-    if (isMidGame) saveGame(ships, projectiles, selectedPlayers, targetPlayer, picking, roundTimer, currentState); //Save game state
+    if (isMidGame) saveGame(&match, targetPlayer, picking); //Save game state
+    stopSaveWriter(&saveWriter); //Wait for the last save to reach the disk
+    stopRecording();
+    waitForAsyncWriters(); //Let every replay finished in the background reach its file
+    leaveOnlineMatch();
     saveSettings(); //Save settings
+    freeMatch(&match); //Free the ships and projectiles
+    freeTerrainGrid(&terrain); //Free the map
+    closeCompiledMap(&map);
     CloseWindow();//Close the window
 }
 
 //Calculates the start and end positions of a line spanning across the whole map defined by the final positions of ships A and B
-Line getTargetLine(Ship ships[], int shipA, int shipB) {
-    Ship shipOrigin = ships[shipA]; //Origin ship
-    Ship shipTarget = ships[shipB]; //Target ship
+Line getTargetLine(const Fleet *ships, int shipA, int shipB) {
+    Ship shipOrigin = getShip(ships, shipA); //Origin ship
+    Ship shipTarget = getShip(ships, shipB); //Target ship
     //Get final ship positions
     shipOrigin.position = Vector2Add(shipOrigin.position, shipOrigin.distanceMoved);
     shipTarget.position = Vector2Add(shipTarget.position, shipTarget.distanceMoved);
@@ -703,75 +874,19 @@ Line getTargetLine(Ship ships[], int shipA, int shipB) {
 }
 
 
-//Save the current game state to a file named "save.dat"
-void saveGame(Ship *ships, Projectile *projectiles, int selectedPlayers, int targetPlayer, int picking, float roundTimer, GameState gameState) {
-    FILE *f = fopen("save.dat", "wb"); //Open the file in write binary mode
-    if (f == NULL) {//Check if file was opened correctly
-        printf("Failed to save game!\n");
-    }
-    else {//Create struct with all variables to save
-        struct {
-            Ship shipsArray[MAX_PLAYERS];
-            Projectile prjectileArray[MAX_PLAYERS];
-            int numPlayers;
-            int trgtPlayer;
-            int pickingPlayer;
-            float rndTimer;
-            GameState state;
-        } saveStruct;
-
-        saveStruct.numPlayers  = selectedPlayers;
-        saveStruct.trgtPlayer = targetPlayer;
-        saveStruct.pickingPlayer = picking;
-        saveStruct.rndTimer = roundTimer;
-        saveStruct.state = gameState;
-
-        for (int i = 0; i < MAX_PLAYERS; i++) {
-            saveStruct.shipsArray[i] = ships[i];
-            saveStruct.prjectileArray[i] = projectiles[i];
-        }
-        //Write the data to the file
-        if (fwrite(&saveStruct, sizeof(saveStruct), 1, f)!=1) {
-            printf("Failed to save game!\n");
-        }
-    }
-    fclose(f);//Close the file
+//Save the current game state to a file named "save.dat". The state is captured right away and written in the background
+void saveGame(const Match *match, int targetPlayer, int picking) {
+    if (isOnline) return; //Online matches can't be resumed alone
+    requestSave(&saveWriter, match, targetPlayer, picking);
 }
 
 //Load the previous game state from a file named "save.dat"
-bool loadGame(Ship *ships, Projectile *projectiles, int *selectedPlayers, int *targetPlayer, int *picking, float *roundTimer, GameState *gameState) {
-    FILE *f = fopen("save.dat", "rb"); //Open the file in read binary mode
-    if (f == NULL) {//Ensure file was opened correctly
+bool loadGame(Match *match, const TerrainGrid *terrain, Vector2 mapBounds, int *targetPlayer, int *picking) {
+    finishSaves(&saveWriter); //Make sure the latest save has been written
+    if (!loadSaveFile("save.dat", match, terrain, mapBounds, targetPlayer, picking)) {
         printf("Failed to load game!\n");
-        fclose(f);
-        return false;
-    }//Create struct to store the data from the file
-    struct {
-            Ship shipsArray[MAX_PLAYERS];
-            Projectile prjectileArray[MAX_PLAYERS];
-            int numPlayers;
-            int trgtPlayer;
-            int pickingPlayer;
-            float rndTimer;
-            GameState state;
-        } saveStruct;
-    //Read the data
-    if (fread(&saveStruct, sizeof(saveStruct), 1, f)!=1) {
-        fclose(f);
         return false;
     }
-    //Set all local variables to those read from the file
-    //Returns true if successful and false if not
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        ships[i] = saveStruct.shipsArray[i];
-        projectiles[i] = saveStruct.prjectileArray[i];
-    }
-    *selectedPlayers = saveStruct.numPlayers;
-    *targetPlayer = saveStruct.trgtPlayer;
-    *picking = saveStruct.pickingPlayer;
-    *roundTimer = saveStruct.rndTimer;
-    *gameState = saveStruct.state;
-    fclose(f);
     return true;
 }
 
@@ -799,8 +914,12 @@ void loadSettings() {
         return;
     }
     //Read the data from the file and write it to the local settings struct
-    if (fread(&settings, sizeof(settings), 1, f)!=1) {
+    unsigned char saved[sizeof(settings)];
+    size_t length = fread(saved, 1, sizeof(saved), f); //Older files are shorter, the fields they lack keep their defaults
+    if (length < SETTINGS_FIRST_SIZE) {
         printf("Failed to load settings!\n");
+    } else {
+        memcpy(&settings, saved, length);
     }
     fclose(f);
 }
\ No newline at end of file
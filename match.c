@@ -0,0 +1,265 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+
+#include "ballistics.h"
+#include "match.h"
+#include "profiler.h"
+#include "replay.h"
+
+//Allocates every per ship array of the match from its arena. Returns 1 if successful and 0 if the arena is full
+static int allocateMatch(Match *match, int playerCount, int volleySize) {
+    Arena *arena = &match->arena;
+    int allocated = allocateFleet(&match->ships, playerCount, arena);
+    allocated = allocateProjectiles(&match->projectiles, playerCount*volleySize, arena) && allocated;
+    allocated = allocateSweepAndPrune(&match->broadPhase, playerCount, arena) && allocated;
+    match->geometry = arenaAlloc(arena, playerCount*sizeof(ShipGeometry));
+    match->previousShipPositions = arenaAlloc(arena, playerCount*sizeof(Vector2));
+    match->previousProjectilePositions = arenaAlloc(arena, playerCount*volleySize*sizeof(Vector3));
+    return allocated && match->previousProjectilePositions != NULL;
+}
+
+//Starts a new match with the provided number of players and projectiles per volley on the provided map. Returns 1 if successful and 0 if out of memory
+int initializeMatch(Match *match, int playerCount, int volleySize, const TerrainGrid *terrain, Vector2 mapBounds, int tickRate) {
+    Arena arena = match->arena; //The memory of the last match is reused when it is big enough
+    *match = (Match){0};
+    //Measure the memory the match needs, then allocate it in one block
+    allocateMatch(match, playerCount, volleySize);
+    size_t size = match->arena.used;
+    match->arena = arena;
+    if (match->arena.size < size + ARENA_ALIGNMENT) {
+        freeArena(&match->arena);
+        if (!createArena(&match->arena, size)) return 0;
+    }
+    resetArena(&match->arena);
+    if (!allocateMatch(match, playerCount, volleySize)) return 0;
+
+    match->playerCount = playerCount;
+    match->volleySize = volleySize;
+    match->state = DIRECTION_INSTR;
+    match->roundTimer = ROUND_LENGTH;
+    match->terrain = terrain;
+    match->mapBounds = mapBounds;
+    match->tickLength = 1.0f/tickRate;
+    initializeShips(&match->ships, terrain, mapBounds); //Initialize all ships
+    updateShipGeometry(&match->ships, match->geometry);
+    resetSweepAndPrune(&match->broadPhase);
+    for (int i = 0; i < playerCount; i++) {
+        match->previousShipPositions[i] = (Vector2){match->ships.positionX[i], match->ships.positionY[i]};
+    }
+    return 1;
+}
+
+//Frees the memory of the match
+void freeMatch(Match *match) {
+    freeArena(&match->arena);
+    *match = (Match){0};
+}
+
+//Sets the heading and speed a ship will follow during the movement phases
+void setMovementOrder(Match *match, int ship, float heading, float speed) {
+    match->ships.heading[ship] = heading;
+    match->ships.speed[ship] = speed;
+}
+
+//Sets the heading and elevation of a ship's shot. The shot is fired from where the ship will be at the end of the round
+void setFireOrder(Match *match, int ship, float heading, float angle) {
+    match->ships.aimHeading[ship] = heading;
+    match->ships.aimAngle[ship] = angle;
+}
+
+//Moves on from an instructions phase once every ship has given its orders
+void confirmOrders(Match *match) {
+    if (match->replay != NULL && (match->state == DIRECTION_INSTR || match->state == FIRE_INSTR)) recordReplayOrders(match->replay, match);
+    if (match->state == DIRECTION_INSTR) {
+        updateShipVelocities(&match->ships); //Headings and speeds stay the same for the whole round
+        match->state = MOVEMENT_A;
+    }
+    else if (match->state == FIRE_INSTR) match->state = MOVEMENT_B;
+}
+
+//Remembers where everything is so the renderer can interpolate between ticks
+static void storePreviousPositions(Match *match) {
+    Fleet *ships = &match->ships;
+    ProjectileList *projectiles = &match->projectiles;
+    for (int i = 0; i < match->playerCount; i++) {
+        match->previousShipPositions[i] = (Vector2){ships->positionX[i], ships->positionY[i]};
+    }
+    for (int i = 0; i < projectiles->count; i++) { //Projectiles move around the pool so they are remembered by slot
+        match->previousProjectilePositions[projectiles->slot[i]] = (Vector3){projectiles->positionX[i], projectiles->positionY[i], projectiles->positionZ[i]};
+    }
+}
+
+//Works out when and where every projectile in the air will hit, measured on the clock of the shooting phase
+void scheduleProjectileImpacts(Match *match) {
+    for (int i = 0; i < match->projectiles.count; i++) {
+        scheduleImpact(&match->projectiles, i, &match->ships, match->geometry, match->fireTime, match->fireTime);
+    }
+}
+
+//Applies the hits that happened up to the current time in the order they happened, then retires the projectiles that landed.
+//A projectile whose target was already sunk by an earlier hit carries on and may hit another ship
+static void resolveImpacts(Match *match) {
+    ProjectileList *projectiles = &match->projectiles;
+    Fleet *ships = &match->ships;
+    while (1) {
+        int first = -1; //Earliest projectile whose hit is due
+        for (int i = 0; i < projectiles->count; i++) {
+            if (projectiles->impactTime[i] > match->fireTime || projectiles->impactTime[i] >= projectiles->landingTime[i]) continue;
+            if (first < 0 || projectiles->impactTime[i] < projectiles->impactTime[first]) first = i;
+        }
+        if (first < 0) break;
+        int target = projectiles->target[first];
+        if (ships->isAlive[target]) { //Sink the target and remove the projectile
+            ships->isAlive[target] = 0;
+            retireProjectile(projectiles, first);
+        }
+        else { //Find what the projectile hits after the moment it would have hit the sunk ship
+            scheduleImpact(projectiles, first, ships, match->geometry, match->fireTime, projectiles->impactTime[first]);
+        }
+    }
+    for (int i = projectiles->count - 1; i >= 0; i--) { //Going backwards means the projectile moved into a hole has already been checked
+        if (projectiles->landingTime[i] <= match->fireTime) retireProjectile(projectiles, i);
+    }
+}
+
+//Moves the ships and kills any that collided with each other, the terrain or left the map
+static void moveShips(Match *match, float deltaT) {
+    Fleet *ships = &match->ships;
+    PROFILE_BEGIN(PROFILE_SHIP_MOVEMENT);
+    updateShipPositions(ships, deltaT); //Update the ship positions
+    updateShipGeometry(ships, match->geometry); //Update the hitboxes once for all collision checks
+    PROFILE_END(PROFILE_SHIP_MOVEMENT);
+    match->roundTimer -= deltaT; //Decrement the round timer
+    PROFILE_BEGIN(PROFILE_SHIP_COLLISIONS);
+    checkShipCollisions(ships, match->geometry, &match->broadPhase); //Check for ship-ship collisions
+    PROFILE_END(PROFILE_SHIP_COLLISIONS);
+    PROFILE_BEGIN(PROFILE_TERRAIN_COLLISIONS);
+    for (int i = 0; i < match->playerCount; i++) {
+        if (ships->positionX[i] > match->mapBounds.x || ships->positionY[i] > match->mapBounds.y) ships->isAlive[i] = 0; //Kill any ships that are outside the map
+        ships->isAlive[i] = (1 - checkTerrainCollision(&match->geometry[i], match->terrain))*ships->isAlive[i]; //Check for ship-terrain collisions
+    }
+    PROFILE_END(PROFILE_TERRAIN_COLLISIONS);
+    if (playersAlive(ships) == 0) { //If no players are alive end the game
+        match->isOver = 1;
+    }
+}
+
+//Advances the movement and shooting phases by a single tick. Instruction phases wait for confirmOrders
+void stepMatch(Match *match) {
+    Fleet *ships = &match->ships;
+    ProjectileList *projectiles = &match->projectiles;
+    int playerCount = match->playerCount;
+    float deltaT = match->tickLength; //Every tick has the same length so the results don't depend on the frame rate
+    if (match->isOver) return;
+    storePreviousPositions(match);
+    switch (match->state) {
+        case MOVEMENT_A: { //First half of movement phase
+            moveShips(match, deltaT);
+            if (match->roundTimer <= ROUND_LENGTH/2 && playersAlive(ships) > 1) { //If the round timer has passed the halfway point and there are more than 1 ships alive move on to firing instructions
+                match->state = FIRE_INSTR;
+                for (int i = 0; i < playerCount; i++) { //Reset the aim of every ship
+                    ships->aimHeading[i] = 0;
+                    ships->aimAngle[i] = 0;
+                }
+            }
+            else if (match->roundTimer <= 0){ //Otherwise if the round timer has ended end the game
+                match->isOver = 1;
+            }
+            break;
+        }
+        case MOVEMENT_B: { //Second half of movement phase
+            moveShips(match, deltaT);
+            if (match->roundTimer <= 0) { //If round timer ends go to shooting phase
+                match->state = FIRE;
+                match->fireTime = 0;
+                PROFILE_BEGIN(PROFILE_PROJECTILES);
+                fireVolleys(projectiles, ships, match->volleySize); //Launch the projectiles of every alive ship
+                scheduleProjectileImpacts(match);
+                PROFILE_END(PROFILE_PROJECTILES);
+                for (int i = 0; i < projectiles->count; i++) { //New projectiles have nothing to interpolate from
+                    match->previousProjectilePositions[projectiles->slot[i]] = (Vector3){projectiles->positionX[i], projectiles->positionY[i], projectiles->positionZ[i]};
+                }
+            }
+            break;
+        }
+        case FIRE: { //Shooting phase
+            PROFILE_BEGIN(PROFILE_PROJECTILES);
+            updateProjectiles(projectiles, deltaT); //Update projectile positions
+            match->fireTime += deltaT;
+            resolveImpacts(match); //Apply every hit and landing that happened during this tick
+            PROFILE_END(PROFILE_PROJECTILES);
+            if (projectiles->count == 0) { //If no projectiles are in the air
+                if (playersAlive(ships) <= 1) { //End the game if there aren't more than 1 players alive
+                    match->isOver = 1;
+                }
+                else { //If there are more than 1 players start a new round
+                    match->state = DIRECTION_INSTR;
+                    match->roundTimer = ROUND_LENGTH;
+                    match->round++;
+                    for (int i = 0; i < playerCount; i++) { //Reset the logged distance moved by the ships
+                        ships->distanceMovedX[i] = 0;
+                        ships->distanceMovedY[i] = 0;
+                    }
+                }
+            }
+            break;
+        }
+        default: //Instruction phases are driven by the players
+            break;
+    }
+    if (match->replay != NULL) {
+        PROFILE_BEGIN(PROFILE_REPLAY);
+        recordReplayTick(match->replay, match);
+        PROFILE_END(PROFILE_REPLAY);
+    }
+}
+
+//Simulates as many whole ticks as fit in the time passed since the last frame. The remainder is kept for the next frame
+void updateMatch(Match *match, float frameTime) {
+    match->accumulator += fminf(frameTime, MAX_FRAME_TIME);
+    while (match->accumulator >= match->tickLength && !match->isOver) {
+        GameState state = match->state;
+        if (state == DIRECTION_INSTR || state == FIRE_INSTR) break; //Waiting for orders
+        stepMatch(match);
+        match->accumulator -= match->tickLength;
+    }
+    if (match->state == DIRECTION_INSTR || match->state == FIRE_INSTR || match->isOver) {
+        //Nothing moves while orders are given so there is nothing to interpolate
+        match->accumulator = 0;
+        storePreviousPositions(match);
+    }
+}
+
+//Returns where the ship should be drawn, between its positions at the last two ticks
+Vector2 getShipRenderPosition(Match *match, int ship) {
+    Vector2 position = {match->ships.positionX[ship], match->ships.positionY[ship]};
+    return Vector2Lerp(match->previousShipPositions[ship], position, match->accumulator/match->tickLength);
+}
+
+//Returns where the projectile at the provided index should be drawn, between its positions at the last two ticks
+Vector3 getProjectileRenderPosition(Match *match, int projectile) {
+    ProjectileList *projectiles = &match->projectiles;
+    Vector3 position = {projectiles->positionX[projectile], projectiles->positionY[projectile], projectiles->positionZ[projectile]};
+    return Vector3Lerp(match->previousProjectilePositions[projectiles->slot[projectile]], position, match->accumulator/match->tickLength);
+}
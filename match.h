@@ -0,0 +1,68 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Match state machine shared by the game and the headless tools
+#ifndef MATCH_H
+#define MATCH_H
+#define ROUND_LENGTH 10.0f //Length of the movement part of a round in seconds
+#define SIMULATION_TICK_RATE 120 //Default number of simulation ticks per second
+#define MAX_FRAME_TIME 0.25f //Longest frame time simulated at once, longer hitches slow the game down instead
+#include "broadPhase.h"
+#include "integration.h"
+#include "terrainGrid.h"
+
+typedef enum GameState {DIRECTION_INSTR, MOVEMENT_A, FIRE_INSTR, MOVEMENT_B, FIRE} GameState; //All game states
+
+typedef struct MatchStruct {
+    Arena arena; //Memory of every per ship array, allocated when the match starts
+    Fleet ships; //All ships taking part in the match
+    ProjectileList projectiles; //Projectiles in the air, every ship fires volleySize of them each round
+    ShipGeometry *geometry; //Hitboxes of the ships, updated after every movement tick
+    SweepAndPrune broadPhase; //Ships sorted along the x axis for ship-ship collisions
+    int playerCount; //Number of ships in the match
+    int volleySize; //Projectiles fired by each ship every round
+    GameState state; //Current phase of the round
+    float roundTimer; //Time left in the current round
+    int round; //Number of the current round, starting from 0
+    int isOver; //Set to 1 when the match has ended
+    const TerrainGrid *terrain; //Terrain of the map
+    Vector2 mapBounds; //Ships past these coordinates are out of the map
+    float tickLength; //Length of a simulation tick in seconds
+    float accumulator; //Frame time that hasn't been simulated yet
+    float fireTime; //Time since the projectiles of the current round were fired
+    Vector2 *previousShipPositions; //Ship positions before the last tick, used for render interpolation
+    Vector3 *previousProjectilePositions; //Projectile positions before the last tick, indexed by pool slot
+    struct ReplayRecorderStruct *replay; //Recording of the match, NULL when it isn't recorded
+    struct PathFinderStruct *pathFinder; //Route planner the bots use, NULL when the match has none
+} Match;
+
+int initializeMatch(Match *match, int playerCount, int volleySize, const TerrainGrid *terrain, Vector2 mapBounds, int tickRate);
+void freeMatch(Match *match);
+void setMovementOrder(Match *match, int ship, float heading, float speed);
+void setFireOrder(Match *match, int ship, float heading, float angle);
+void confirmOrders(Match *match);
+void scheduleProjectileImpacts(Match *match);
+void stepMatch(Match *match);
+void updateMatch(Match *match, float frameTime);
+Vector2 getShipRenderPosition(Match *match, int ship);
+Vector3 getProjectileRenderPosition(Match *match, int projectile);
+#endif //MATCH_H
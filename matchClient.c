@@ -0,0 +1,155 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdio.h>
+
+#include "matchClient.h"
+#include "saveFile.h"
+
+//Connects to the server and asks for seatCount seats in a match of playerCount ships. Returns 1 if connected and 0 if not
+int connectMatchClient(MatchClient *client, const char *address, int playerCount, int seatCount, Vector2 mapBounds) {
+    *client = (MatchClient){0};
+    int socket = connectToAddress(address);
+    openConnection(&client->connection, socket);
+    if (socket < 0) {
+        client->connection.failed = 1;
+        return 0;
+    }
+    return joinServerMatch(client, playerCount, seatCount, mapBounds);
+}
+
+//Asks for seatCount seats in a match of playerCount ships, once connected or after the last match has ended. Returns 0 if the connection failed
+int joinServerMatch(MatchClient *client, int playerCount, int seatCount, Vector2 mapBounds) {
+    ByteBuffer *output = &client->connection.output;
+    size_t start = beginMessage(output, MESSAGE_JOIN);
+    putU8(output, playerCount);
+    putU8(output, seatCount);
+    putF32(output, mapBounds.x);
+    putF32(output, mapBounds.y);
+    endMessage(output, start);
+    client->hasJoined = 0;
+    client->isWaiting = 0;
+    return sendMessages(&client->connection);
+}
+
+//Keeps a message until it has been applied
+static void keepMessage(ByteBuffer *buffer, ByteReader *message) {
+    buffer->size = 0;
+    putBytes(buffer, message->data, message->size);
+}
+
+//Sends the queued orders and takes the messages that have arrived. Orders and states are taken one at a time, the next one waits
+//until the last one has been applied, so they are always applied in the order they were resolved. Returns 0 if the connection failed
+int updateMatchClient(MatchClient *client) {
+    NetConnection *connection = &client->connection;
+    if (!sendMessages(connection) || !receiveMessages(connection)) return 0;
+    MessageType type;
+    ByteReader message;
+    while (!client->hasOrders && !client->hasState && takeMessage(connection, &type, &message)) {
+        if (type == MESSAGE_JOINED) {
+            client->matchId = getU32(&message);
+            client->firstSeat = getU8(&message);
+            client->seatCount = getU8(&message);
+            client->playerCount = getU8(&message);
+            client->mapBounds.x = getF32(&message);
+            client->mapBounds.y = getF32(&message);
+            client->hasJoined = !message.failed;
+        }
+        else if (type == MESSAGE_ORDERS) {
+            keepMessage(&client->orders, &message);
+            client->hasOrders = 1;
+        }
+        else if (type == MESSAGE_STATE) {
+            keepMessage(&client->state, &message);
+            client->hasState = 1;
+        }
+        if (message.failed || (type != MESSAGE_JOINED && type != MESSAGE_ORDERS && type != MESSAGE_STATE)) connection->failed = 1;
+    }
+    connection->failed |= client->orders.failed | client->state.failed;
+    return !connection->failed;
+}
+
+//Returns 1 if the ship is played by this client
+int isClientShip(const MatchClient *client, int ship) {
+    return client->hasJoined && ship >= client->firstSeat && ship < client->firstSeat + client->seatCount;
+}
+
+//Sends the orders of every alive ship of this client for the current instructions phase
+void submitOrders(MatchClient *client, const Match *match) {
+    const Fleet *ships = &match->ships;
+    ByteBuffer *output = &client->connection.output;
+    for (int i = client->firstSeat; i < client->firstSeat + client->seatCount && i < match->playerCount; i++) {
+        if (ships->isAlive[i] == 0) continue;
+        size_t start = beginMessage(output, MESSAGE_ORDER);
+        putVarint(output, match->round);
+        putU8(output, match->state);
+        putU8(output, i);
+        putF32(output, match->state == FIRE_INSTR ? ships->aimHeading[i] : ships->heading[i]);
+        putF32(output, match->state == FIRE_INSTR ? ships->aimAngle[i] : ships->speed[i]);
+        endMessage(output, start);
+    }
+    client->isWaiting = 1;
+    sendMessages(&client->connection);
+}
+
+//Gives every ship the order the server received for it and moves on from the instructions phase, so the phase plays out locally.
+//Returns 1 if orders were applied and 0 if there were none. Orders for another phase than the local one are dropped, the state
+//that follows them puts the local match right
+int applyServerOrders(MatchClient *client, Match *match) {
+    if (!client->hasOrders) return 0;
+    client->hasOrders = 0;
+    ByteReader reader = createByteReader(client->orders.data, client->orders.size);
+    uint64_t round = getVarint(&reader);
+    int state = getU8(&reader);
+    uint64_t playerCount = getVarint(&reader);
+    if (reader.failed || round != (uint64_t)match->round || state != (int)match->state || playerCount != (uint64_t)match->playerCount) return 0;
+    if (state != DIRECTION_INSTR && state != FIRE_INSTR) return 0;
+    for (int i = 0; i < match->playerCount; i++) {
+        float heading = getF32(&reader);
+        float value = getF32(&reader);
+        if (state == FIRE_INSTR) setFireOrder(match, i, heading, value);
+        else setMovementOrder(match, i, heading, value);
+    }
+    if (reader.failed) return 0;
+    confirmOrders(match);
+    return 1;
+}
+
+//Replaces the local match with the state the server resolved to. Only call once the local match has played out the phase, or before
+//the first phase. Returns 1 if a state was applied and 0 if there was none or it was damaged
+int applyServerState(MatchClient *client, Match *match, const TerrainGrid *terrain) {
+    if (!client->hasState) return 0;
+    client->hasState = 0;
+    client->isWaiting = 0;
+    int targetPlayer, picking;
+    if (decodeSave(client->state.data, client->state.size, match, terrain, client->mapBounds, &targetPlayer, &picking)) return 1;
+    client->connection.failed = 1; //Can't follow the match anymore
+    return 0;
+}
+
+void closeMatchClient(MatchClient *client) {
+    closeConnection(&client->connection);
+    freeByteBuffer(&client->orders);
+    freeByteBuffer(&client->state);
+    *client = (MatchClient){0};
+    client->connection.socket = -1;
+}
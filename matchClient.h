@@ -0,0 +1,56 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Client of shipbattle_server. Orders of the local ships are sent to the server, which resolves every phase once it has the orders of
+//every ship. The server sends back every order, so the phase can be played out locally, and then the state it resolved to, which
+//replaces the local one
+#ifndef MATCHCLIENT_H
+#define MATCHCLIENT_H
+#include <stdint.h>
+#include "match.h"
+#include "network.h"
+#define MAX_SERVER_PLAYERS 64 //Most ships in a match hosted by the server
+
+typedef struct MatchClientStruct {
+    NetConnection connection;
+    uint32_t matchId;
+    int firstSeat; //Ships of this client are firstSeat to firstSeat + seatCount - 1
+    int seatCount;
+    int playerCount;
+    Vector2 mapBounds; //Of the match on the server, the local match has to use the same ones to play out the same phases
+    int hasJoined; //Set once the server has given out the seats
+    ByteBuffer orders; //Orders of every ship for the phase being resolved, kept until applied
+    int hasOrders;
+    ByteBuffer state; //Match state the server resolved to, kept until applied
+    int hasState;
+    int isWaiting; //Set from submitting the orders of a phase until the state it resolved to is applied
+} MatchClient;
+
+int connectMatchClient(MatchClient *client, const char *address, int playerCount, int seatCount, Vector2 mapBounds);
+int joinServerMatch(MatchClient *client, int playerCount, int seatCount, Vector2 mapBounds);
+int updateMatchClient(MatchClient *client);
+int isClientShip(const MatchClient *client, int ship);
+void submitOrders(MatchClient *client, const Match *match);
+int applyServerOrders(MatchClient *client, Match *match);
+int applyServerState(MatchClient *client, Match *match, const TerrainGrid *terrain);
+void closeMatchClient(MatchClient *client);
+#endif //MATCHCLIENT_H
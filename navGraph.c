@@ -0,0 +1,394 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "navGraph.h"
+
+//Checks if a ship can sail in a straight line between two points keeping the provided distance from the terrain.
+//Steps as far as the distance field guarantees is clear, so the raw segments are never read. Returns 1 if it can and 0 if not
+static int isLegClear(const TerrainGrid *terrain, Vector2 from, Vector2 to, float clearance) {
+    float length = Vector2Distance(from, to);
+    Vector2 dir = length > 0 ? Vector2Scale(Vector2Subtract(to, from), 1/length) : Vector2Zero();
+    for (float travelled = 0;;) {
+        float margin = getTerrainDistance(terrain, Vector2Add(from, Vector2Scale(dir, travelled))) - clearance;
+        if (margin < 0) return 0;
+        if (travelled >= length) return 1;
+        travelled = fminf(length, travelled + fmaxf(margin, NAV_STEP));
+    }
+}
+
+//Returns the direction the distance to the terrain grows fastest in at the provided point, or zero if it is flat there
+static Vector2 getTerrainGradient(const TerrainGrid *terrain, Vector2 point) {
+    const float h = TERRAIN_DISTANCE_CELL_SIZE/2;
+    Vector2 gradient = {getTerrainDistance(terrain, (Vector2){point.x + h, point.y}) - getTerrainDistance(terrain, (Vector2){point.x - h, point.y}),
+                        getTerrainDistance(terrain, (Vector2){point.x, point.y + h}) - getTerrainDistance(terrain, (Vector2){point.x, point.y - h})};
+    return Vector2Normalize(gradient);
+}
+
+//Returns the bucket column and row of the provided point, clamped to the buckets
+static void getBucket(const NavGraph *graph, Vector2 point, int *column, int *row) {
+    *column = (int)floorf((point.x - graph->origin.x)/NAV_EDGE_RANGE);
+    *row = (int)floorf((point.y - graph->origin.y)/NAV_EDGE_RANGE);
+    *column = *column < 0 ? 0 : *column >= graph->columns ? graph->columns - 1 : *column;
+    *row = *row < 0 ? 0 : *row >= graph->rows ? graph->rows - 1 : *row;
+}
+
+//Moves a terrain corner out to sea along the distance field until it is far enough from every island to be a node.
+//Returns 1 if it found a spot that is clear and on the open sea, or past the edge of the map, and 0 if not
+static int placeNode(const TerrainGrid *terrain, Vector2 corner, Vector2 *node) {
+    const float target = NAV_CLEARANCE + NAV_NODE_OFFSET;
+    Vector2 point = corner;
+    for (int i = 0; i < 4; i++) {
+        float distance = getTerrainDistance(terrain, point);
+        if (distance >= target - 1) break;
+        Vector2 gradient = getTerrainGradient(terrain, point);
+        if (gradient.x == 0 && gradient.y == 0) return 0;
+        point = Vector2Add(point, Vector2Scale(gradient, target - distance));
+    }
+    Vector2 end = Vector2Add(terrain->origin, (Vector2){terrain->columns*terrain->cellSize, terrain->rows*terrain->cellSize});
+    int isPastEdge = point.x < terrain->origin.x || point.y < terrain->origin.y || point.x > end.x || point.y > end.y;
+    *node = point;
+    return getTerrainDistance(terrain, point) >= NAV_CLEARANCE && (isPastEdge || isWater(terrain, point));
+}
+
+//Builds the graph from the distance field of the terrain. Nodes are placed off the ends of every terrain segment and thinned out
+//to one per NAV_NODE_SPACING square, then every pair of nodes closer than NAV_EDGE_RANGE that can see each other is joined.
+//Returns 1 if successful and 0 if it ran out of memory
+int buildNavGraph(NavGraph *graph, const TerrainGrid *terrain) {
+    *graph = (NavGraph){0};
+    graph->terrain = terrain;
+    const float margin = NAV_CLEARANCE + NAV_NODE_OFFSET + NAV_NODE_SPACING; //Nodes can lie this far past the edge of the grid
+    Vector2 size = {terrain->columns*terrain->cellSize + 2*margin, terrain->rows*terrain->cellSize + 2*margin};
+    graph->origin = Vector2Subtract(terrain->origin, (Vector2){margin, margin});
+    graph->columns = (int)ceilf(size.x/NAV_EDGE_RANGE);
+    graph->rows = (int)ceilf(size.y/NAV_EDGE_RANGE);
+    int squareColumns = (int)ceilf(size.x/NAV_NODE_SPACING), squareRows = (int)ceilf(size.y/NAV_NODE_SPACING);
+    unsigned char *isTaken = calloc((size_t)squareColumns*squareRows, 1); //Squares that already hold a node
+    graph->nodes = malloc((2*terrain->segmentCount + 1)*sizeof(Vector2));
+    graph->bucketStart = calloc(graph->columns*graph->rows + 1, sizeof(int));
+    if (isTaken == NULL || graph->nodes == NULL || graph->bucketStart == NULL) {
+        free(isTaken);
+        freeNavGraph(graph);
+        return 0;
+    }
+    //Nodes
+    for (int i = 0; i < 2*terrain->segmentCount; i++) {
+        Line line = terrain->segments[i/2];
+        Vector2 node;
+        if (!placeNode(terrain, i % 2 == 0 ? line.start : line.end, &node)) continue;
+        int column = (int)floorf((node.x - graph->origin.x)/NAV_NODE_SPACING), row = (int)floorf((node.y - graph->origin.y)/NAV_NODE_SPACING);
+        if (column < 0 || row < 0 || column >= squareColumns || row >= squareRows || isTaken[row*squareColumns + column]) continue;
+        isTaken[row*squareColumns + column] = 1;
+        graph->nodes[graph->nodeCount++] = node;
+    }
+    free(isTaken);
+    //Sort the nodes into buckets, counting first and then filling with bucketStart as a cursor
+    graph->bucketNodes = malloc((graph->nodeCount + 1)*sizeof(int));
+    if (graph->bucketNodes == NULL) {
+        freeNavGraph(graph);
+        return 0;
+    }
+    int bucketCount = graph->columns*graph->rows;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < graph->nodeCount; i++) {
+            int column, row;
+            getBucket(graph, graph->nodes[i], &column, &row);
+            if (pass == 0) graph->bucketStart[row*graph->columns + column + 1]++;
+            else graph->bucketNodes[graph->bucketStart[row*graph->columns + column]++] = i;
+        }
+        for (int bucket = 0; pass == 0 && bucket < bucketCount; bucket++) {
+            graph->bucketStart[bucket + 1] += graph->bucketStart[bucket];
+        }
+    }
+    for (int bucket = bucketCount; bucket > 0; bucket--) {
+        graph->bucketStart[bucket] = graph->bucketStart[bucket - 1];
+    }
+    graph->bucketStart[0] = 0;
+
+    //Edges, every pair is checked once and stored in both directions
+    int pairCount = 0, pairCapacity = 0;
+    int (*pairs)[2] = NULL;
+    for (int i = 0; i < graph->nodeCount; i++) {
+        int column, row;
+        getBucket(graph, graph->nodes[i], &column, &row);
+        for (int y = row - 1; y <= row + 1; y++) {
+            for (int x = column - 1; x <= column + 1; x++) {
+                if (x < 0 || y < 0 || x >= graph->columns || y >= graph->rows) continue;
+                int bucket = y*graph->columns + x;
+                for (int k = graph->bucketStart[bucket]; k < graph->bucketStart[bucket + 1]; k++) {
+                    int j = graph->bucketNodes[k];
+                    if (j <= i || Vector2Distance(graph->nodes[i], graph->nodes[j]) > NAV_EDGE_RANGE) continue;
+                    if (!isLegClear(terrain, graph->nodes[i], graph->nodes[j], NAV_CLEARANCE)) continue;
+                    if (pairCount == pairCapacity) {
+                        pairCapacity = pairCapacity > 0 ? pairCapacity*2 : 1024;
+                        void *grown = realloc(pairs, pairCapacity*sizeof(*pairs));
+                        if (grown == NULL) {
+                            free(pairs);
+                            freeNavGraph(graph);
+                            return 0;
+                        }
+                        pairs = grown;
+                    }
+                    pairs[pairCount][0] = i;
+                    pairs[pairCount++][1] = j;
+                }
+            }
+        }
+    }
+    graph->edgeCount = 2*pairCount;
+    graph->edgeStart = calloc(graph->nodeCount + 1, sizeof(int));
+    graph->edges = malloc((graph->edgeCount + 1)*sizeof(int));
+    graph->edgeLengths = malloc((graph->edgeCount + 1)*sizeof(float));
+    if (graph->edgeStart == NULL || graph->edges == NULL || graph->edgeLengths == NULL) {
+        free(pairs);
+        freeNavGraph(graph);
+        return 0;
+    }
+    for (int i = 0; i < pairCount; i++) {
+        graph->edgeStart[pairs[i][0] + 1]++;
+        graph->edgeStart[pairs[i][1] + 1]++;
+    }
+    for (int i = 0; i < graph->nodeCount; i++) {
+        graph->edgeStart[i + 1] += graph->edgeStart[i];
+    }
+    for (int i = 0; i < pairCount; i++) {
+        for (int side = 0; side < 2; side++) {
+            int from = pairs[i][side], to = pairs[i][1 - side];
+            int edge = graph->edgeStart[from]++; //Used as a cursor, shifted back below
+            graph->edges[edge] = to;
+            graph->edgeLengths[edge] = Vector2Distance(graph->nodes[from], graph->nodes[to]);
+        }
+    }
+    for (int i = graph->nodeCount; i > 0; i--) {
+        graph->edgeStart[i] = graph->edgeStart[i - 1];
+    }
+    graph->edgeStart[0] = 0;
+    free(pairs);
+    return 1;
+}
+
+//Frees the memory used by the graph
+void freeNavGraph(NavGraph *graph) {
+    free(graph->nodes);
+    free(graph->edgeStart);
+    free(graph->edges);
+    free(graph->edgeLengths);
+    free(graph->bucketStart);
+    free(graph->bucketNodes);
+    *graph = (NavGraph){0};
+}
+
+//Allocates the scratch memory of a route planner for the provided graph. Returns 1 if successful and 0 if it ran out of memory
+int createPathFinder(PathFinder *finder, const NavGraph *graph) {
+    *finder = (PathFinder){0};
+    finder->graph = graph;
+    int count = graph->nodeCount + 1; //The goal takes the last entry
+    finder->cost = malloc(count*sizeof(float));
+    finder->parent = malloc(count*sizeof(int));
+    finder->reached = calloc(count, sizeof(unsigned int));
+    finder->closed = calloc(count, sizeof(unsigned int));
+    finder->goalLegs = malloc(count*sizeof(float));
+    finder->goalNodes = malloc(count*sizeof(int));
+    finder->open = malloc((graph->edgeCount + 2*graph->nodeCount + 1)*sizeof(OpenNode)); //Every node and edge pushes at most once
+    if (finder->cost == NULL || finder->parent == NULL || finder->reached == NULL || finder->closed == NULL
+        || finder->goalLegs == NULL || finder->goalNodes == NULL || finder->open == NULL) {
+        freePathFinder(finder);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        finder->goalLegs[i] = -1;
+    }
+    clearPathCache(finder);
+    return 1;
+}
+
+//Frees the memory of the route planner
+void freePathFinder(PathFinder *finder) {
+    free(finder->cost);
+    free(finder->parent);
+    free(finder->reached);
+    free(finder->closed);
+    free(finder->goalLegs);
+    free(finder->goalNodes);
+    free(finder->open);
+    *finder = (PathFinder){0};
+}
+
+//Empties the route cache. Done at the start of every match, so the routes a match gets never depend on the matches played before it
+void clearPathCache(PathFinder *finder) {
+    for (int i = 0; i < PATH_CACHE_SIZE; i++) {
+        finder->cache[i].startCell = -1;
+    }
+}
+
+//Adds a node to the open heap
+static void pushOpen(PathFinder *finder, int *openCount, int node, float estimate) {
+    int i = (*openCount)++;
+    while (i > 0 && finder->open[(i - 1)/2].estimate > estimate) { //Move parents down until the new node fits
+        finder->open[i] = finder->open[(i - 1)/2];
+        i = (i - 1)/2;
+    }
+    finder->open[i] = (OpenNode){estimate, node};
+}
+
+//Removes the node with the lowest estimate from the open heap and returns it
+static int popOpen(PathFinder *finder, int *openCount) {
+    int node = finder->open[0].node;
+    OpenNode last = finder->open[--(*openCount)];
+    int i = 0;
+    for (;;) { //Move children up until the last node fits
+        int child = 2*i + 1;
+        if (child >= *openCount) break;
+        if (child + 1 < *openCount && finder->open[child + 1].estimate < finder->open[child].estimate) child++;
+        if (finder->open[child].estimate >= last.estimate) break;
+        finder->open[i] = finder->open[child];
+        i = child;
+    }
+    if (*openCount > 0) finder->open[i] = last;
+    return node;
+}
+
+//Sets the cost of reaching a node if it is lower than the one known, and queues the node
+static void relaxNode(PathFinder *finder, int *openCount, int node, int parent, float cost, Vector2 goal) {
+    if (finder->reached[node] == finder->search && cost >= finder->cost[node]) return;
+    finder->reached[node] = finder->search;
+    finder->cost[node] = cost;
+    finder->parent[node] = parent;
+    Vector2 position = node < finder->graph->nodeCount ? finder->graph->nodes[node] : goal;
+    pushOpen(finder, openCount, node, cost + Vector2Distance(position, goal));
+}
+
+//Runs A* from the start to the goal over the graph. The start and the goal are joined to the nodes around them they can see.
+//Writes the nodes of the shortest route to nodes and returns how many there are, or -1 if there is no route or it is longer than MAX_PATH_NODES
+static int searchPath(PathFinder *finder, Vector2 start, Vector2 goal, float startClearance, float goalClearance, int *nodes) {
+    const NavGraph *graph = finder->graph;
+    const int goalNode = graph->nodeCount;
+    if (++finder->search == 0) { //The search counter wrapped around, so old marks could match it again
+        for (int i = 0; i <= graph->nodeCount; i++) {
+            finder->reached[i] = finder->closed[i] = 0;
+        }
+        finder->search = 1;
+    }
+    int openCount = 0, goalNodeCount = 0;
+    for (int side = 0; side < 2; side++) { //Nodes the goal can see, then nodes the start can see
+        Vector2 point = side == 0 ? goal : start;
+        int column, row;
+        getBucket(graph, point, &column, &row);
+        for (int y = row - 1; y <= row + 1; y++) {
+            for (int x = column - 1; x <= column + 1; x++) {
+                if (x < 0 || y < 0 || x >= graph->columns || y >= graph->rows) continue;
+                int bucket = y*graph->columns + x;
+                for (int k = graph->bucketStart[bucket]; k < graph->bucketStart[bucket + 1]; k++) {
+                    int node = graph->bucketNodes[k];
+                    float distance = Vector2Distance(point, graph->nodes[node]);
+                    if (distance > NAV_EDGE_RANGE || !isLegClear(graph->terrain, point, graph->nodes[node], side == 0 ? goalClearance : startClearance)) continue;
+                    if (side == 1) relaxNode(finder, &openCount, node, -1, distance, goal);
+                    else {
+                        finder->goalLegs[node] = distance;
+                        finder->goalNodes[goalNodeCount++] = node;
+                    }
+                }
+            }
+        }
+    }
+    int found = 0;
+    while (openCount > 0) {
+        int node = popOpen(finder, &openCount);
+        if (node == goalNode) {
+            found = 1;
+            break;
+        }
+        if (finder->closed[node] == finder->search) continue; //Already expanded through a shorter route
+        finder->closed[node] = finder->search;
+        if (finder->goalLegs[node] >= 0) relaxNode(finder, &openCount, goalNode, node, finder->cost[node] + finder->goalLegs[node], goal);
+        for (int edge = graph->edgeStart[node]; edge < graph->edgeStart[node + 1]; edge++) {
+            int next = graph->edges[edge];
+            if (finder->closed[next] != finder->search) relaxNode(finder, &openCount, next, node, finder->cost[node] + graph->edgeLengths[edge], goal);
+        }
+    }
+    for (int i = 0; i < goalNodeCount; i++) {
+        finder->goalLegs[finder->goalNodes[i]] = -1;
+    }
+    if (!found) return -1;
+    //Walk back from the goal, then put the nodes in order
+    int count = 0;
+    for (int node = finder->parent[goalNode]; node >= 0; node = finder->parent[node]) {
+        if (count == MAX_PATH_NODES) return -1;
+        nodes[count++] = node;
+    }
+    for (int i = 0; i < count/2; i++) {
+        int swap = nodes[i];
+        nodes[i] = nodes[count - 1 - i];
+        nodes[count - 1 - i] = swap;
+    }
+    return count;
+}
+
+//Returns the route cache cell holding the provided point, clamped to the area of the graph
+static int getCacheCell(const NavGraph *graph, Vector2 point) {
+    int columns = (int)(graph->columns*NAV_EDGE_RANGE/PATH_CACHE_CELL_SIZE), rows = (int)(graph->rows*NAV_EDGE_RANGE/PATH_CACHE_CELL_SIZE);
+    int column = (int)floorf((point.x - graph->origin.x)/PATH_CACHE_CELL_SIZE);
+    int row = (int)floorf((point.y - graph->origin.y)/PATH_CACHE_CELL_SIZE);
+    column = column < 0 ? 0 : column >= columns ? columns - 1 : column;
+    row = row < 0 ? 0 : row >= rows ? rows - 1 : row;
+    return row*columns + column;
+}
+
+//Finds a route a ship can sail from the start to the goal around the islands. Writes up to capacity waypoints to follow after the start,
+//the last one being the goal, and returns how many were written, or 0 if there is no route. Routes between the same pair of cache cells
+//reuse the nodes of the last one found as long as the start and the goal can still see the ends of it
+int findPath(PathFinder *finder, Vector2 start, Vector2 goal, Vector2 *waypoints, int capacity) {
+    const NavGraph *graph = finder->graph;
+    if (capacity < 1) return 0;
+    //Ships already closer to the coast than NAV_CLEARANCE only have to keep the distance they have
+    float startClearance = Clamp(getTerrainDistance(graph->terrain, start), 0, NAV_CLEARANCE);
+    float goalClearance = Clamp(getTerrainDistance(graph->terrain, goal), 0, NAV_CLEARANCE);
+    if (isLegClear(graph->terrain, start, goal, fminf(startClearance, goalClearance))) { //Nothing in the way
+        waypoints[0] = goal;
+        return 1;
+    }
+    int startCell = getCacheCell(graph, start), goalCell = getCacheCell(graph, goal);
+    CachedPath *cached = &finder->cache[((unsigned int)startCell*2654435761u ^ (unsigned int)goalCell) % PATH_CACHE_SIZE];
+    if (cached->startCell == startCell && cached->goalCell == goalCell
+        && isLegClear(graph->terrain, start, graph->nodes[cached->nodes[0]], startClearance)
+        && isLegClear(graph->terrain, graph->nodes[cached->nodes[cached->nodeCount - 1]], goal, goalClearance)) finder->cacheHits++;
+    else {
+        finder->cacheMisses++;
+        int nodes[MAX_PATH_NODES];
+        int nodeCount = searchPath(finder, start, goal, startClearance, goalClearance, nodes);
+        if (nodeCount <= 0) return 0;
+        cached->startCell = startCell;
+        cached->goalCell = goalCell;
+        cached->nodeCount = nodeCount;
+        for (int i = 0; i < nodeCount; i++) {
+            cached->nodes[i] = nodes[i];
+        }
+    }
+    int count = 0;
+    for (int i = 0; i < cached->nodeCount && count < capacity; i++) {
+        waypoints[count++] = graph->nodes[cached->nodes[i]];
+    }
+    if (count < capacity) waypoints[count++] = goal;
+    return count;
+}
@@ -0,0 +1,84 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Navigation graph around the islands of a map and a cached A* route planner on top of it
+#ifndef NAVGRAPH_H
+#define NAVGRAPH_H
+#include "terrainGrid.h"
+#define NAV_CLEARANCE (SHIP_HALF_WIDTH + TERRAIN_DISTANCE_ERROR) //Distance routes keep from the terrain
+#define NAV_NODE_OFFSET 8.0f //Extra distance between the nodes and the inflated outlines, so routes between neighbouring nodes stay clear
+#define NAV_NODE_SPACING 24.0f //Width and height of the squares that hold at most one node each
+#define NAV_EDGE_RANGE 384.0f //Longest edge of the graph, also the size of the buckets nodes are looked up in
+#define NAV_STEP 4.0f //Shortest step taken when checking a leg close to the terrain
+#define PATH_CACHE_CELL_SIZE 32.0f //Routes starting and ending in the same pair of cells share a cache entry
+#define PATH_CACHE_SIZE 256 //Entries of the route cache
+#define MAX_PATH_NODES 32 //Longest route kept in the cache, in nodes
+
+typedef struct NavGraphStruct {
+    const TerrainGrid *terrain; //Map the graph was built for, its distance field is used for every visibility check
+    Vector2 *nodes; //Points off the corners of the islands, NAV_CLEARANCE plus NAV_NODE_OFFSET away from the terrain
+    int nodeCount;
+    int *edgeStart; //Index of the first edge of every node in edges. Has nodeCount+1 entries
+    int *edges; //Nodes every node can see in a straight line, stored node after node
+    float *edgeLengths;
+    int edgeCount;
+    Vector2 origin; //Top left corner of the first bucket
+    int columns; //Buckets of NAV_EDGE_RANGE, used to find the nodes close to a point
+    int rows;
+    int *bucketStart; //Index of the first node of every bucket in bucketNodes. Has columns*rows+1 entries
+    int *bucketNodes;
+} NavGraph;
+
+typedef struct CachedPathStruct {
+    int startCell; //Cache cell of the start of the route, -1 for an empty entry
+    int goalCell;
+    int nodeCount;
+    int nodes[MAX_PATH_NODES]; //Graph nodes the route goes through
+} CachedPath;
+
+typedef struct OpenNodeStruct {
+    float estimate; //Cost so far plus the straight distance left
+    int node;
+} OpenNode;
+
+typedef struct PathFinderStruct {
+    const NavGraph *graph;
+    float *cost; //Length of the shortest known route to every node, and to the goal in the last entry
+    int *parent; //Node every node is reached from, nodeCount for the start
+    unsigned int *reached; //Search that last set the cost of every node
+    unsigned int *closed; //Search that last expanded every node
+    float *goalLegs; //Distance from every node to the goal, or -1 if the node can't see it
+    int *goalNodes; //Nodes whose goalLegs were set by the current search, reset once it ends
+    OpenNode *open; //Binary heap of the nodes waiting to be expanded
+    unsigned int search; //Number of the current search, so nothing has to be cleared between searches
+    CachedPath cache[PATH_CACHE_SIZE];
+    int cacheHits;
+    int cacheMisses;
+} PathFinder; //Scratch memory and route cache of one thread
+
+int buildNavGraph(NavGraph *graph, const TerrainGrid *terrain);
+void freeNavGraph(NavGraph *graph);
+int createPathFinder(PathFinder *finder, const NavGraph *graph);
+void freePathFinder(PathFinder *finder);
+void clearPathCache(PathFinder *finder);
+int findPath(PathFinder *finder, Vector2 start, Vector2 goal, Vector2 *waypoints, int capacity);
+#endif //NAVGRAPH_H
@@ -0,0 +1,269 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "network.h"
+#define MAX_UNSENT_SIZE (16 << 20) //A client that lets more than this pile up isn't reading and is dropped
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 //Not needed where sockets don't raise SIGPIPE
+#endif
+
+#ifndef _WIN32
+static int setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+//Splits HOST:PORT and looks the host up. An empty host means every address when listening and the local machine when connecting
+static struct addrinfo *resolveAddress(const char *address, int isListening) {
+    char host[256] = "";
+    const char *port = strrchr(address, ':');
+    if (port == NULL) port = address; //Only a port
+    else {
+        size_t length = port - address;
+        if (length >= sizeof(host)) return NULL;
+        memcpy(host, address, length);
+        host[length] = 0;
+        port++;
+    }
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = isListening ? AI_PASSIVE : 0;
+    struct addrinfo *addresses;
+    int error = getaddrinfo(host[0] != 0 ? host : isListening ? NULL : "localhost", port, &hints, &addresses);
+    if (error != 0) {
+        printf("Can't resolve %s: %s\n", address, gai_strerror(error));
+        return NULL;
+    }
+    return addresses;
+}
+
+//Opens a listening or connected socket, "unix:PATH" for a Unix socket and HOST:PORT for TCP. Returns -1 if it couldn't be opened
+static int openSocket(const char *address, int isListening) {
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un unixAddress = {0};
+        unixAddress.sun_family = AF_UNIX;
+        if (strlen(address + 5) >= sizeof(unixAddress.sun_path)) {
+            printf("Socket path %s is too long\n", address + 5);
+            return -1;
+        }
+        strcpy(unixAddress.sun_path, address + 5);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            perror("Error opening socket");
+            return -1;
+        }
+        if (isListening) unlink(unixAddress.sun_path); //Left behind by a server that didn't exit cleanly
+        int isOpen = isListening ? bind(fd, (struct sockaddr *)&unixAddress, sizeof(unixAddress)) == 0 && listen(fd, SOMAXCONN) == 0
+                                 : connect(fd, (struct sockaddr *)&unixAddress, sizeof(unixAddress)) == 0;
+        if (!isOpen) {
+            perror(isListening ? "Error listening on socket" : "Error connecting to socket");
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    struct addrinfo *addresses = resolveAddress(address, isListening);
+    int fd = -1;
+    for (struct addrinfo *i = addresses; i != NULL && fd < 0; i = i->ai_next) { //Try every address the host has
+        fd = socket(i->ai_family, i->ai_socktype, i->ai_protocol);
+        if (fd < 0) continue;
+        int one = 1;
+        if (isListening) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        int isOpen = isListening ? bind(fd, i->ai_addr, i->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0 : connect(fd, i->ai_addr, i->ai_addrlen) == 0;
+        if (!isOpen) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (addresses != NULL) freeaddrinfo(addresses);
+    if (fd < 0) printf(isListening ? "Can't listen on %s\n" : "Can't connect to %s\n", address);
+    return fd;
+}
+#endif
+
+//Starts listening for connections. Returns the non-blocking listening socket, or -1 if it couldn't be opened
+int listenOnAddress(const char *address) {
+#ifdef _WIN32
+    printf("Can't listen on %s, networking isn't supported on Windows\n", address);
+    return -1;
+#else
+    int fd = openSocket(address, 1);
+    if (fd >= 0 && !setNonBlocking(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+#endif
+}
+
+//Connects to a server, waiting until the connection is made. Returns the non-blocking socket, or -1 if it couldn't connect
+int connectToAddress(const char *address) {
+#ifdef _WIN32
+    printf("Can't connect to %s, networking isn't supported on Windows\n", address);
+    return -1;
+#else
+    int fd = openSocket(address, 0);
+    int one = 1;
+    if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); //Orders are tiny and shouldn't wait to be merged, fails harmlessly on Unix sockets
+    if (fd >= 0 && !setNonBlocking(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+#endif
+}
+
+//Accepts a waiting connection. Returns its non-blocking socket, or -1 if there are no more
+int acceptConnection(int listener) {
+#ifdef _WIN32
+    return -1;
+#else
+    int fd;
+    do fd = accept(listener, NULL, NULL);
+    while (fd < 0 && errno == EINTR);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (!setNonBlocking(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+#endif
+}
+
+void openConnection(NetConnection *connection, int socket) {
+    *connection = (NetConnection){0};
+    connection->socket = socket;
+}
+
+//Reads everything the socket has received. Messages taken before are dropped, so the readers of earlier messages must not be used
+//after this. Returns 0 if the connection has failed
+int receiveMessages(NetConnection *connection) {
+    ByteBuffer *input = &connection->input;
+    if (connection->inputStart > 0) { //Move the messages that haven't been taken to the start
+        memmove(input->data, input->data + connection->inputStart, input->size - connection->inputStart);
+        input->size -= connection->inputStart;
+        connection->inputStart = 0;
+    }
+#ifdef _WIN32
+    connection->failed = 1;
+#else
+    unsigned char chunk[RECEIVE_CHUNK];
+    while (!connection->failed) {
+        ssize_t received = recv(connection->socket, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            putBytes(input, chunk, received);
+            connection->failed = input->failed;
+        }
+        else if (received < 0 && errno == EINTR) continue;
+        else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break; //Everything has been read
+        else connection->failed = 1; //Closed by the other side
+    }
+#endif
+    return !connection->failed;
+}
+
+//Sends as much of the queued messages as the socket takes without waiting. Returns 0 if the connection has failed
+int sendMessages(NetConnection *connection) {
+    ByteBuffer *output = &connection->output;
+#ifdef _WIN32
+    connection->failed = 1;
+#else
+    while (!connection->failed && connection->sent < output->size) {
+        ssize_t sent = send(connection->socket, output->data + connection->sent, output->size - connection->sent, MSG_NOSIGNAL);
+        if (sent > 0) connection->sent += sent;
+        else if (sent < 0 && errno == EINTR) continue;
+        else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break; //The socket buffer is full
+        else connection->failed = 1;
+    }
+#endif
+    if (connection->sent > 0) { //Move the bytes that haven't been sent to the start, so the buffer only ever holds unsent ones
+        memmove(output->data, output->data + connection->sent, output->size - connection->sent);
+        output->size -= connection->sent;
+        connection->sent = 0;
+    }
+    if (output->failed || output->size - connection->sent > MAX_UNSENT_SIZE) connection->failed = 1;
+    return !connection->failed;
+}
+
+int hasUnsentMessages(const NetConnection *connection) {
+    return connection->sent < connection->output.size;
+}
+
+//Takes the next whole message that has been received. Returns 1 if there was one and 0 if not
+int takeMessage(NetConnection *connection, MessageType *type, ByteReader *message) {
+    size_t available = connection->input.size - connection->inputStart;
+    if (connection->failed || available < MESSAGE_HEADER_SIZE) return 0;
+    ByteReader header = createByteReader(connection->input.data + connection->inputStart, MESSAGE_HEADER_SIZE);
+    uint32_t size = getU32(&header);
+    *type = getU8(&header);
+    if (size > MAX_MESSAGE_SIZE) {
+        connection->failed = 1;
+        return 0;
+    }
+    if (available - MESSAGE_HEADER_SIZE < size) return 0; //Not all of it has arrived yet
+    *message = createByteReader(connection->input.data + connection->inputStart + MESSAGE_HEADER_SIZE, size);
+    connection->inputStart += MESSAGE_HEADER_SIZE + size;
+    return 1;
+}
+
+//Starts a message in the buffer. Returns where it starts, which endMessage needs once the contents have been written
+size_t beginMessage(ByteBuffer *buffer, MessageType type) {
+    size_t start = buffer->size;
+    putU32(buffer, 0);
+    putU8(buffer, type);
+    return start;
+}
+
+//Fills in the size of the message started at start
+void endMessage(ByteBuffer *buffer, size_t start) {
+    if (buffer->failed) return;
+    uint32_t size = buffer->size - start - MESSAGE_HEADER_SIZE;
+    for (int i = 0; i < 4; i++) {
+        buffer->data[start + i] = size >> 8*i;
+    }
+}
+
+void closeConnection(NetConnection *connection) {
+#ifndef _WIN32
+    if (connection->socket >= 0) close(connection->socket);
+#endif
+    freeByteBuffer(&connection->input);
+    freeByteBuffer(&connection->output);
+    *connection = (NetConnection){0};
+    connection->socket = -1;
+}
@@ -0,0 +1,61 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Non-blocking TCP and Unix socket connections that exchange length prefixed messages, used by the match server and its clients.
+//Every message is a 32 bit size, a type byte and the contents encoded with a ByteBuffer
+#ifndef NETWORK_H
+#define NETWORK_H
+#include <stddef.h>
+#include "byteBuffer.h"
+#define MESSAGE_HEADER_SIZE 5 //Size of the contents and type
+#define MAX_MESSAGE_SIZE (1 << 20) //Longer messages close the connection
+#define RECEIVE_CHUNK 65536 //Bytes read from a socket at a time
+
+typedef enum MessageType {
+    MESSAGE_JOIN = 1, //Client asks for seats in a match: player count, seat count and map bounds
+    MESSAGE_JOINED, //Server hands out the seats: match id, first seat, seat count, player count and map bounds
+    MESSAGE_ORDER, //Client gives the order of one of its ships for the current phase
+    MESSAGE_ORDERS, //Server sends the orders of every ship once a phase has every order, so clients can play it out
+    MESSAGE_STATE //Server sends the whole match state, encoded as a save, at the start and after every resolved phase
+} MessageType;
+
+typedef struct NetConnectionStruct {
+    int socket; //-1 once closed
+    ByteBuffer input; //Received bytes, the messages before inputStart have been taken already
+    size_t inputStart;
+    ByteBuffer output; //Bytes waiting to be sent, the ones before sent have been sent already
+    size_t sent;
+    int failed; //Set once the other side has closed the connection, it sent a message that is too long or a buffer couldn't grow
+} NetConnection;
+
+int listenOnAddress(const char *address);
+int connectToAddress(const char *address);
+int acceptConnection(int listener);
+void openConnection(NetConnection *connection, int socket);
+int receiveMessages(NetConnection *connection);
+int sendMessages(NetConnection *connection);
+int hasUnsentMessages(const NetConnection *connection);
+int takeMessage(NetConnection *connection, MessageType *type, ByteReader *message);
+size_t beginMessage(ByteBuffer *buffer, MessageType type);
+void endMessage(ByteBuffer *buffer, size_t start);
+void closeConnection(NetConnection *connection);
+#endif //NETWORK_H
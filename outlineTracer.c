@@ -0,0 +1,299 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "outlineTracer.h"
+
+//Outlines are traced with marching squares on a grid with a sample at the center of every pixel and a ring of transparent samples
+//around the image, so every outline is closed. A cell is the square between four samples, and an outline crosses the edges of a
+//cell where one end of the edge is opaque and the other isn't
+
+typedef struct TraceGridStruct {
+    const unsigned char *pixels;
+    int width; //Of the image
+    int height;
+    int columns; //Samples, one more on every side than the image has pixels
+    int rows;
+    float threshold; //Halfway between the last transparent and the first opaque alpha
+} TraceGrid;
+
+//Returns the alpha of a sample, 0 outside the image
+static float getSample(const TraceGrid *grid, int column, int row) {
+    int x = column - 1, y = row - 1;
+    if (x < 0 || y < 0 || x >= grid->width || y >= grid->height) return 0;
+    return grid->pixels[((size_t)y*grid->width + x)*4 + 3];
+}
+
+//Edges between a sample and the one to its right come first, then the edges between a sample and the one below it
+static int horizontalEdge(const TraceGrid *grid, int column, int row) {
+    return row*(grid->columns - 1) + column;
+}
+
+static int verticalEdge(const TraceGrid *grid, int column, int row) {
+    return grid->rows*(grid->columns - 1) + row*grid->columns + column;
+}
+
+//Returns where the outline crosses an edge, in image pixels. Always interpolated from the top or left sample so both cells of the edge agree
+static Vector2 getCrossing(const TraceGrid *grid, int column, int row, int isHorizontal) {
+    int endColumn = column + isHorizontal, endRow = row + !isHorizontal;
+    float start = getSample(grid, column, row), end = getSample(grid, endColumn, endRow);
+    float t = (grid->threshold - start)/(end - start); //The ends are on either side of the threshold so this is between 0 and 1
+    return (Vector2){column - 0.5f + t*isHorizontal, row - 0.5f + t*!isHorizontal};
+}
+
+//Traces the outlines of every area of the image whose alpha is at least the threshold. Holes get outlines of their own.
+//Returns 1 if successful and 0 if out of memory
+int traceOutlines(const unsigned char *pixels, int width, int height, int threshold, Outline **outlines, int *outlineCount) {
+    TraceGrid grid = {pixels, width, height, width + 2, height + 2, threshold - 0.5f};
+    size_t edgeCount = (size_t)grid.rows*(grid.columns - 1) + (size_t)(grid.rows - 1)*grid.columns;
+    int *next = malloc(edgeCount*sizeof(int)); //Edge the outline crosses after this one, -1 if it doesn't cross this one
+    Vector2 *crossings = malloc(edgeCount*sizeof(Vector2));
+    *outlines = NULL;
+    *outlineCount = 0;
+    if (next == NULL || crossings == NULL) {
+        free(next);
+        free(crossings);
+        return 0;
+    }
+    memset(next, 0xFF, edgeCount*sizeof(int));
+
+    //Link the crossings of every cell. Going clockwise around a cell, each crossing from an opaque corner to a transparent one
+    //leads to a crossing from a transparent corner to an opaque one, which keeps the opaque side of every outline on the same side
+    for (int row = 0; row < grid.rows - 1; row++) {
+        for (int column = 0; column < grid.columns - 1; column++) {
+            float corners[4] = {getSample(&grid, column, row), getSample(&grid, column + 1, row),
+                                getSample(&grid, column + 1, row + 1), getSample(&grid, column, row + 1)}; //Clockwise from the top left
+            int isOpaque[4], opaqueCount = 0;
+            for (int i = 0; i < 4; i++) {
+                isOpaque[i] = corners[i] >= grid.threshold;
+                opaqueCount += isOpaque[i];
+            }
+            if (opaqueCount == 0 || opaqueCount == 4) continue;
+            int edges[4] = {horizontalEdge(&grid, column, row), verticalEdge(&grid, column + 1, row),
+                            horizontalEdge(&grid, column, row + 1), verticalEdge(&grid, column, row)}; //Edge after each corner
+            //Two opposite opaque corners are joined through the middle of the cell if the average of the corners is opaque
+            int isSaddle = opaqueCount == 2 && isOpaque[0] == isOpaque[2];
+            int isJoined = (corners[0] + corners[1] + corners[2] + corners[3])/4 >= grid.threshold;
+            for (int i = 0; i < 4; i++) {
+                if (!isOpaque[i] || isOpaque[(i + 1)%4]) continue; //Not a crossing out of the opaque area
+                int entry; //Crossing back into the opaque area that this one leads to
+                if (isSaddle) entry = isJoined ? (i + 1)%4 : (i + 3)%4;
+                else for (entry = (i + 1)%4; !(!isOpaque[entry] && isOpaque[(entry + 1)%4]); entry = (entry + 1)%4);
+                next[edges[i]] = edges[entry];
+            }
+            if (isOpaque[0] != isOpaque[1]) crossings[edges[0]] = getCrossing(&grid, column, row, 1);
+            if (isOpaque[3] != isOpaque[0]) crossings[edges[3]] = getCrossing(&grid, column, row, 0);
+        }
+    }
+    //The bottom and right edges of a cell are the top and left edges of the next one, except along the ring of transparent samples
+    //which nothing crosses
+
+    //Follow every chain of crossings around to where it started
+    int capacity = 0, pointCapacity = 0;
+    Vector2 *points = NULL;
+    int failed = 0;
+    for (size_t start = 0; start < edgeCount && !failed; start++) {
+        if (next[start] < 0) continue;
+        int pointCount = 0;
+        for (int edge = start; next[edge] >= 0;) {
+            if (pointCount == pointCapacity) {
+                pointCapacity = pointCapacity > 0 ? pointCapacity*2 : 256;
+                Vector2 *grown = realloc(points, pointCapacity*sizeof(Vector2));
+                if (grown == NULL) {
+                    failed = 1;
+                    break;
+                }
+                points = grown;
+            }
+            points[pointCount++] = crossings[edge];
+            int following = next[edge];
+            next[edge] = -1; //Visited
+            edge = following;
+        }
+        if (failed) break;
+        if (*outlineCount == capacity) {
+            capacity = capacity > 0 ? capacity*2 : 16;
+            Outline *grown = realloc(*outlines, capacity*sizeof(Outline));
+            if (grown == NULL) {
+                failed = 1;
+                break;
+            }
+            *outlines = grown;
+        }
+        Outline *outline = &(*outlines)[(*outlineCount)++];
+        outline->pointCount = pointCount;
+        outline->points = malloc(pointCount*sizeof(Vector2));
+        if (outline->points == NULL) {
+            failed = 1;
+            break;
+        }
+        memcpy(outline->points, points, pointCount*sizeof(Vector2));
+    }
+    free(points);
+    free(next);
+    free(crossings);
+    if (failed) {
+        freeOutlines(*outlines, *outlineCount);
+        *outlines = NULL;
+        *outlineCount = 0;
+        return 0;
+    }
+    return 1;
+}
+
+//Returns the distance from a point to the segment between two others
+static float getSegmentDistance(Vector2 point, Vector2 start, Vector2 end) {
+    Vector2 direction = Vector2Subtract(end, start);
+    float lengthSquared = Vector2LengthSqr(direction);
+    float t = lengthSquared > 0 ? Vector2DotProduct(Vector2Subtract(point, start), direction)/lengthSquared : 0;
+    return Vector2Distance(point, Vector2Add(start, Vector2Scale(direction, Clamp(t, 0, 1))));
+}
+
+//Marks the points between first and last that have to be kept for the polyline to stay within the tolerance (Douglas-Peucker).
+//Ranges left to check are kept on a stack instead of recursing, since outlines can have many thousands of points
+static void markKeptPoints(const Vector2 *points, int first, int last, float tolerance, unsigned char *isKept, int *stack) {
+    int stackSize = 0;
+    stack[stackSize++] = first;
+    stack[stackSize++] = last;
+    while (stackSize > 0) {
+        last = stack[--stackSize];
+        first = stack[--stackSize];
+        int farthest = -1;
+        float farthestDistance = tolerance;
+        for (int i = first + 1; i < last; i++) {
+            float distance = getSegmentDistance(points[i], points[first], points[last]);
+            if (distance > farthestDistance) {
+                farthest = i;
+                farthestDistance = distance;
+            }
+        }
+        if (farthest < 0) continue; //Every point in between is close enough to the segment
+        isKept[farthest] = 1;
+        stack[stackSize++] = first;
+        stack[stackSize++] = farthest;
+        stack[stackSize++] = farthest;
+        stack[stackSize++] = last;
+    }
+}
+
+//Removes the points of an outline that it can do without while staying within the provided distance of the original.
+//Returns 1 if successful and 0 if out of memory
+int simplifyOutline(Outline *outline, float tolerance) {
+    int count = outline->pointCount;
+    if (count <= 3) return 1;
+    //The outline is closed, so it is split at its first point and the point farthest from it and both halves are simplified
+    int farthest = 0;
+    for (int i = 1; i < count; i++) {
+        if (Vector2DistanceSqr(outline->points[i], outline->points[0]) > Vector2DistanceSqr(outline->points[farthest], outline->points[0])) farthest = i;
+    }
+    Vector2 *points = malloc((count + 1)*sizeof(Vector2)); //The first point again at the end
+    unsigned char *isKept = calloc(count + 1, 1);
+    int *stack = malloc(2*(count + 1)*sizeof(int)); //Every range on the stack ends at a different kept point, so it never holds more than this
+    if (points == NULL || isKept == NULL || stack == NULL) {
+        free(points);
+        free(isKept);
+        free(stack);
+        return 0;
+    }
+    memcpy(points, outline->points, count*sizeof(Vector2));
+    points[count] = points[0];
+    isKept[0] = isKept[farthest] = 1;
+    markKeptPoints(points, 0, farthest, tolerance, isKept, stack);
+    markKeptPoints(points, farthest, count, tolerance, isKept, stack);
+    int keptCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (isKept[i]) outline->points[keptCount++] = points[i];
+    }
+    outline->pointCount = keptCount;
+    free(points);
+    free(isKept);
+    free(stack);
+    return 1;
+}
+
+//Returns the area enclosed by an outline, positive if it goes clockwise on screen
+float getOutlineArea(const Outline *outline) {
+    float area = 0;
+    for (int i = 0; i < outline->pointCount; i++) {
+        Vector2 a = outline->points[i], b = outline->points[(i + 1)%outline->pointCount];
+        area += a.x*b.y - b.x*a.y;
+    }
+    return area/2;
+}
+
+//Places an outline on the map and adds it to the builder as polylines that each cover a small area.
+//A polyline ends where the next one starts, and the last one ends where the first one started
+void addOutlineSections(MapBuilder *builder, const Outline *outline, const OutlinePlacement *placement) {
+    int count = outline->pointCount;
+    if (count < 2) return;
+    Vector2 *points = malloc((count + 1)*sizeof(Vector2)); //In map units, the first point again at the end
+    if (points == NULL) {
+        builder->failed = 1;
+        return;
+    }
+    for (int i = 0; i <= count; i++) {
+        points[i] = Vector2Add(placement->position, Vector2Scale(outline->points[i%count], placement->scale));
+    }
+    for (int first = 0; first < count;) {
+        Vector2 min = points[first], max = points[first];
+        int last = first + 1; //Every polyline has at least one segment, however long
+        min = Vector2Min(min, points[last]);
+        max = Vector2Max(max, points[last]);
+        while (last < count && last - first < placement->maxSectionSegments) {
+            Vector2 nextMin = Vector2Min(min, points[last + 1]), nextMax = Vector2Max(max, points[last + 1]);
+            if (nextMax.x - nextMin.x > placement->maxSectionSize || nextMax.y - nextMin.y > placement->maxSectionSize) break;
+            min = nextMin;
+            max = nextMax;
+            last++;
+        }
+        addMapPolyline(builder, points + first, last - first + 1);
+        first = last;
+    }
+    free(points);
+}
+
+//Traces an image, simplifies its outlines and adds them to the builder at the provided placement. Returns 1 if successful and 0 if out of memory
+int addImageOutlines(MapBuilder *builder, const unsigned char *pixels, int width, int height, int threshold, const OutlinePlacement *placement) {
+    Outline *outlines;
+    int outlineCount;
+    if (!traceOutlines(pixels, width, height, threshold, &outlines, &outlineCount)) return 0;
+    int simplified = 1;
+    for (int i = 0; i < outlineCount && simplified; i++) {
+        float area = fabsf(getOutlineArea(&outlines[i]))*placement->scale*placement->scale;
+        if (area < placement->minArea) continue; //Specks and pinholes
+        simplified = simplifyOutline(&outlines[i], placement->tolerance/placement->scale);
+        if (simplified) addOutlineSections(builder, &outlines[i], placement);
+    }
+    freeOutlines(outlines, outlineCount);
+    return simplified && !builder->failed;
+}
+
+//Frees every outline and the array holding them
+void freeOutlines(Outline *outlines, int outlineCount) {
+    for (int i = 0; i < outlineCount; i++) {
+        free(outlines[i].points);
+    }
+    free(outlines);
+}
@@ -0,0 +1,48 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Turns the opaque parts of an image into terrain polylines for the map compiler
+#ifndef OUTLINETRACER_H
+#define OUTLINETRACER_H
+#include "compiledMap.h"
+
+typedef struct OutlineStruct {
+    Vector2 *points; //Corners of a closed outline in image pixels, the last one connects back to the first
+    int pointCount;
+} Outline;
+
+typedef struct OutlinePlacementStruct {
+    Vector2 position; //Where the top left corner of the image goes on the map
+    float scale; //Map units per image pixel
+    float tolerance; //Largest distance in map units between a traced outline and its simplified polyline
+    float minArea; //Outlines enclosing less than this many square map units are dropped as noise
+    int maxSectionSegments; //Outlines are split into polylines of at most this many segments
+    float maxSectionSize; //and at most this wide and high, so every polyline covers a small part of the map
+} OutlinePlacement;
+
+int traceOutlines(const unsigned char *pixels, int width, int height, int threshold, Outline **outlines, int *outlineCount);
+int simplifyOutline(Outline *outline, float tolerance);
+float getOutlineArea(const Outline *outline);
+void addOutlineSections(MapBuilder *builder, const Outline *outline, const OutlinePlacement *placement);
+int addImageOutlines(MapBuilder *builder, const unsigned char *pixels, int width, int height, int threshold, const OutlinePlacement *placement);
+void freeOutlines(Outline *outlines, int outlineCount);
+#endif //OUTLINETRACER_H
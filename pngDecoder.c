@@ -0,0 +1,361 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pngDecoder.h"
+
+typedef struct InflaterStruct {
+    const unsigned char *input;
+    size_t inputSize;
+    size_t inputPosition;
+    uint32_t bitBuffer; //Bits read from the input but not used yet, lowest first
+    int bitCount;
+    unsigned char *output;
+    size_t outputSize;
+    size_t outputPosition;
+    int failed; //Set if the stream is damaged or longer than the output
+} Inflater;
+
+typedef struct HuffmanStruct {
+    short count[16]; //Number of codes of every length
+    short symbol[320]; //Symbols ordered by code
+} Huffman;
+
+//Reads the provided number of bits, lowest first
+static int getBits(Inflater *inflater, int count) {
+    uint32_t value = inflater->bitBuffer;
+    while (inflater->bitCount < count) {
+        if (inflater->inputPosition >= inflater->inputSize) {
+            inflater->failed = 1;
+            return 0;
+        }
+        value |= (uint32_t)inflater->input[inflater->inputPosition++] << inflater->bitCount;
+        inflater->bitCount += 8;
+    }
+    inflater->bitBuffer = count < 32 ? value >> count : 0;
+    inflater->bitCount -= count;
+    return value & ((1u << count) - 1);
+}
+
+//Builds a canonical Huffman code from the code length of every symbol. Returns 0 if the lengths don't describe a valid code
+static int buildHuffman(Huffman *huffman, const short *lengths, int symbolCount) {
+    short offsets[16];
+    memset(huffman->count, 0, sizeof(huffman->count));
+    for (int i = 0; i < symbolCount; i++) {
+        if (lengths[i] < 0 || lengths[i] > 15) return 0; //Deflate codes are at most 15 bits long
+        huffman->count[lengths[i]]++;
+    }
+    if (huffman->count[0] == symbolCount) return 1; //No codes, only valid if nothing uses it
+    int left = 1; //Codes left of the current length
+    for (int length = 1; length < 16; length++) {
+        left = left*2 - huffman->count[length];
+        if (left < 0) return 0; //More codes than fit
+    }
+    offsets[1] = 0;
+    for (int length = 1; length < 15; length++) {
+        offsets[length + 1] = offsets[length] + huffman->count[length];
+    }
+    for (int i = 0; i < symbolCount; i++) {
+        if (lengths[i] != 0) huffman->symbol[offsets[lengths[i]]++] = i;
+    }
+    return 1;
+}
+
+//Reads one symbol, a bit at a time since codes are stored highest bit first
+static int decodeSymbol(Inflater *inflater, const Huffman *huffman) {
+    int code = 0, first = 0, index = 0;
+    for (int length = 1; length < 16; length++) {
+        code |= getBits(inflater, 1);
+        int count = huffman->count[length];
+        if (code - first < count) return huffman->symbol[index + code - first];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    inflater->failed = 1;
+    return -1;
+}
+
+//Decodes the symbols of a compressed block until its end
+static void inflateBlock(Inflater *inflater, const Huffman *lengthCodes, const Huffman *distanceCodes) {
+    static const short lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const short lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const int distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const short distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    while (!inflater->failed) {
+        int symbol = decodeSymbol(inflater, lengthCodes);
+        if (symbol < 0 || symbol == 256) return; //End of block
+        if (symbol < 256) { //Literal byte
+            if (inflater->outputPosition >= inflater->outputSize) {
+                inflater->failed = 1;
+                return;
+            }
+            inflater->output[inflater->outputPosition++] = symbol;
+            continue;
+        }
+        //Copy of earlier output
+        symbol -= 257;
+        if (symbol >= 29) {
+            inflater->failed = 1;
+            return;
+        }
+        size_t length = lengthBase[symbol] + getBits(inflater, lengthExtra[symbol]);
+        int distanceSymbol = decodeSymbol(inflater, distanceCodes);
+        if (distanceSymbol < 0 || distanceSymbol >= 30) {
+            inflater->failed = 1;
+            return;
+        }
+        size_t distance = distanceBase[distanceSymbol] + getBits(inflater, distanceExtra[distanceSymbol]);
+        if (distance > inflater->outputPosition || length > inflater->outputSize - inflater->outputPosition) {
+            inflater->failed = 1;
+            return;
+        }
+        for (size_t i = 0; i < length; i++, inflater->outputPosition++) { //Byte by byte since the copy may overlap itself
+            inflater->output[inflater->outputPosition] = inflater->output[inflater->outputPosition - distance];
+        }
+    }
+}
+
+//Reads the code lengths of a block with its own Huffman codes and builds them
+static void readDynamicCodes(Inflater *inflater, Huffman *lengthCodes, Huffman *distanceCodes) {
+    static const short order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    short lengths[320] = {0};
+    int lengthCount = getBits(inflater, 5) + 257;
+    int distanceCount = getBits(inflater, 5) + 1;
+    int codeLengthCount = getBits(inflater, 4) + 4;
+    if (lengthCount > 286 || distanceCount > 30) {
+        inflater->failed = 1;
+        return;
+    }
+    for (int i = 0; i < codeLengthCount; i++) {
+        lengths[order[i]] = getBits(inflater, 3);
+    }
+    Huffman codeLengthCodes;
+    if (!buildHuffman(&codeLengthCodes, lengths, 19)) {
+        inflater->failed = 1;
+        return;
+    }
+    //The code lengths are themselves compressed with a Huffman code and run lengths
+    for (int i = 0; i < lengthCount + distanceCount && !inflater->failed;) {
+        int symbol = decodeSymbol(inflater, &codeLengthCodes);
+        if (symbol < 0) { //Not a valid code
+            inflater->failed = 1;
+            return;
+        }
+        if (symbol < 16) {
+            lengths[i++] = symbol;
+            continue;
+        }
+        short repeated = 0;
+        int count;
+        if (symbol == 16) { //Repeat the last length
+            if (i == 0) {
+                inflater->failed = 1;
+                return;
+            }
+            repeated = lengths[i - 1];
+            count = 3 + getBits(inflater, 2);
+        }
+        else count = symbol == 17 ? 3 + getBits(inflater, 3) : 11 + getBits(inflater, 7); //Runs of zeros
+        if (i + count > lengthCount + distanceCount) {
+            inflater->failed = 1;
+            return;
+        }
+        while (count-- > 0) lengths[i++] = repeated;
+    }
+    if (inflater->failed) return; //The input ran out before every length was read
+    if (lengths[256] == 0 || !buildHuffman(lengthCodes, lengths, lengthCount) || !buildHuffman(distanceCodes, lengths + lengthCount, distanceCount)) inflater->failed = 1;
+}
+
+//Decompresses a zlib stream into the provided output. Returns the number of bytes written, or 0 if the stream is damaged
+static size_t inflateZlib(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) {
+    if (inputSize < 2 || (input[0] & 0x0F) != 8 || (input[0] << 8 | input[1]) % 31 != 0 || input[1] & 0x20) return 0; //Deflate without a preset dictionary
+    Inflater inflater = {input, inputSize, 2, 0, 0, output, outputSize, 0, 0};
+    int isLast;
+    do {
+        isLast = getBits(&inflater, 1);
+        int type = getBits(&inflater, 2);
+        if (type == 0) { //Stored block, starts at the next byte
+            inflater.bitBuffer = 0;
+            inflater.bitCount = 0;
+            if (inflater.inputSize - inflater.inputPosition < 4) return 0;
+            const unsigned char *header = inflater.input + inflater.inputPosition;
+            size_t length = header[0] | header[1] << 8;
+            if ((length ^ (header[2] | header[3] << 8)) != 0xFFFF) return 0;
+            inflater.inputPosition += 4;
+            if (length > inflater.inputSize - inflater.inputPosition || length > inflater.outputSize - inflater.outputPosition) return 0;
+            memcpy(inflater.output + inflater.outputPosition, inflater.input + inflater.inputPosition, length);
+            inflater.inputPosition += length;
+            inflater.outputPosition += length;
+        }
+        else if (type == 1) { //Fixed Huffman codes
+            static Huffman fixedLengthCodes, fixedDistanceCodes;
+            static int isBuilt = 0;
+            if (!isBuilt) {
+                short lengths[288];
+                for (int i = 0; i < 288; i++) {
+                    lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+                }
+                buildHuffman(&fixedLengthCodes, lengths, 288);
+                for (int i = 0; i < 30; i++) {
+                    lengths[i] = 5;
+                }
+                buildHuffman(&fixedDistanceCodes, lengths, 30);
+                isBuilt = 1;
+            }
+            inflateBlock(&inflater, &fixedLengthCodes, &fixedDistanceCodes);
+        }
+        else if (type == 2) { //Huffman codes stored in the block
+            Huffman lengthCodes, distanceCodes;
+            readDynamicCodes(&inflater, &lengthCodes, &distanceCodes);
+            if (!inflater.failed) inflateBlock(&inflater, &lengthCodes, &distanceCodes);
+        }
+        else return 0;
+        if (inflater.failed) return 0;
+    } while (!isLast);
+    return inflater.outputPosition;
+}
+
+//Reads a big endian 32 bit number
+static uint32_t readU32(const unsigned char *bytes) {
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+//Returns the Paeth predictor of a byte, the neighbour closest to left + up - upLeft
+static int paeth(int left, int up, int upLeft) {
+    int estimate = left + up - upLeft;
+    int toLeft = abs(estimate - left), toUp = abs(estimate - up), toUpLeft = abs(estimate - upLeft);
+    if (toLeft <= toUp && toLeft <= toUpLeft) return left;
+    return toUp <= toUpLeft ? up : upLeft;
+}
+
+//Loads a PNG file as 8 bit RGBA pixels, row after row. Returns NULL if the file can't be read or uses a feature that isn't supported
+unsigned char *loadPng(const char *fileName, int *width, int *height) {
+    FILE *f = fopen(fileName, "rb");
+    if (f == NULL) {
+        perror("Failed to open image");
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *file = size > 0 ? malloc(size) : NULL;
+    int read = file != NULL && fread(file, 1, size, f) == (size_t)size;
+    fclose(f);
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (!read || size < 33 || memcmp(file, signature, 8) != 0 || memcmp(file + 12, "IHDR", 4) != 0) {
+        printf("%s is not a PNG image\n", fileName);
+        free(file);
+        return NULL;
+    }
+    uint32_t columns = readU32(file + 16), rows = readU32(file + 20);
+    int bitDepth = file[24], colorType = file[25], interlace = file[28];
+    static const int channelCounts[7] = {1, 0, 3, 1, 2, 0, 4}; //Channels of every color type, 0 for invalid types
+    int channels = colorType <= 6 ? channelCounts[colorType] : 0;
+    if (bitDepth != 8 || channels == 0 || interlace != 0 || columns == 0 || rows == 0 || columns > 65536 || rows > 65536) {
+        printf("%s uses an unsupported PNG format, only 8 bit non interlaced images can be read\n", fileName);
+        free(file);
+        return NULL;
+    }
+    //Gather the compressed data and the palette
+    unsigned char palette[256][4];
+    memset(palette, 255, sizeof(palette));
+    unsigned char *compressed = malloc(size);
+    size_t compressedSize = 0;
+    for (long position = 8; compressed != NULL && position + 12 <= size;) {
+        uint32_t length = readU32(file + position);
+        const unsigned char *type = file + position + 4, *data = file + position + 8;
+        if (length > (uint32_t)(size - position - 12)) break;
+        if (memcmp(type, "IDAT", 4) == 0) {
+            memcpy(compressed + compressedSize, data, length);
+            compressedSize += length;
+        }
+        else if (memcmp(type, "PLTE", 4) == 0) {
+            for (uint32_t i = 0; i < length/3 && i < 256; i++) {
+                memcpy(palette[i], data + 3*i, 3);
+            }
+        }
+        else if (memcmp(type, "tRNS", 4) == 0 && colorType == 3) {
+            for (uint32_t i = 0; i < length && i < 256; i++) {
+                palette[i][3] = data[i];
+            }
+        }
+        else if (memcmp(type, "IEND", 4) == 0) break;
+        position += 12 + length;
+    }
+    free(file);
+    //Every row starts with the byte of the filter it was stored with
+    size_t stride = (size_t)columns*channels;
+    size_t rawSize = rows*(stride + 1);
+    unsigned char *raw = compressed != NULL ? malloc(rawSize) : NULL;
+    unsigned char *pixels = raw != NULL ? malloc((size_t)columns*rows*4) : NULL;
+    if (pixels == NULL || inflateZlib(compressed, compressedSize, raw, rawSize) != rawSize) {
+        printf(pixels == NULL ? "Out of memory decoding %s\n" : "%s is damaged\n", fileName);
+        free(compressed);
+        free(raw);
+        free(pixels);
+        return NULL;
+    }
+    free(compressed);
+    //Undo the filters in place, each one predicts a byte from the pixel to its left and the row above
+    for (uint32_t row = 0; row < rows; row++) {
+        unsigned char *line = raw + row*(stride + 1) + 1;
+        const unsigned char *above = row > 0 ? line - (stride + 1) : NULL;
+        int filter = line[-1];
+        if (filter > 4) { //Only filters 0 to 4 exist
+            printf("%s is damaged\n", fileName);
+            free(raw);
+            free(pixels);
+            return NULL;
+        }
+        for (size_t i = 0; i < stride; i++) {
+            int left = i >= (size_t)channels ? line[i - channels] : 0;
+            int up = above != NULL ? above[i] : 0;
+            int upLeft = above != NULL && i >= (size_t)channels ? above[i - channels] : 0;
+            int prediction = filter == 1 ? left : filter == 2 ? up : filter == 3 ? (left + up)/2 : filter == 4 ? paeth(left, up, upLeft) : 0;
+            line[i] = line[i] + prediction;
+        }
+    }
+    //Expand every color type to RGBA
+    for (uint32_t row = 0; row < rows; row++) {
+        const unsigned char *line = raw + row*(stride + 1) + 1;
+        for (uint32_t column = 0; column < columns; column++) {
+            const unsigned char *source = line + column*channels;
+            unsigned char *pixel = pixels + ((size_t)row*columns + column)*4;
+            switch (colorType) {
+                case 0: pixel[0] = pixel[1] = pixel[2] = source[0]; pixel[3] = 255; break; //Grey
+                case 2: memcpy(pixel, source, 3); pixel[3] = 255; break; //RGB
+                case 3: memcpy(pixel, palette[source[0]], 4); break; //Palette
+                case 4: pixel[0] = pixel[1] = pixel[2] = source[0]; pixel[3] = source[1]; break; //Grey and alpha
+                default: memcpy(pixel, source, 4); break; //RGBA
+            }
+        }
+    }
+    free(raw);
+    *width = columns;
+    *height = rows;
+    return pixels;
+}
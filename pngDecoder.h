@@ -0,0 +1,28 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Minimal PNG decoder for the map compiler, so it doesn't need raylib. Reads 8 bit non interlaced images of every color type
+#ifndef PNGDECODER_H
+#define PNGDECODER_H
+
+unsigned char *loadPng(const char *fileName, int *width, int *height);
+#endif //PNGDECODER_H
@@ -0,0 +1,153 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "profiler.h"
+
+static _Thread_local Profiler *activeProfiler; //Profiler of the calling thread, NULL if it isn't profiled
+
+static const char *stageNames[PROFILE_STAGE_COUNT] = {"frame", "audio", "game_logic", "simulation", "ship_movement", "ship_collisions",
+                                                      "terrain_collisions", "projectiles", "replay", "queue_sprites", "draw_sprites", "present"};
+
+//Returns a monotonic clock reading in nanoseconds
+static uint64_t readClock(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)(counter.QuadPart/frequency.QuadPart)*1000000000 + (uint64_t)(counter.QuadPart%frequency.QuadPart)*1000000000/frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+#endif
+}
+
+//Starts timing the stages run on the calling thread
+void startProfiler(Profiler *profiler) {
+    *profiler = (Profiler){0};
+    profiler->start = readClock();
+    activeProfiler = profiler;
+}
+
+//Stops timing and finishes any capture
+void stopProfiler(Profiler *profiler) {
+    stopProfileCapture(profiler);
+    if (activeProfiler == profiler) activeProfiler = NULL;
+}
+
+void beginProfileStage(ProfileStage stage) {
+    if (activeProfiler != NULL) activeProfiler->stageStart[stage] = readClock();
+}
+
+//Adds the time since the stage began to the current frame, and writes it as an event if a Chrome trace is being captured
+void endProfileStage(ProfileStage stage) {
+    Profiler *profiler = activeProfiler;
+    if (profiler == NULL) return;
+    uint64_t end = readClock(), start = profiler->stageStart[stage];
+    profiler->frameTime[stage] += end - start;
+    if (profiler->isCapturing && profiler->format == PROFILE_CHROME_TRACE) {
+        char event[160];
+        int length = snprintf(event, sizeof(event), "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+                              profiler->eventCount > 0 ? ",\n" : "", stageNames[stage], (start - profiler->start)/1000.0, (end - start)/1000.0);
+        asyncWrite(&profiler->capture, event, length);
+        profiler->eventCount++;
+    }
+}
+
+//Moves the times of the frame that just ended into the history, and writes them as a row if a CSV is being captured
+void endProfileFrame(Profiler *profiler) {
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        profiler->history[i][profiler->historyNext] = profiler->frameTime[i]/1e6f;
+    }
+    profiler->historyNext = (profiler->historyNext + 1)%PROFILE_HISTORY;
+    if (profiler->historyCount < PROFILE_HISTORY) profiler->historyCount++;
+    if (profiler->isCapturing && profiler->format == PROFILE_CSV) {
+        char row[32 + 16*PROFILE_STAGE_COUNT];
+        int length = snprintf(row, sizeof(row), "%llu", (unsigned long long)profiler->frame);
+        for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+            length += snprintf(row + length, sizeof(row) - length, ",%.4f", profiler->frameTime[i]/1e6);
+        }
+        row[length++] = '\n';
+        asyncWrite(&profiler->capture, row, length);
+    }
+    memset(profiler->frameTime, 0, sizeof(profiler->frameTime));
+    profiler->frame++;
+}
+
+//Starts writing timings to a file on a background thread, a Chrome trace if the name ends with .json and a CSV otherwise.
+//Returns 1 if successful and 0 if the file couldn't be opened
+int startProfileCapture(Profiler *profiler, const char *fileName) {
+    stopProfileCapture(profiler);
+    if (!openAsyncWriter(&profiler->capture, fileName)) return 0;
+    size_t length = strlen(fileName);
+    profiler->format = length >= 5 && strcmp(fileName + length - 5, ".json") == 0 ? PROFILE_CHROME_TRACE : PROFILE_CSV;
+    profiler->eventCount = 0;
+    profiler->isCapturing = 1;
+    if (profiler->format == PROFILE_CHROME_TRACE) asyncWrite(&profiler->capture, "[\n", 2);
+    else { //Header row
+        asyncWrite(&profiler->capture, "frame", 5);
+        for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+            char column[32];
+            asyncWrite(&profiler->capture, column, snprintf(column, sizeof(column), ",%s_ms", stageNames[i]));
+        }
+        asyncWrite(&profiler->capture, "\n", 1);
+    }
+    return 1;
+}
+
+//Finishes the capture file. Returns 1 if everything was written and 0 if not
+int stopProfileCapture(Profiler *profiler) {
+    if (!profiler->isCapturing) return 1;
+    if (profiler->format == PROFILE_CHROME_TRACE) asyncWrite(&profiler->capture, "\n]\n", 3);
+    profiler->isCapturing = 0;
+    return closeAsyncWriter(&profiler->capture, 0);
+}
+
+static int compareFloats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+//Gets the median and 99th percentile in milliseconds of the time spent in a stage per frame over the history
+void getProfileStats(const Profiler *profiler, ProfileStage stage, float *median, float *worst) {
+    float sorted[PROFILE_HISTORY];
+    int count = profiler->historyCount;
+    if (count == 0) {
+        *median = *worst = 0;
+        return;
+    }
+    memcpy(sorted, profiler->history[stage], count*sizeof(float)); //Until the history is full it fills from slot 0
+    qsort(sorted, count, sizeof(float), compareFloats);
+    *median = sorted[count/2];
+    *worst = sorted[(count*99 - 1)/100];
+}
+
+const char *getProfileStageName(ProfileStage stage) {
+    return stageNames[stage];
+}
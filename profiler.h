@@ -0,0 +1,68 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Frame profiler. Stages of the simulation and the renderer are timed with PROFILE_BEGIN and PROFILE_END, which compile to nothing
+//unless SHIPBATTLE_PROFILER is defined. Only the thread that started a profiler is timed, other threads skip the timers
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <stdint.h>
+#include "asyncWriter.h"
+#define PROFILE_HISTORY 240 //Frames the percentiles are taken over
+
+typedef enum ProfileStage {PROFILE_FRAME, PROFILE_AUDIO, PROFILE_GAME_LOGIC, PROFILE_SIMULATION, PROFILE_SHIP_MOVEMENT, PROFILE_SHIP_COLLISIONS,
+                           PROFILE_TERRAIN_COLLISIONS, PROFILE_PROJECTILES, PROFILE_REPLAY, PROFILE_QUEUE_SPRITES, PROFILE_DRAW_SPRITES,
+                           PROFILE_PRESENT, PROFILE_STAGE_COUNT} ProfileStage; //Every timed stage, a stage's time includes the stages inside it
+
+typedef enum ProfileFormat {PROFILE_CSV, PROFILE_CHROME_TRACE} ProfileFormat; //Formats timings can be captured in
+
+typedef struct ProfilerStruct {
+    uint64_t start; //Clock reading when the profiler started, captured times are measured from it
+    uint64_t stageStart[PROFILE_STAGE_COUNT]; //When the running timer of every stage started
+    uint64_t frameTime[PROFILE_STAGE_COUNT]; //Time spent in every stage during the current frame
+    float history[PROFILE_STAGE_COUNT][PROFILE_HISTORY]; //Milliseconds spent in every stage during the last frames
+    int historyCount; //Frames in the history
+    int historyNext; //Slot the next frame goes into
+    uint64_t frame; //Frames finished since the profiler started
+    AsyncWriter capture; //File the timings are captured to
+    int isCapturing;
+    ProfileFormat format;
+    int eventCount; //Events written to the Chrome trace
+} Profiler;
+
+void startProfiler(Profiler *profiler);
+void stopProfiler(Profiler *profiler);
+void beginProfileStage(ProfileStage stage);
+void endProfileStage(ProfileStage stage);
+void endProfileFrame(Profiler *profiler);
+int startProfileCapture(Profiler *profiler, const char *fileName);
+int stopProfileCapture(Profiler *profiler);
+void getProfileStats(const Profiler *profiler, ProfileStage stage, float *median, float *worst);
+const char *getProfileStageName(ProfileStage stage);
+
+#ifdef SHIPBATTLE_PROFILER
+#define PROFILE_BEGIN(stage) beginProfileStage(stage)
+#define PROFILE_END(stage) endProfileStage(stage)
+#else
+#define PROFILE_BEGIN(stage) ((void)0)
+#define PROFILE_END(stage) ((void)0)
+#endif
+#endif //PROFILER_H
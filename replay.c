@@ -0,0 +1,559 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+
+static const char replayMagic[4] = {'S', 'B', 'R', 'P'}; //Start of every replay file
+static const char indexMagic[4] = {'S', 'B', 'R', 'I'}; //End of every finished replay file, after the keyframe index
+#define TRAILER_SIZE 12 //Offset of the index followed by indexMagic
+
+//Converts a position to sample units. Rounding the same way on every machine keeps the deltas exact
+static int32_t quantize(float value) {
+    return (int32_t)lrintf(value*REPLAY_POSITION_SCALE);
+}
+
+//Starts a track at an exactly known position
+static void resetTrack(ReplayTrack *track, float value) {
+    track->position = quantize(value);
+    track->delta = 0;
+}
+
+//Wraps a position back into 32 bits. Sums of tracks are done in 64 bits so damaged files can't overflow them
+static int32_t wrapPosition(int64_t value) {
+    return (int32_t)(uint32_t)value;
+}
+
+//Moves a track to its next sampled position. Recorder and player both call this so their predictions stay identical.
+//Small misses nudge the predicted movement by one unit, so steady movement settles into needing no correction, large ones replace it
+static void moveTrack(ReplayTrack *track, int32_t position) {
+    int64_t error = (int64_t)position - track->position - track->delta;
+    if (error > 2*REPLAY_TOLERANCE || error < -2*REPLAY_TOLERANCE) track->delta = wrapPosition((int64_t)position - track->position);
+    else track->delta = wrapPosition((int64_t)track->delta + (error > 0) - (error < 0));
+    track->position = position;
+}
+
+//Samples a track and returns its distance from the predicted position. The prediction is kept while it is close enough to the real position
+static int32_t sampleTrack(ReplayTrack *track, float value) {
+    int32_t predicted = wrapPosition((int64_t)track->position + track->delta);
+    int32_t position = fabsf(value*REPLAY_POSITION_SCALE - predicted) <= REPLAY_TOLERANCE ? predicted : quantize(value);
+    moveTrack(track, position);
+    return wrapPosition((int64_t)position - predicted);
+}
+
+//Applies a sampled distance from the predicted position to a track. Returns the new position in map units
+static float replayTrack(ReplayTrack *track, int32_t error) {
+    moveTrack(track, wrapPosition((int64_t)track->position + track->delta + error));
+    return track->position/REPLAY_POSITION_SCALE;
+}
+
+//Allocates the arrays of a recorder from its arena. Returns 1 if successful and 0 if the arena is full
+static int allocateRecorder(ReplayRecorder *recorder, int playerCount, int capacity) {
+    Arena *arena = &recorder->arena;
+    recorder->shipTracks = arenaAlloc(arena, 2*playerCount*sizeof(ReplayTrack));
+    recorder->shipErrors = arenaAlloc(arena, 2*playerCount*sizeof(int32_t));
+    recorder->shipAlive = arenaAlloc(arena, playerCount*sizeof(int));
+    recorder->shellTracks = arenaAlloc(arena, 3*capacity*sizeof(ReplayTrack));
+    recorder->shellSample = arenaAlloc(arena, capacity*sizeof(int));
+    return recorder->shellSample != NULL;
+}
+
+//Hands the encoded record to the writer and starts a new one
+static void writeRecord(ReplayRecorder *recorder) {
+    asyncWrite(recorder->writer, recorder->record.data, recorder->record.size);
+    recorder->offset += recorder->record.size;
+    recorder->record.size = 0;
+}
+
+//Stores the whole match state and adds it to the keyframe index
+static void writeKeyframe(ReplayRecorder *recorder, const Match *match) {
+    const Fleet *ships = &match->ships;
+    const ProjectileList *projectiles = &match->projectiles;
+    ByteBuffer *record = &recorder->record;
+    if (recorder->keyframeCount == recorder->keyframeCapacity) { //Grow the index
+        int capacity = recorder->keyframeCapacity ? recorder->keyframeCapacity*2 : 64;
+        int *rounds = realloc(recorder->keyframeRounds, capacity*sizeof(int));
+        if (rounds != NULL) recorder->keyframeRounds = rounds;
+        uint64_t *offsets = realloc(recorder->keyframeOffsets, capacity*sizeof(uint64_t));
+        if (offsets != NULL) recorder->keyframeOffsets = offsets;
+        if (rounds == NULL || offsets == NULL) {
+            record->failed = 1; //The index would be incomplete
+            return;
+        }
+        recorder->keyframeCapacity = capacity;
+    }
+    recorder->keyframeRounds[recorder->keyframeCount] = match->round;
+    recorder->keyframeOffsets[recorder->keyframeCount++] = recorder->offset;
+    putU8(record, REPLAY_KEYFRAME);
+    putVarint(record, match->round);
+    putU8(record, match->state | match->isOver << 3);
+    putF32(record, match->roundTimer);
+    putF32(record, match->fireTime);
+    for (int i = 0; i < match->playerCount; i++) {
+        putF32(record, ships->positionX[i]);
+        putF32(record, ships->positionY[i]);
+        putF32(record, ships->heading[i]);
+        putF32(record, ships->speed[i]);
+        putF32(record, ships->aimHeading[i]);
+        putF32(record, ships->aimAngle[i]);
+        putF32(record, ships->distanceMovedX[i]);
+        putF32(record, ships->distanceMovedY[i]);
+        putVarint(record, ships->isAlive[i]);
+        putVarint(record, ships->team[i]);
+        //Samples after the keyframe are predicted from it
+        resetTrack(&recorder->shipTracks[2*i], ships->positionX[i]);
+        resetTrack(&recorder->shipTracks[2*i + 1], ships->positionY[i]);
+        recorder->shipAlive[i] = ships->isAlive[i];
+    }
+    putVarint(record, projectiles->count);
+    for (int i = 0; i < projectiles->count; i++) {
+        int slot = projectiles->slot[i];
+        putVarint(record, slot);
+        putVarint(record, projectiles->team[i]);
+        putF32(record, projectiles->positionX[i]);
+        putF32(record, projectiles->positionY[i]);
+        putF32(record, projectiles->positionZ[i]);
+        putF32(record, projectiles->speedX[i]);
+        putF32(record, projectiles->speedY[i]);
+        putF32(record, projectiles->speedZ[i]);
+        resetTrack(&recorder->shellTracks[3*slot], projectiles->positionX[i]);
+        resetTrack(&recorder->shellTracks[3*slot + 1], projectiles->positionY[i]);
+        resetTrack(&recorder->shellTracks[3*slot + 2], projectiles->positionZ[i]);
+        recorder->shellSample[slot] = recorder->sampleCount;
+    }
+    writeRecord(recorder);
+    recorder->round = match->round;
+    recorder->state = match->state;
+    recorder->ticks = 0;
+}
+
+//Stores what changed since the last sample. Only ships that strayed from their predicted path, ships that were sunk and projectiles in the air are written
+static void writeSample(ReplayRecorder *recorder, const Match *match) {
+    const Fleet *ships = &match->ships;
+    const ProjectileList *projectiles = &match->projectiles;
+    ByteBuffer *record = &recorder->record;
+    int32_t *errors = recorder->shipErrors;
+    int moved = 0, sunk = 0;
+    for (int i = 0; i < match->playerCount; i++) {
+        errors[2*i] = sampleTrack(&recorder->shipTracks[2*i], ships->positionX[i]);
+        errors[2*i + 1] = sampleTrack(&recorder->shipTracks[2*i + 1], ships->positionY[i]);
+        moved += errors[2*i] != 0 || errors[2*i + 1] != 0;
+        sunk += ships->isAlive[i] != recorder->shipAlive[i];
+    }
+    //The flags say which parts follow, so a sample where everything went as predicted takes two bytes
+    int hasTicks = recorder->ticks != REPLAY_SAMPLE_TICKS;
+    putU8(record, REPLAY_SAMPLE);
+    putU8(record, match->state | match->isOver << 3 | hasTicks << 4 | (moved > 0) << 5 | (sunk > 0) << 6 | (projectiles->count > 0) << 7);
+    if (hasTicks) putVarint(record, recorder->ticks);
+    //Ships off their predicted path as the gap from the previous one followed by their distance from it
+    if (moved > 0) putVarint(record, moved);
+    for (int i = 0, previous = -1; i < match->playerCount && moved > 0; i++) {
+        if (errors[2*i] == 0 && errors[2*i + 1] == 0) continue;
+        putVarint(record, i - previous - 1);
+        putSignedVarint(record, errors[2*i]);
+        putSignedVarint(record, errors[2*i + 1]);
+        previous = i;
+    }
+    //Ships whose alive flag changed, coded the same way
+    if (sunk > 0) putVarint(record, sunk);
+    for (int i = 0, previous = -1; i < match->playerCount && sunk > 0; i++) {
+        if (ships->isAlive[i] == recorder->shipAlive[i]) continue;
+        putVarint(record, i - previous - 1);
+        recorder->shipAlive[i] = ships->isAlive[i];
+        previous = i;
+    }
+    //Projectiles that were in the last sample are predicted, new ones are stored whole. Missing ones have been retired
+    if (projectiles->count > 0) putVarint(record, projectiles->count);
+    for (int i = 0; i < projectiles->count; i++) {
+        int slot = projectiles->slot[i];
+        ReplayTrack *tracks = &recorder->shellTracks[3*slot];
+        int isNew = recorder->shellSample[slot] != recorder->sampleCount;
+        putVarint(record, (uint64_t)slot << 1 | isNew);
+        if (isNew) {
+            resetTrack(&tracks[0], projectiles->positionX[i]);
+            resetTrack(&tracks[1], projectiles->positionY[i]);
+            resetTrack(&tracks[2], projectiles->positionZ[i]);
+            putVarint(record, projectiles->team[i]);
+            putSignedVarint(record, tracks[0].position);
+            putSignedVarint(record, tracks[1].position);
+            putSignedVarint(record, tracks[2].position);
+        }
+        else {
+            putSignedVarint(record, sampleTrack(&tracks[0], projectiles->positionX[i]));
+            putSignedVarint(record, sampleTrack(&tracks[1], projectiles->positionY[i]));
+            putSignedVarint(record, sampleTrack(&tracks[2], projectiles->positionZ[i]));
+        }
+        recorder->shellSample[slot] = recorder->sampleCount + 1;
+    }
+    writeRecord(recorder);
+    recorder->sampleCount++;
+    recorder->state = match->state;
+    recorder->ticks = 0;
+}
+
+//Starts recording a match to the provided file, from its current state. Returns 1 if successful and 0 otherwise
+int startReplayRecording(ReplayRecorder *recorder, Match *match, const char *fileName) {
+    *recorder = (ReplayRecorder){0};
+    int capacity = match->projectiles.capacity;
+    //Measure the memory the recorder needs, then allocate it in one block
+    allocateRecorder(recorder, match->playerCount, capacity);
+    if (!createArena(&recorder->arena, recorder->arena.used)) return 0;
+    recorder->arena.used = 0;
+    allocateRecorder(recorder, match->playerCount, capacity);
+    for (int i = 0; i < capacity; i++) {
+        recorder->shellSample[i] = -1;
+    }
+    recorder->writer = malloc(sizeof(AsyncWriter));
+    if (recorder->writer == NULL || !openAsyncWriter(recorder->writer, fileName)) {
+        free(recorder->writer);
+        freeArena(&recorder->arena);
+        return 0;
+    }
+    ByteBuffer *record = &recorder->record;
+    putBytes(record, replayMagic, sizeof(replayMagic));
+    putU16(record, REPLAY_VERSION);
+    putU16(record, REPLAY_SAMPLE_TICKS);
+    putU32(record, match->playerCount);
+    putU32(record, match->volleySize);
+    putU32(record, (uint32_t)lrintf(1.0f/match->tickLength));
+    putF32(record, match->mapBounds.x);
+    putF32(record, match->mapBounds.y);
+    writeRecord(recorder);
+    writeKeyframe(recorder, match);
+    match->replay = recorder;
+    return 1;
+}
+
+//Stores the orders the ships were just given. Called by confirmOrders before the match moves on
+void recordReplayOrders(ReplayRecorder *recorder, const Match *match) {
+    const Fleet *ships = &match->ships;
+    ByteBuffer *record = &recorder->record;
+    int isFire = match->state == FIRE_INSTR;
+    putU8(record, isFire ? REPLAY_FIRE_ORDERS : REPLAY_MOVEMENT_ORDERS);
+    for (int i = 0; i < match->playerCount; i++) {
+        putF32(record, isFire ? ships->aimHeading[i] : ships->heading[i]);
+        putF32(record, isFire ? ships->aimAngle[i] : ships->speed[i]);
+    }
+    writeRecord(recorder);
+}
+
+//Samples the match every REPLAY_SAMPLE_TICKS ticks and on every phase change, and adds a keyframe when a new round starts. Called by stepMatch
+void recordReplayTick(ReplayRecorder *recorder, const Match *match) {
+    recorder->ticks++;
+    int newRound = match->round != recorder->round;
+    if (recorder->ticks >= REPLAY_SAMPLE_TICKS || match->state != recorder->state || match->isOver || newRound) writeSample(recorder, match);
+    if (newRound && !match->isOver) writeKeyframe(recorder, match);
+}
+
+//Writes the keyframe index, closes the file and stops recording the match. Returns 1 if the whole replay was written and 0 otherwise.
+//If wait is 0 the last writes and the close are left to the writer thread so the frame isn't held up, and only failures before that are returned
+int finishReplayRecording(ReplayRecorder *recorder, Match *match, int wait) {
+    if (recorder->ticks > 0) writeSample(recorder, match); //The match was stopped between samples
+    uint64_t indexOffset = recorder->offset;
+    ByteBuffer *record = &recorder->record;
+    putVarint(record, recorder->keyframeCount);
+    for (int i = 0; i < recorder->keyframeCount; i++) {
+        putVarint(record, recorder->keyframeRounds[i]);
+        putVarint(record, recorder->keyframeOffsets[i]);
+    }
+    putU64(record, indexOffset);
+    putBytes(record, indexMagic, sizeof(indexMagic));
+    int succeeded = !record->failed;
+    writeRecord(recorder);
+    if (wait) {
+        succeeded = closeAsyncWriter(recorder->writer, 0) && succeeded;
+        free(recorder->writer);
+    }
+    else closeAsyncWriterLater(recorder->writer, "Failed to write the replay");
+    freeByteBuffer(record);
+    freeArena(&recorder->arena);
+    free(recorder->keyframeRounds);
+    free(recorder->keyframeOffsets);
+    *recorder = (ReplayRecorder){0};
+    if (match->replay == recorder) match->replay = NULL;
+    if (!succeeded) printf("Failed to write the replay\n");
+    return succeeded;
+}
+
+//Allocates the arrays of a player from its arena. Returns 1 if successful and 0 if the arena is full
+static int allocatePlayer(ReplayPlayer *player) {
+    Arena *arena = &player->arena;
+    int capacity = player->playerCount*player->volleySize;
+    int allocated = allocateFleet(&player->ships, player->playerCount, arena);
+    allocated = allocateProjectiles(&player->projectiles, capacity, arena) && allocated;
+    player->shipTracks = arenaAlloc(arena, 2*player->playerCount*sizeof(ReplayTrack));
+    player->shellTracks = arenaAlloc(arena, 3*capacity*sizeof(ReplayTrack));
+    player->shellTeam = arenaAlloc(arena, capacity*sizeof(int));
+    player->shellSpawned = arenaAlloc(arena, capacity*sizeof(int));
+    return allocated && player->shellSpawned != NULL;
+}
+
+//Opens a replay file and moves to its first round. Returns 1 if successful and 0 if the file couldn't be read or isn't a finished replay
+int openReplay(ReplayPlayer *player, const char *fileName) {
+    *player = (ReplayPlayer){0};
+    FILE *f = fopen(fileName, "rb");
+    if (f == NULL) {
+        perror("Error opening replay");
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    player->data = size > 0 ? malloc(size) : NULL;
+    player->size = player->data != NULL && fread(player->data, 1, size, f) == (size_t)size ? size : 0;
+    fclose(f);
+    ByteReader reader = createByteReader(player->data, player->size);
+    char magic[4];
+    getBytes(&reader, magic, sizeof(magic));
+    int version = getU16(&reader);
+    getU16(&reader); //Sample interval, only needed to know how often positions were stored
+    player->playerCount = getU32(&reader);
+    player->volleySize = getU32(&reader);
+    player->tickRate = getU32(&reader);
+    player->mapBounds.x = getF32(&reader);
+    player->mapBounds.y = getF32(&reader);
+    size_t recordStart = reader.position;
+    //Read the keyframe index from the end of the file
+    ByteReader trailer = createByteReader(player->data, player->size);
+    trailer.position = player->size >= TRAILER_SIZE ? player->size - TRAILER_SIZE : player->size;
+    uint64_t indexOffset = getU64(&trailer);
+    char endMagic[4];
+    getBytes(&trailer, endMagic, sizeof(endMagic));
+    if (reader.failed || trailer.failed || memcmp(magic, replayMagic, 4) != 0 || memcmp(endMagic, indexMagic, 4) != 0 || version != REPLAY_VERSION
+        || indexOffset < recordStart || indexOffset > player->size - TRAILER_SIZE || player->playerCount <= 0 || player->volleySize <= 0) {
+        printf("%s is not a finished replay\n", fileName);
+        closeReplay(player);
+        return 0;
+    }
+    ByteReader index = createByteReader(player->data, player->size - TRAILER_SIZE);
+    index.position = indexOffset;
+    player->keyframeCount = getVarint(&index);
+    if (player->keyframeCount <= 0 || (uint64_t)player->keyframeCount > player->size) index.failed = 1;
+    player->keyframeRounds = index.failed ? NULL : malloc(player->keyframeCount*sizeof(int));
+    player->keyframeOffsets = index.failed ? NULL : malloc(player->keyframeCount*sizeof(uint64_t));
+    for (int i = 0; i < player->keyframeCount && player->keyframeOffsets != NULL && player->keyframeRounds != NULL; i++) {
+        player->keyframeRounds[i] = getVarint(&index);
+        player->keyframeOffsets[i] = getVarint(&index);
+    }
+    //Measure the memory the player needs, then allocate it in one block
+    allocatePlayer(player);
+    int allocated = player->keyframeOffsets != NULL && player->keyframeRounds != NULL && createArena(&player->arena, player->arena.used);
+    player->arena.used = 0;
+    if (index.failed || !allocated || !allocatePlayer(player)) {
+        printf("Failed to read the replay index\n");
+        closeReplay(player);
+        return 0;
+    }
+    //A damaged index can point at a sample, which must not find tracks left in the arena
+    memset(player->shellTracks, 0, 3*player->projectiles.capacity*sizeof(ReplayTrack));
+    memset(player->shellSpawned, 0, player->projectiles.capacity*sizeof(int));
+    player->reader = createByteReader(player->data, indexOffset); //Records end where the index starts
+    return seekReplay(player, player->keyframeRounds[0]);
+}
+
+//Frees the memory of the player
+void closeReplay(ReplayPlayer *player) {
+    free(player->data);
+    free(player->keyframeRounds);
+    free(player->keyframeOffsets);
+    freeArena(&player->arena);
+    *player = (ReplayPlayer){0};
+}
+
+//Returns the number of rounds that can be sought to
+int getReplayRoundCount(const ReplayPlayer *player) {
+    return player->keyframeCount;
+}
+
+//Moves to the start of the provided round by decoding its keyframe. Returns 1 if successful and 0 if the round isn't in the replay
+int seekReplay(ReplayPlayer *player, int round) {
+    int keyframe = round - player->keyframeRounds[0]; //Every round after the first one recorded starts with a keyframe
+    if (keyframe < 0 || keyframe >= player->keyframeCount || player->keyframeRounds[keyframe] != round) return 0;
+    player->reader.position = player->keyframeOffsets[keyframe];
+    player->reader.failed = 0;
+    return readReplayRecord(player) == REPLAY_KEYFRAME;
+}
+
+//Decodes a keyframe into the player
+static void readKeyframe(ReplayPlayer *player) {
+    ByteReader *reader = &player->reader;
+    Fleet *ships = &player->ships;
+    ProjectileList *projectiles = &player->projectiles;
+    player->round = getVarint(reader);
+    int state = getU8(reader);
+    player->state = state & 7;
+    player->isOver = state >> 3 & 1;
+    player->roundTimer = getF32(reader);
+    getF32(reader); //Time since the projectiles were fired, only needed to resume the simulation
+    player->ticks = 0;
+    //Slots not listed below hold no projectile, so samples can only start new ones in them
+    memset(player->shellTracks, 0, 3*projectiles->capacity*sizeof(ReplayTrack));
+    memset(player->shellSpawned, 0, projectiles->capacity*sizeof(int));
+    for (int i = 0; i < player->playerCount; i++) {
+        ships->positionX[i] = getF32(reader);
+        ships->positionY[i] = getF32(reader);
+        ships->heading[i] = getF32(reader);
+        ships->speed[i] = getF32(reader);
+        ships->aimHeading[i] = getF32(reader);
+        ships->aimAngle[i] = getF32(reader);
+        ships->distanceMovedX[i] = getF32(reader);
+        ships->distanceMovedY[i] = getF32(reader);
+        ships->isAlive[i] = getVarint(reader);
+        ships->team[i] = getVarint(reader);
+        ships->velocityX[i] = 0;
+        ships->velocityY[i] = 0;
+        resetTrack(&player->shipTracks[2*i], ships->positionX[i]);
+        resetTrack(&player->shipTracks[2*i + 1], ships->positionY[i]);
+    }
+    uint64_t count = getVarint(reader);
+    if (count > (uint64_t)projectiles->capacity) reader->failed = 1;
+    projectiles->count = reader->failed ? 0 : count;
+    for (int i = 0; i < projectiles->count; i++) {
+        uint64_t slot = getVarint(reader);
+        if (slot >= (uint64_t)projectiles->capacity) {
+            reader->failed = 1;
+            projectiles->count = 0;
+            return;
+        }
+        projectiles->slot[i] = slot;
+        projectiles->team[i] = player->shellTeam[slot] = getVarint(reader);
+        projectiles->positionX[i] = getF32(reader);
+        projectiles->positionY[i] = getF32(reader);
+        projectiles->positionZ[i] = getF32(reader);
+        projectiles->speedX[i] = getF32(reader);
+        projectiles->speedY[i] = getF32(reader);
+        projectiles->speedZ[i] = getF32(reader);
+        resetTrack(&player->shellTracks[3*slot], projectiles->positionX[i]);
+        resetTrack(&player->shellTracks[3*slot + 1], projectiles->positionY[i]);
+        resetTrack(&player->shellTracks[3*slot + 2], projectiles->positionZ[i]);
+        player->shellSpawned[slot] = 1;
+    }
+}
+
+//Decodes a sample into the player
+static void readSample(ReplayPlayer *player) {
+    ByteReader *reader = &player->reader;
+    Fleet *ships = &player->ships;
+    ProjectileList *projectiles = &player->projectiles;
+    int state = getU8(reader);
+    player->state = state & 7;
+    player->isOver = state >> 3 & 1;
+    player->ticks += state >> 4 & 1 ? (int)getVarint(reader) : REPLAY_SAMPLE_TICKS;
+    //Every ship follows its predicted path, the listed ones are moved off it
+    uint64_t moved = state >> 5 & 1 ? getVarint(reader) : 0;
+    uint64_t next = moved > 0 ? getVarint(reader) : (uint64_t)player->playerCount; //Next listed ship
+    for (int i = 0; i < player->playerCount; i++) {
+        int32_t errorX = 0, errorY = 0;
+        if ((uint64_t)i == next) {
+            errorX = getSignedVarint(reader);
+            errorY = getSignedVarint(reader);
+            next = --moved > 0 ? i + 1 + getVarint(reader) : (uint64_t)player->playerCount;
+        }
+        ships->positionX[i] = replayTrack(&player->shipTracks[2*i], errorX);
+        ships->positionY[i] = replayTrack(&player->shipTracks[2*i + 1], errorY);
+    }
+    if (moved > 0) { //A listed ship is past the end of the fleet
+        reader->failed = 1;
+        return;
+    }
+    uint64_t sunk = state >> 6 & 1 ? getVarint(reader) : 0;
+    for (uint64_t i = 0, ship = -1; i < sunk && !reader->failed; i++) {
+        ship += getVarint(reader) + 1;
+        if (ship >= (uint64_t)player->playerCount) {
+            reader->failed = 1;
+            return;
+        }
+        ships->isAlive[ship] = !ships->isAlive[ship];
+    }
+    uint64_t count = state >> 7 ? getVarint(reader) : 0;
+    if (count > (uint64_t)projectiles->capacity) reader->failed = 1;
+    projectiles->count = reader->failed ? 0 : count;
+    for (int i = 0; i < projectiles->count; i++) {
+        uint64_t key = getVarint(reader);
+        uint64_t slot = key >> 1;
+        if (slot >= (uint64_t)projectiles->capacity) {
+            reader->failed = 1;
+            projectiles->count = 0;
+            return;
+        }
+        ReplayTrack *tracks = &player->shellTracks[3*slot];
+        if (!(key & 1) && !player->shellSpawned[slot]) { //An update to a slot that never held a projectile
+            reader->failed = 1;
+            projectiles->count = 0;
+            return;
+        }
+        if (key & 1) { //New projectile
+            player->shellTeam[slot] = getVarint(reader);
+            player->shellSpawned[slot] = 1;
+            for (int axis = 0; axis < 3; axis++) {
+                tracks[axis] = (ReplayTrack){getSignedVarint(reader), 0};
+            }
+        }
+        else {
+            for (int axis = 0; axis < 3; axis++) {
+                replayTrack(&tracks[axis], getSignedVarint(reader));
+            }
+        }
+        projectiles->slot[i] = slot;
+        projectiles->team[i] = player->shellTeam[slot];
+        projectiles->positionX[i] = tracks[0].position/REPLAY_POSITION_SCALE;
+        projectiles->positionY[i] = tracks[1].position/REPLAY_POSITION_SCALE;
+        projectiles->positionZ[i] = tracks[2].position/REPLAY_POSITION_SCALE;
+    }
+}
+
+//Decodes the next record into the player. Returns the type of the record, or 0 at the end of the replay or if the file is damaged
+int readReplayRecord(ReplayPlayer *player) {
+    ByteReader *reader = &player->reader;
+    Fleet *ships = &player->ships;
+    if (reader->failed || reader->position >= reader->size) return 0;
+    int type = getU8(reader);
+    switch (type) {
+        case REPLAY_KEYFRAME:
+            readKeyframe(player);
+            break;
+        case REPLAY_MOVEMENT_ORDERS:
+        case REPLAY_FIRE_ORDERS:
+            for (int i = 0; i < player->playerCount; i++) {
+                float heading = getF32(reader), value = getF32(reader);
+                if (type == REPLAY_FIRE_ORDERS) {
+                    ships->aimHeading[i] = heading;
+                    ships->aimAngle[i] = value;
+                }
+                else {
+                    ships->heading[i] = heading;
+                    ships->speed[i] = value;
+                }
+            }
+            break;
+        case REPLAY_SAMPLE:
+            readSample(player);
+            break;
+        default:
+            reader->failed = 1;
+            break;
+    }
+    return reader->failed ? 0 : type;
+}
@@ -0,0 +1,98 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Compact match recordings. Orders, a keyframe at the start of every round and delta encoded samples in between,
+//with an index of the keyframes at the end of the file so any round can be reached by decoding a single keyframe
+#ifndef REPLAY_H
+#define REPLAY_H
+#include <stdint.h>
+#include "asyncWriter.h"
+#include "byteBuffer.h"
+#include "match.h"
+#define REPLAY_VERSION 1
+#define REPLAY_SAMPLE_TICKS 6 //Ticks between samples, phase changes are always sampled
+#define REPLAY_POSITION_SCALE 16.0f //Sampled positions are stored in 1/16 units
+#define REPLAY_TOLERANCE 2 //Sampled positions stay on their predicted path while it is within this many 1/16 units
+
+typedef enum ReplayRecord {REPLAY_KEYFRAME = 1, REPLAY_MOVEMENT_ORDERS, REPLAY_FIRE_ORDERS, REPLAY_SAMPLE} ReplayRecord; //Record types of the stream
+
+typedef struct ReplayTrackStruct {
+    int32_t position; //Position on one axis at the last sample, in 1/16 units
+    int32_t delta; //Movement between the last two samples, the next sample is predicted to move the same
+} ReplayTrack;
+
+typedef struct ReplayRecorderStruct {
+    AsyncWriter *writer; //Allocated so finishing can leave the last writes and the close to the writer thread
+    ByteBuffer record; //Record being encoded, reused for every record
+    uint64_t offset; //Bytes written so far
+    Arena arena; //Memory of the arrays below
+    ReplayTrack *shipTracks; //Sampled x and y of every ship
+    int32_t *shipErrors; //Distance of every ship from its predicted x and y at the sample being written
+    int *shipAlive; //Ship alive flags at the last sample
+    ReplayTrack *shellTracks; //Sampled x, y and z of every projectile, indexed by pool slot
+    int *shellSample; //Number of the last sample each pool slot was in
+    int sampleCount; //Samples written so far
+    int keyframeCount;
+    int keyframeCapacity;
+    int *keyframeRounds; //Round of every keyframe, in the order they were written
+    uint64_t *keyframeOffsets; //File offset of every keyframe
+    int round; //Round of the last keyframe
+    GameState state; //Phase at the last sample
+    int ticks; //Ticks since the last sample
+} ReplayRecorder;
+
+typedef struct ReplayPlayerStruct {
+    unsigned char *data; //The whole file
+    size_t size;
+    ByteReader reader; //Positioned at the next record
+    int playerCount;
+    int volleySize;
+    int tickRate;
+    Vector2 mapBounds;
+    int keyframeCount;
+    int *keyframeRounds;
+    uint64_t *keyframeOffsets;
+    Arena arena; //Memory of the arrays below
+    Fleet ships; //Ship state decoded so far. Velocities aren't stored and are left at 0
+    ProjectileList projectiles; //Projectiles in the air, only positions, slots and teams are filled
+    ReplayTrack *shipTracks; //Sampled x and y of every ship
+    ReplayTrack *shellTracks; //Sampled x, y and z of every projectile, indexed by pool slot
+    int *shellTeam; //Team of the projectile in each pool slot
+    int *shellSpawned; //Whether each pool slot has held a projectile since the keyframe
+    int round;
+    GameState state;
+    int isOver;
+    float roundTimer; //Time left in the round at the keyframe, not advanced by samples
+    int ticks; //Ticks played since the keyframe
+} ReplayPlayer;
+
+int startReplayRecording(ReplayRecorder *recorder, Match *match, const char *fileName);
+void recordReplayOrders(ReplayRecorder *recorder, const Match *match);
+void recordReplayTick(ReplayRecorder *recorder, const Match *match);
+int finishReplayRecording(ReplayRecorder *recorder, Match *match, int wait);
+
+int openReplay(ReplayPlayer *player, const char *fileName);
+void closeReplay(ReplayPlayer *player);
+int getReplayRoundCount(const ReplayPlayer *player);
+int seekReplay(ReplayPlayer *player, int round);
+int readReplayRecord(ReplayPlayer *player);
+#endif //REPLAY_H
@@ -0,0 +1,298 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asyncWriter.h"
+#include "saveFile.h"
+
+static const char saveMagic[4] = {'S', 'B', 'S', 'V'}; //Start of every save file
+
+//Encodes the whole match state, along with whose turn it is, into a save file with a header and a checksum
+void encodeSave(ByteBuffer *buffer, const Match *match, int targetPlayer, int picking) {
+    const Fleet *ships = &match->ships;
+    const ProjectileList *projectiles = &match->projectiles;
+    buffer->size = 0;
+    buffer->failed = 0;
+    //The header is filled in once the size and checksum of the contents are known
+    putBytes(buffer, saveMagic, sizeof(saveMagic));
+    putU16(buffer, SAVE_VERSION);
+    putU16(buffer, 0); //Flags, none are defined yet
+    putU32(buffer, 0);
+    putU32(buffer, 0);
+    putVarint(buffer, match->playerCount);
+    putVarint(buffer, match->volleySize);
+    putVarint(buffer, (uint64_t)lrintf(1.0f/match->tickLength));
+    putVarint(buffer, match->round);
+    putU8(buffer, match->state);
+    putU8(buffer, match->isOver);
+    putF32(buffer, match->roundTimer);
+    putF32(buffer, match->fireTime);
+    putVarint(buffer, targetPlayer);
+    putVarint(buffer, picking);
+    for (int i = 0; i < match->playerCount; i++) {
+        putVarint(buffer, ships->team[i]);
+        putU8(buffer, ships->isAlive[i]);
+        putF32(buffer, ships->positionX[i]);
+        putF32(buffer, ships->positionY[i]);
+        putF32(buffer, ships->speed[i]);
+        putF32(buffer, ships->heading[i]);
+        putF32(buffer, ships->aimHeading[i]);
+        putF32(buffer, ships->aimAngle[i]);
+        putF32(buffer, ships->distanceMovedX[i]);
+        putF32(buffer, ships->distanceMovedY[i]);
+    }
+    //Projectiles are stored in pool order so hits at the same moment resolve the same way after loading
+    putVarint(buffer, projectiles->count);
+    for (int i = 0; i < projectiles->count; i++) {
+        putVarint(buffer, projectiles->team[i]);
+        putF32(buffer, projectiles->positionX[i]);
+        putF32(buffer, projectiles->positionY[i]);
+        putF32(buffer, projectiles->positionZ[i]);
+        putF32(buffer, projectiles->speedX[i]);
+        putF32(buffer, projectiles->speedY[i]);
+        putF32(buffer, projectiles->speedZ[i]);
+    }
+    if (buffer->failed) return;
+    size_t size = buffer->size - SAVE_HEADER_SIZE;
+    uint32_t crc = computeCrc32(buffer->data + SAVE_HEADER_SIZE, size);
+    buffer->size = 8; //Go back to fill in the header
+    putU32(buffer, size);
+    putU32(buffer, crc);
+    buffer->size = SAVE_HEADER_SIZE + size;
+}
+
+//Starts a match from an encoded save. Returns 1 if successful and 0 if the save is damaged, from another version or out of memory
+int decodeSave(const void *data, size_t size, Match *match, const TerrainGrid *terrain, Vector2 mapBounds, int *targetPlayer, int *picking) {
+    ByteReader reader = createByteReader(data, size);
+    char magic[4];
+    getBytes(&reader, magic, sizeof(magic));
+    int version = getU16(&reader);
+    int flags = getU16(&reader);
+    uint32_t contentSize = getU32(&reader);
+    uint32_t crc = getU32(&reader);
+    if (reader.failed || memcmp(magic, saveMagic, 4) != 0) {
+        printf("Not a save file\n");
+        return 0;
+    }
+    if (version != SAVE_VERSION || flags != 0) {
+        printf("Save file version %d isn't supported\n", version);
+        return 0;
+    }
+    if (contentSize != size - SAVE_HEADER_SIZE || computeCrc32(reader.data + SAVE_HEADER_SIZE, contentSize) != crc) {
+        printf("Save file is damaged\n");
+        return 0;
+    }
+    uint64_t playerCount = getVarint(&reader);
+    uint64_t volleySize = getVarint(&reader);
+    uint64_t tickRate = getVarint(&reader);
+    if (playerCount < 2 || playerCount > size || volleySize < 1 || volleySize > size || tickRate < 1 || tickRate > 100000) {
+        printf("Save file is damaged\n");
+        return 0;
+    }
+    if (!initializeMatch(match, playerCount, volleySize, terrain, mapBounds, tickRate)) return 0;
+    Fleet *ships = &match->ships;
+    ProjectileList *projectiles = &match->projectiles;
+    match->round = getVarint(&reader);
+    int state = getU8(&reader);
+    match->state = state <= FIRE ? state : DIRECTION_INSTR;
+    match->isOver = getU8(&reader) != 0;
+    match->roundTimer = getF32(&reader);
+    match->fireTime = getF32(&reader);
+    *targetPlayer = getVarint(&reader) % playerCount;
+    *picking = getVarint(&reader) % playerCount;
+    for (int i = 0; i < match->playerCount; i++) {
+        ships->team[i] = getVarint(&reader);
+        ships->isAlive[i] = getU8(&reader) != 0;
+        ships->positionX[i] = getF32(&reader);
+        ships->positionY[i] = getF32(&reader);
+        ships->speed[i] = getF32(&reader);
+        ships->heading[i] = getF32(&reader);
+        ships->aimHeading[i] = getF32(&reader);
+        ships->aimAngle[i] = getF32(&reader);
+        ships->distanceMovedX[i] = getF32(&reader);
+        ships->distanceMovedY[i] = getF32(&reader);
+        match->previousShipPositions[i] = (Vector2){ships->positionX[i], ships->positionY[i]}; //Nothing to interpolate from yet
+    }
+    uint64_t projectileCount = getVarint(&reader);
+    for (uint64_t i = 0; i < projectileCount && !reader.failed; i++) {
+        int team = getVarint(&reader);
+        Vector3 position = {getF32(&reader), getF32(&reader), getF32(&reader)};
+        Vector3 speed = {getF32(&reader), getF32(&reader), getF32(&reader)};
+        int slot = spawnProjectile(projectiles, position, speed, team);
+        if (slot < 0) reader.failed = 1; //More projectiles than the match can hold
+        else match->previousProjectilePositions[slot] = position;
+    }
+    if (reader.failed) {
+        printf("Save file is damaged\n");
+        return 0;
+    }
+    updateShipVelocities(ships);
+    updateShipGeometry(ships, match->geometry);
+    scheduleProjectileImpacts(match); //Work out the hits of the projectiles that were in the air
+    return 1;
+}
+
+//Writes a save to a temporary file, syncs it to the disk and then renames it over the old save,
+//so a crash at any point leaves either the old or the new save whole. Returns 1 if successful and 0 if not
+int writeSaveFile(const char *fileName, const void *data, size_t size) {
+    char temporaryName[1024];
+    snprintf(temporaryName, sizeof(temporaryName), "%s.tmp", fileName);
+    FILE *f = fopen(temporaryName, "wb");
+    if (f == NULL) {
+        perror("Failed to save game");
+        return 0;
+    }
+    int written = fwrite(data, 1, size, f) == size && syncFile(f);
+    written = fclose(f) == 0 && written;
+#ifdef _WIN32
+    if (written) remove(fileName); //rename doesn't replace files on Windows
+#endif
+    if (!written || rename(temporaryName, fileName) != 0) {
+        perror("Failed to save game");
+        remove(temporaryName);
+        return 0;
+    }
+    return 1;
+}
+
+//Reads a save file and starts a match from it. Returns 1 if successful and 0 if not
+int loadSaveFile(const char *fileName, Match *match, const TerrainGrid *terrain, Vector2 mapBounds, int *targetPlayer, int *picking) {
+    FILE *f = fopen(fileName, "rb");
+    if (f == NULL) {
+        perror("Failed to load game");
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *data = size > 0 ? malloc(size) : NULL;
+    int read = data != NULL && fread(data, 1, size, f) == (size_t)size;
+    fclose(f);
+    int loaded = read && decodeSave(data, size, match, terrain, mapBounds, targetPlayer, picking);
+    free(data);
+    return loaded;
+}
+
+//Writes every snapshot handed over by requestSave and removes the file when asked, until the writer is stopped
+static void *runSaveWriter(void *argument) {
+    SaveWriter *writer = argument;
+    pthread_mutex_lock(&writer->lock);
+    while (1) {
+        while (!writer->hasSnapshot && !writer->shouldRemove && !writer->isStopping) {
+            pthread_cond_wait(&writer->wake, &writer->lock);
+        }
+        if (writer->hasSnapshot) { //Swap the buffers so the next snapshot can be captured while this one is written
+            ByteBuffer *snapshot = writer->back;
+            writer->back = writer->front;
+            writer->front = snapshot;
+            writer->hasSnapshot = 0;
+            writer->isBusy = 1;
+            pthread_mutex_unlock(&writer->lock);
+            writeSaveFile(writer->fileName, snapshot->data, snapshot->size);
+            pthread_mutex_lock(&writer->lock);
+        }
+        else if (writer->shouldRemove) {
+            writer->shouldRemove = 0;
+            writer->isBusy = 1;
+            pthread_mutex_unlock(&writer->lock);
+            remove(writer->fileName);
+            pthread_mutex_lock(&writer->lock);
+        }
+        else break; //Stopping and nothing is left to do
+        writer->isBusy = 0;
+        pthread_cond_broadcast(&writer->wake); //Wake finishSaves
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+//Starts the thread that writes the saves to the provided file
+void startSaveWriter(SaveWriter *writer, const char *fileName) {
+    *writer = (SaveWriter){0};
+    writer->fileName = fileName;
+    writer->front = &writer->snapshots[0];
+    writer->back = &writer->snapshots[1];
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->wake, NULL);
+    writer->isThreaded = pthread_create(&writer->thread, NULL, runSaveWriter, writer) == 0;
+}
+
+//Captures the match into the back snapshot and lets the writer thread save it. A snapshot that hasn't been written yet is replaced by the newer one.
+//Only waits for the writer thread to swap buffers, never for the disk
+void requestSave(SaveWriter *writer, const Match *match, int targetPlayer, int picking) {
+    pthread_mutex_lock(&writer->lock);
+    encodeSave(writer->back, match, targetPlayer, picking);
+    if (writer->back->failed) printf("Failed to save game!\n");
+    else {
+        writer->hasSnapshot = 1;
+        writer->shouldRemove = 0; //The new save replaces the removal
+        pthread_cond_signal(&writer->wake);
+    }
+    pthread_mutex_unlock(&writer->lock);
+    if (!writer->isThreaded && writer->hasSnapshot) { //Without a thread the save is written right away
+        writer->hasSnapshot = 0;
+        writeSaveFile(writer->fileName, writer->back->data, writer->back->size);
+    }
+}
+
+//Drops any snapshot waiting to be written and removes the save file once the current write is done
+void requestSaveRemoval(SaveWriter *writer) {
+    pthread_mutex_lock(&writer->lock);
+    writer->hasSnapshot = 0;
+    writer->shouldRemove = 1;
+    pthread_cond_signal(&writer->wake);
+    pthread_mutex_unlock(&writer->lock);
+    if (!writer->isThreaded) {
+        writer->shouldRemove = 0;
+        remove(writer->fileName);
+    }
+}
+
+//Waits until every requested save or removal has reached the disk. Used before the save file is read
+void finishSaves(SaveWriter *writer) {
+    if (!writer->isThreaded) return;
+    pthread_mutex_lock(&writer->lock);
+    while (writer->hasSnapshot || writer->shouldRemove || writer->isBusy) {
+        pthread_cond_wait(&writer->wake, &writer->lock);
+    }
+    pthread_mutex_unlock(&writer->lock);
+}
+
+//Finishes every requested save or removal and stops the writer thread
+void stopSaveWriter(SaveWriter *writer) {
+    if (writer->isThreaded) {
+        pthread_mutex_lock(&writer->lock);
+        writer->isStopping = 1;
+        pthread_cond_signal(&writer->wake);
+        pthread_mutex_unlock(&writer->lock);
+        pthread_join(writer->thread, NULL);
+    }
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->wake);
+    freeByteBuffer(&writer->snapshots[0]);
+    freeByteBuffer(&writer->snapshots[1]);
+    *writer = (SaveWriter){0};
+}
@@ -0,0 +1,57 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Versioned and checksummed save files, written on a background thread from a double buffered snapshot
+#ifndef SAVEFILE_H
+#define SAVEFILE_H
+#include <pthread.h>
+#include "byteBuffer.h"
+#include "match.h"
+#define SAVE_VERSION 1
+#define SAVE_HEADER_SIZE 16 //Magic, version, flags, size and CRC of the contents
+
+typedef struct SaveWriterStruct {
+    const char *fileName;
+    pthread_t thread;
+    pthread_mutex_t lock; //Protects every field below it
+    pthread_cond_t wake; //Signalled when a snapshot is ready, the save should be removed or the writer is stopped
+    ByteBuffer snapshots[2]; //The writer thread writes the front snapshot while the next one is captured into the back one
+    ByteBuffer *front;
+    ByteBuffer *back;
+    int hasSnapshot; //Set when the back snapshot is waiting to be written
+    int shouldRemove; //Set when the save file should be removed once the current write is done
+    int isBusy; //Set while the writer thread is writing or removing the file
+    int isThreaded; //0 if the thread couldn't be started, saves are then written on the calling thread
+    int isStopping;
+} SaveWriter;
+
+void encodeSave(ByteBuffer *buffer, const Match *match, int targetPlayer, int picking);
+int decodeSave(const void *data, size_t size, Match *match, const TerrainGrid *terrain, Vector2 mapBounds, int *targetPlayer, int *picking);
+int writeSaveFile(const char *fileName, const void *data, size_t size);
+int loadSaveFile(const char *fileName, Match *match, const TerrainGrid *terrain, Vector2 mapBounds, int *targetPlayer, int *picking);
+
+void startSaveWriter(SaveWriter *writer, const char *fileName);
+void requestSave(SaveWriter *writer, const Match *match, int targetPlayer, int picking);
+void requestSaveRemoval(SaveWriter *writer);
+void finishSaves(SaveWriter *writer);
+void stopSaveWriter(SaveWriter *writer);
+#endif //SAVEFILE_H
@@ -0,0 +1,612 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Microbenchmarks of the simulation kernels. Every kernel is run over positions recorded from bot matches and over synthetic
+//scenarios of growing size, and the results are compared against a stored baseline so regressions fail the run
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "ballistics.h"
+#include "bots.h"
+#include "compiledMap.h"
+#include "fireControl.h"
+#include "navGraph.h"
+#define BENCH_MAX_RESULTS 64
+#define BENCH_RECORDED_MATCHES 40 //Bot matches the recorded scenarios are taken from
+#define BENCH_MAX_RECORDED 16384 //Most recorded hitboxes and shots kept
+#define BENCH_MAP_SIZE (Vector2){2048, 1152}
+#define BENCH_ROUTES 1024 //Random routes planned on the real map
+#define BENCH_CACHED_ROUTES 64 //Routes planned over and over again, few enough to stay in the route cache
+#define BENCH_RETRIES 2 //Times a scenario that looks slower than its baseline is measured again before it counts as a regression
+
+typedef struct ShotStruct {
+    Vector3 position; //Where the projectile was fired from
+    Vector3 speed;
+    ShipGeometry target; //Hitbox of a ship it was fired at
+} Shot;
+
+typedef struct ScenarioStruct {
+    char name[64];
+    void (*run)(struct ScenarioStruct *scenario, long operations); //Runs the kernel the provided number of times
+    int itemsPerOperation; //Ships or shots handled by one run of the kernel
+    const TerrainGrid *terrain;
+    const ShipGeometry *geometry; //Hitboxes checked against the terrain
+    int geometryCount;
+    Fleet *ships; //Fleet moved or checked for ship collisions
+    ShipGeometry *fleetGeometry;
+    SweepAndPrune *sweep;
+    int *isAlive; //Ships alive before a collision check, restored after every check
+    const Shot *shots;
+    int shotCount;
+    PathFinder *pathFinder;
+    const Vector2 *routes; //Start and goal of every route
+    int routeCount;
+    int isCold; //Set to empty the route cache before every route
+} Scenario;
+
+typedef struct ResultStruct {
+    char name[64];
+    double median; //Nanoseconds per operation
+    double best; //Fastest sample. Other work on the machine only ever slows a sample down, so this is what regressions are judged on
+    double reference; //Fastest sample of runReference measured right before, in nanoseconds per operation
+    double mean;
+    double deviation; //Standard deviation of the samples in nanoseconds per operation
+    double itemsPerSecond;
+} Result;
+
+typedef struct BenchOptions {
+    const char *mapFile;
+    const char *baselineFile; //Baseline compared against, NULL to not compare
+    const char *saveFile; //File the results are written to as the new baseline, NULL to not write one
+    const char *filter; //Only scenarios whose name contains this run, NULL for all of them
+    int samples; //Timed samples per scenario
+    double sampleTime; //Seconds every sample should take
+    double tolerance; //Slowdown against the baseline that counts as a regression, as a fraction
+    int isAnyHost; //Set to fail on regressions against a baseline recorded on another machine
+} BenchOptions;
+
+static volatile int sink; //Results of the kernels are added here so the compiler can't remove them
+
+//Returns the time in seconds from an arbitrary point
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//Kernels
+
+static void runTerrainCollision(Scenario *scenario, long operations) {
+    int hits = 0;
+    for (long i = 0, j = 0; i < operations; i++) {
+        hits += checkTerrainCollision(&scenario->geometry[j], scenario->terrain);
+        if (++j == scenario->geometryCount) j = 0;
+    }
+    sink += hits;
+}
+
+static void runShipCollisions(Scenario *scenario, long operations) {
+    Fleet *ships = scenario->ships;
+    for (long i = 0; i < operations; i++) {
+        checkShipCollisions(ships, scenario->fleetGeometry, scenario->sweep);
+        sink += ships->isAlive[0];
+        memcpy(ships->isAlive, scenario->isAlive, ships->count*sizeof(int)); //Revive the ships the check sank
+    }
+}
+
+static void runShipPositions(Scenario *scenario, long operations) {
+    for (long i = 0; i < operations; i++) {
+        updateShipPositions(scenario->ships, 1.0f/SIMULATION_TICK_RATE);
+    }
+    sink += (int)scenario->ships->positionX[0];
+}
+
+static void runImpactTime(Scenario *scenario, long operations) {
+    float total = 0;
+    for (long i = 0, j = 0; i < operations; i++) {
+        const Shot *shot = &scenario->shots[j];
+        total += findImpactTime(&shot->target, shot->position, shot->speed, 0);
+        if (++j == scenario->shotCount) j = 0;
+    }
+    sink += isfinite(total);
+}
+
+static void runFindPath(Scenario *scenario, long operations) {
+    Vector2 waypoints[MAX_PATH_NODES + 1];
+    int total = 0;
+    for (long i = 0, j = 0; i < operations; i++) {
+        if (scenario->isCold) clearPathCache(scenario->pathFinder);
+        total += findPath(scenario->pathFinder, scenario->routes[2*j], scenario->routes[2*j + 1], waypoints, MAX_PATH_NODES + 1);
+        if (++j == scenario->routeCount) j = 0;
+    }
+    sink += total;
+}
+
+//Fixed work that never changes with the code. It is timed next to every scenario so a machine that got slower or faster as a whole can be told apart from a kernel that did
+static void runReference(Scenario *scenario, long operations) {
+    (void)scenario; //The work is generated, no scenario data is needed
+    float total = 0;
+    unsigned int state = 1;
+    for (long i = 0; i < operations; i++) {
+        state = state*1664525u + 1013904223u;
+        total += sqrtf((float)(state >> 8))*0.5f;
+    }
+    sink += isfinite(total);
+}
+
+static void runLinePoint(Scenario *scenario, long operations) {
+    (void)scenario; //The points are generated, no scenario data is needed
+    int total = 0;
+    for (long i = 0; i < operations; i++) {
+        total += getLinePoint((i & 1023)*(1.5f/1024), (int)(i*7 & 1023)); //Angles up to 1.5 radians and distances up to 1023
+    }
+    sink += total;
+}
+
+//Scenarios
+
+//Plays bot matches on the provided terrain and keeps the hitbox of every ship at every movement tick, and every shot fired
+//together with the hitbox of every ship it could hit. Returns the number of hitboxes kept
+static int recordScenarios(const TerrainGrid *terrain, ShipGeometry *geometry, Shot *shots, int *shotCount) {
+    Match match = {0};
+    int geometryCount = 0;
+    *shotCount = 0;
+    unsigned int seed = 1;
+    for (int m = 0; m < BENCH_RECORDED_MATCHES; m++) {
+        if (!initializeMatch(&match, 8, 1, terrain, BENCH_MAP_SIZE, SIMULATION_TICK_RATE)) break;
+        for (int ticks = 0; !match.isOver && match.round < 20 && ticks < 20000; ticks++) {
+            if (match.state == DIRECTION_INSTR || match.state == FIRE_INSTR) {
+                for (int i = 0; i < match.playerCount; i++) {
+                    if (!match.ships.isAlive[i]) continue;
+                    if (match.state == DIRECTION_INSTR) randomMovementOrder(&match, i, &seed);
+                    else aimedFireOrder(&match, i, &seed);
+                }
+                confirmOrders(&match);
+                continue;
+            }
+            GameState state = match.state;
+            stepMatch(&match);
+            for (int i = 0; i < match.playerCount && geometryCount < BENCH_MAX_RECORDED; i++) {
+                if (match.ships.isAlive[i] && (state == MOVEMENT_A || state == MOVEMENT_B)) geometry[geometryCount++] = match.geometry[i];
+            }
+            if (state != MOVEMENT_B || match.state != FIRE) continue;
+            ProjectileList *projectiles = &match.projectiles; //The volleys were just fired
+            for (int p = 0; p < projectiles->count; p++) {
+                for (int i = 0; i < match.playerCount && *shotCount < BENCH_MAX_RECORDED; i++) {
+                    if (!match.ships.isAlive[i] || i == projectiles->team[p]) continue;
+                    shots[(*shotCount)++] = (Shot){{projectiles->positionX[p], projectiles->positionY[p], projectiles->positionZ[p]},
+                                                   {projectiles->speedX[p], projectiles->speedY[p], projectiles->speedZ[p]}, match.geometry[i]};
+                }
+            }
+        }
+    }
+    freeMatch(&match);
+    return geometryCount;
+}
+
+//Builds a terrain of the map's edges and the provided number of random segments
+static int buildSyntheticTerrain(TerrainGrid *terrain, int segmentCount, unsigned int *seed) {
+    Vector2 size = BENCH_MAP_SIZE;
+    Line *segments = malloc((segmentCount + 4)*sizeof(Line));
+    if (segments == NULL) return 0;
+    Vector2 corners[4] = {{0, 0}, {size.x, 0}, size, {0, size.y}};
+    for (int i = 0; i < 4; i++) {
+        segments[i] = (Line){corners[i], corners[(i + 1)%4]};
+    }
+    for (int i = 4; i < segmentCount + 4; i++) {
+        Vector2 start = {randomFloat(seed, 0, size.x), randomFloat(seed, 0, size.y)};
+        float heading = randomFloat(seed, 0, 2*M_PI), length = randomFloat(seed, 10, 60);
+        segments[i] = (Line){start, Vector2Add(start, (Vector2){length*cosf(heading), length*sinf(heading)})};
+    }
+    int built = buildTerrainGrid(terrain, segments, segmentCount + 4, TERRAIN_CELL_SIZE);
+    free(segments);
+    return built;
+}
+
+//Places ships at random positions with random headings and speeds
+static void scatterShips(Fleet *ships, unsigned int *seed) {
+    Vector2 size = BENCH_MAP_SIZE;
+    for (int i = 0; i < ships->count; i++) {
+        ships->positionX[i] = randomFloat(seed, 0, size.x);
+        ships->positionY[i] = randomFloat(seed, 0, size.y);
+        ships->heading[i] = randomFloat(seed, 0, 2*M_PI);
+        ships->speed[i] = randomFloat(seed, 0, maxShipSpeed);
+        ships->isAlive[i] = 1;
+        ships->team[i] = i;
+    }
+    updateShipVelocities(ships);
+}
+
+//Allocates a fleet of scattered ships, with hitboxes and a broad phase, from an arena. Returns 1 if successful and 0 if the arena is full.
+//While the arena is measuring the fleet is allocated into throwaway structs so every allocation is counted
+static int createFleet(Scenario *scenario, Arena *arena, int shipCount, unsigned int *seed) {
+    Fleet measuredShips;
+    SweepAndPrune measuredSweep;
+    Fleet *ships = arenaAlloc(arena, sizeof(Fleet));
+    scenario->sweep = arenaAlloc(arena, sizeof(SweepAndPrune));
+    int allocated = allocateFleet(ships != NULL ? ships : &measuredShips, shipCount, arena);
+    allocated = allocateSweepAndPrune(scenario->sweep != NULL ? scenario->sweep : &measuredSweep, shipCount, arena) && allocated;
+    scenario->fleetGeometry = arenaAlloc(arena, shipCount*sizeof(ShipGeometry));
+    scenario->isAlive = arenaAlloc(arena, shipCount*sizeof(int));
+    if (!allocated || ships == NULL || scenario->sweep == NULL || scenario->fleetGeometry == NULL || scenario->isAlive == NULL) return 0;
+    scenario->ships = ships;
+    scatterShips(ships, seed);
+    updateShipGeometry(ships, scenario->fleetGeometry);
+    resetSweepAndPrune(scenario->sweep);
+    memcpy(scenario->isAlive, ships->isAlive, shipCount*sizeof(int));
+    return 1;
+}
+
+//Measuring
+
+//Returns the number of operations a sample of the scenario needs. It is doubled until a run takes a tenth of the sample time,
+//then scaled up to fill it, so fast and slow kernels are measured with the same precision
+static long calibrateScenario(Scenario *scenario, double sampleTime) {
+    long operations = 1;
+    double elapsed = 0;
+    while (1) {
+        double start = now();
+        scenario->run(scenario, operations);
+        elapsed = now() - start;
+        if (elapsed >= sampleTime/10 || operations > (1L << 40)) break;
+        operations *= 2;
+    }
+    return (long)fmax(1, operations*sampleTime/fmax(elapsed, 1e-9));
+}
+
+//Times a scenario. Every sample is preceded by a shorter one of the reference work, so both see the machine in the same state
+static Result measureScenario(Scenario *scenario, const BenchOptions *options) {
+    static Scenario reference = {"reference", runReference, 1};
+    static long referenceOperations = 0;
+    if (referenceOperations == 0) referenceOperations = calibrateScenario(&reference, options->sampleTime/4);
+    long operations = calibrateScenario(scenario, options->sampleTime);
+    double referenceBest = INFINITY;
+    double samples[256];
+    int sampleCount = options->samples < 256 ? options->samples : 256;
+    double sum = 0;
+    for (int i = 0; i < sampleCount; i++) {
+        double start = now();
+        reference.run(&reference, referenceOperations);
+        referenceBest = fmin(referenceBest, (now() - start)*1e9/referenceOperations);
+        start = now();
+        scenario->run(scenario, operations);
+        samples[i] = (now() - start)*1e9/operations;
+        sum += samples[i];
+    }
+    //Insertion sort, there are only a few samples
+    for (int i = 1; i < sampleCount; i++) {
+        double sample = samples[i];
+        int j = i;
+        for (; j > 0 && samples[j - 1] > sample; j--) samples[j] = samples[j - 1];
+        samples[j] = sample;
+    }
+    Result result = {0};
+    snprintf(result.name, sizeof(result.name), "%s", scenario->name);
+    result.median = samples[sampleCount/2];
+    result.best = samples[0];
+    result.reference = referenceBest;
+    result.mean = sum/sampleCount;
+    double variance = 0;
+    for (int i = 0; i < sampleCount; i++) {
+        variance += (samples[i] - result.mean)*(samples[i] - result.mean);
+    }
+    result.deviation = sampleCount > 1 ? sqrt(variance/(sampleCount - 1)) : 0;
+    result.itemsPerSecond = scenario->itemsPerOperation*1e9/result.median;
+    return result;
+}
+
+//Writes the name of this machine, which baselines are tied to since timings from another machine mean nothing here
+static void getHostName(char *name, size_t size) {
+#ifdef _WIN32
+    const char *computer = getenv("COMPUTERNAME");
+    snprintf(name, size, "%s", computer != NULL ? computer : "unknown");
+#else
+    if (gethostname(name, size) != 0) snprintf(name, size, "unknown");
+    name[size - 1] = '\0'; //gethostname doesn't terminate a truncated name
+#endif
+}
+
+//Baselines are written one result per line so they can be read back without a JSON parser
+static int saveBaseline(const char *fileName, const Result *results, int resultCount) {
+    FILE *f = fopen(fileName, "w");
+    if (f == NULL) {
+        perror("Error saving baseline");
+        return 0;
+    }
+    char host[64];
+    getHostName(host, sizeof(host));
+    fprintf(f, "{\n  \"version\": 2,\n  \"host\": \"%s\",\n  \"results\": [\n", host);
+    for (int i = 0; i < resultCount; i++) {
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.4f, \"best\": %.4f, \"reference\": %.4f, \"mean\": %.4f, \"stddev\": %.4f, \"items_per_sec\": %.1f}%s\n", results[i].name,
+                results[i].median, results[i].best, results[i].reference, results[i].mean, results[i].deviation, results[i].itemsPerSecond, i + 1 < resultCount ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+//Reads a baseline written by saveBaseline and the machine it was recorded on. Returns the number of results read, or -1 if the file can't be opened
+static int loadBaseline(const char *fileName, Result *results, int capacity, char *host, size_t hostSize) {
+    FILE *f = fopen(fileName, "r");
+    if (f == NULL) return -1;
+    char line[512];
+    int count = 0;
+    snprintf(host, hostSize, "unknown"); //Baselines from before hosts were stored
+    while (count < capacity && fgets(line, sizeof(line), f) != NULL) {
+        const char *hostField = strstr(line, "\"host\": \"");
+        if (hostField != NULL) {
+            const char *end = strchr(hostField + 9, '"');
+            if (end != NULL) snprintf(host, hostSize, "%.*s", (int)(end - hostField - 9), hostField + 9);
+            continue;
+        }
+        Result result = {0};
+        const char *name = strstr(line, "\"name\": \"");
+        const char *time = strstr(line, "\"ns_per_op\": ");
+        const char *deviation = strstr(line, "\"stddev\": ");
+        const char *best = strstr(line, "\"best\": ");
+        const char *reference = strstr(line, "\"reference\": ");
+        if (name == NULL || time == NULL || sscanf(name + 9, "%63[^\"]", result.name) != 1) continue;
+        result.median = atof(time + 13);
+        if (deviation != NULL) result.deviation = atof(deviation + 10);
+        result.best = best != NULL ? atof(best + 8) : result.median; //Older baselines only have the median
+        if (reference != NULL) result.reference = atof(reference + 13);
+        results[count++] = result;
+    }
+    fclose(f);
+    return count;
+}
+
+//Returns how much slower the result is than its baseline, as a fraction. Baselines without reference timings are compared directly
+static double getChange(const Result *result, const Result *baseline) {
+    if (result->reference > 0 && baseline->reference > 0) return (result->best/result->reference)/(baseline->best/baseline->reference) - 1;
+    return result->best/baseline->best - 1;
+}
+
+static void printUsage(void) {
+    printf("Usage: shipbattle_bench [options]\n"
+           "  --map FILE            Compiled map of the recorded scenarios (default collisions.sbm)\n"
+           "  --baseline FILE       Baseline to compare against (default benchBaseline.json when it exists)\n"
+           "  --no-baseline         Don't compare against a baseline\n"
+           "  --save-baseline FILE  Write the results as a new baseline\n"
+           "  --filter TEXT         Only run scenarios whose name contains TEXT\n"
+           "  --samples N           Timed samples per scenario (default 11)\n"
+           "  --sample-time N       Seconds per sample (default 0.02)\n"
+           "  --tolerance N         Slowdown in percent that counts as a regression (default 25)\n"
+           "  --any-host            Fail on regressions even if the baseline was recorded on another machine\n");
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options = {"collisions.sbm", "benchBaseline.json", NULL, NULL, 11, 0.02, 0.25, 0};
+    int isDefaultBaseline = 1; //A missing default baseline is fine, a missing baseline that was asked for isn't
+    //Read the command line options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) options.mapFile = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            options.baselineFile = argv[++i];
+            isDefaultBaseline = 0;
+        }
+        else if (strcmp(argv[i], "--no-baseline") == 0) options.baselineFile = NULL;
+        else if (strcmp(argv[i], "--save-baseline") == 0 && i + 1 < argc) options.saveFile = argv[++i];
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) options.filter = argv[++i];
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) options.samples = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sample-time") == 0 && i + 1 < argc) options.sampleTime = atof(argv[++i]);
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) options.tolerance = atof(argv[++i])/100;
+        else if (strcmp(argv[i], "--any-host") == 0) options.isAnyHost = 1;
+        else {
+            printUsage();
+            return strcmp(argv[i], "--help") != 0;
+        }
+    }
+    if (options.samples < 1 || !(options.sampleTime > 0) || !(options.tolerance >= 0)) {
+        printUsage();
+        return 1;
+    }
+
+    //Maps of every density: the real map, then synthetic ones with only the edges and with sparse and dense random segments
+    CompiledMap map;
+    TerrainGrid terrains[4];
+    const char *terrainNames[4] = {"map", "open", "sparse", "dense"};
+    const int syntheticSegments[4] = {0, 0, 500, 20000};
+    unsigned int seed = 1;
+    if (!openCompiledMap(&map, options.mapFile, &terrains[0])) return 1;
+    for (int i = 1; i < 4; i++) {
+        if (!buildSyntheticTerrain(&terrains[i], syntheticSegments[i], &seed)) {
+            printf("Failed to build the synthetic maps\n");
+            return 1;
+        }
+    }
+
+    //Recorded hitboxes and shots, and random ones of the same number
+    ShipGeometry *recordedGeometry = malloc(BENCH_MAX_RECORDED*sizeof(ShipGeometry));
+    ShipGeometry *randomGeometry = malloc(BENCH_MAX_RECORDED*sizeof(ShipGeometry));
+    Shot *recordedShots = malloc(BENCH_MAX_RECORDED*sizeof(Shot));
+    Shot *randomShots = malloc(BENCH_MAX_RECORDED*sizeof(Shot));
+    Scenario *scenarios = calloc(BENCH_MAX_RESULTS, sizeof(Scenario));
+    Result *results = calloc(BENCH_MAX_RESULTS, sizeof(Result));
+    Result *baseline = calloc(BENCH_MAX_RESULTS, sizeof(Result));
+    if (recordedGeometry == NULL || randomGeometry == NULL || recordedShots == NULL || randomShots == NULL || scenarios == NULL || results == NULL || baseline == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    int shotCount;
+    int geometryCount = recordScenarios(&terrains[0], recordedGeometry, recordedShots, &shotCount);
+    if (geometryCount == 0 || shotCount == 0) {
+        printf("No ship positions or shots were recorded\n");
+        return 1;
+    }
+
+    //Random ships and shots come from a throwaway fleet
+    const int fleetSizes[4] = {4, 32, 256, 2048};
+    const int movedFleetSizes[3] = {8, 1024, 65536};
+    Arena arena = {0};
+    for (int pass = 0; pass < 2; pass++) { //Measure the memory every fleet needs, then allocate it in one block
+        if (pass == 1 && !createArena(&arena, arena.used)) {
+            printf("Out of memory\n");
+            return 1;
+        }
+        resetArena(&arena);
+        Scenario scattered = {0};
+        int created = createFleet(&scattered, &arena, geometryCount, &seed);
+        for (int i = 0; i < 4; i++) {
+            created = createFleet(&scenarios[i], &arena, fleetSizes[i], &seed) && created;
+        }
+        for (int i = 0; i < 3; i++) {
+            created = createFleet(&scenarios[4 + i], &arena, movedFleetSizes[i], &seed) && created;
+        }
+        if (pass == 0) continue;
+        if (!created) {
+            printf("Out of memory\n");
+            return 1;
+        }
+        memcpy(randomGeometry, scattered.fleetGeometry, geometryCount*sizeof(ShipGeometry));
+        for (int i = 0; i < shotCount; i++) { //Shots from random positions at random ships, some in range and some not
+            float heading = randomFloat(&seed, 0, 2*M_PI), angle = randomFloat(&seed, 0.05f, 1.4f);
+            randomShots[i] = (Shot){{randomFloat(&seed, 0, BENCH_MAP_SIZE.x), randomFloat(&seed, 0, BENCH_MAP_SIZE.y), LAUNCH_HEIGHT},
+                                    {PROJECTILE_SPEED*cosf(angle)*cosf(heading), PROJECTILE_SPEED*cosf(angle)*sinf(heading), PROJECTILE_SPEED*sinf(angle)},
+                                    randomGeometry[i%geometryCount]};
+        }
+    }
+
+    //Routes between random points of open sea on the real map, planned over its navigation graph
+    NavGraph navigation;
+    PathFinder pathFinder;
+    Vector2 *routes = malloc(2*BENCH_ROUTES*sizeof(Vector2));
+    if (routes == NULL || !buildNavGraph(&navigation, &terrains[0]) || !createPathFinder(&pathFinder, &navigation)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < 2*BENCH_ROUTES;) {
+        Vector2 point = {randomFloat(&seed, 0, BENCH_MAP_SIZE.x), randomFloat(&seed, 0, BENCH_MAP_SIZE.y)};
+        if (isWater(&terrains[0], point) && getTerrainDistance(&terrains[0], point) > NAV_CLEARANCE) routes[i++] = point;
+    }
+
+    //Name, kernel and data of every scenario. The fleets allocated above are the first seven
+    Scenario fleets[7];
+    memcpy(fleets, scenarios, sizeof(fleets));
+    int scenarioCount = 0;
+    for (int t = 0; t < 4; t++) {
+        for (int source = 0; source < 2; source++) {
+            Scenario *scenario = &scenarios[scenarioCount++];
+            *scenario = (Scenario){"", runTerrainCollision, 1, &terrains[t], source == 0 ? recordedGeometry : randomGeometry, geometryCount};
+            snprintf(scenario->name, sizeof(scenario->name), "terrain_collision/%s/%s", terrainNames[t], source == 0 ? "recorded" : "random");
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        Scenario *scenario = &scenarios[scenarioCount++];
+        *scenario = fleets[i];
+        scenario->run = runShipCollisions;
+        scenario->itemsPerOperation = fleetSizes[i];
+        snprintf(scenario->name, sizeof(scenario->name), "ship_collisions/%d", fleetSizes[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        Scenario *scenario = &scenarios[scenarioCount++];
+        *scenario = fleets[4 + i];
+        scenario->run = runShipPositions;
+        scenario->itemsPerOperation = movedFleetSizes[i];
+        snprintf(scenario->name, sizeof(scenario->name), "ship_positions/%d", movedFleetSizes[i]);
+    }
+    for (int source = 0; source < 2; source++) {
+        Scenario *scenario = &scenarios[scenarioCount++];
+        *scenario = (Scenario){"", runImpactTime, 1};
+        scenario->shots = source == 0 ? recordedShots : randomShots;
+        scenario->shotCount = shotCount;
+        snprintf(scenario->name, sizeof(scenario->name), "impact_time/%s", source == 0 ? "recorded" : "random");
+    }
+    for (int isCold = 1; isCold >= 0; isCold--) {
+        Scenario *scenario = &scenarios[scenarioCount++];
+        *scenario = (Scenario){"", runFindPath, 1};
+        scenario->pathFinder = &pathFinder;
+        scenario->routes = routes;
+        scenario->routeCount = isCold ? BENCH_ROUTES : BENCH_CACHED_ROUTES;
+        scenario->isCold = isCold;
+        snprintf(scenario->name, sizeof(scenario->name), "find_path/%s", isCold ? "cold" : "cached");
+    }
+    scenarios[scenarioCount++] = (Scenario){"line_point", runLinePoint, 1};
+
+    //Run every scenario and compare it with the baseline
+    char baselineHost[64], host[64];
+    int baselineCount = options.baselineFile != NULL ? loadBaseline(options.baselineFile, baseline, BENCH_MAX_RESULTS, baselineHost, sizeof(baselineHost)) : 0;
+    if (baselineCount < 0 && !isDefaultBaseline) {
+        printf("Failed to read baseline %s\n", options.baselineFile);
+        return 1;
+    }
+    getHostName(host, sizeof(host));
+    int isGated = baselineCount > 0 && (options.isAnyHost || strcmp(baselineHost, host) == 0); //Timings from another machine are only shown
+    if (baselineCount > 0 && !isGated) printf("Baseline was recorded on %s, not %s: differences are reported but don't fail the run\n", baselineHost, host);
+    printf("%d recorded hitboxes and %d recorded shots\n", geometryCount, shotCount);
+    printf("%-36s %12s %12s %8s %14s %10s\n", "scenario", "ns/op", "best ns/op", "stddev", "items/sec", "baseline");
+    int resultCount = 0, regressions = 0;
+    for (int i = 0; i < scenarioCount; i++) {
+        if (options.filter != NULL && strstr(scenarios[i].name, options.filter) == NULL) continue;
+        Result *result = &results[resultCount++];
+        *result = measureScenario(&scenarios[i], &options);
+        char comparison[32] = "-";
+        for (int j = 0; j < baselineCount; j++) {
+            if (strcmp(baseline[j].name, result->name) != 0) continue;
+            //The fastest samples are compared, relative to the reference work timed next to them, so neither a burst of other work
+            //nor the whole machine running slower makes a kernel look slower. One that still does is measured again, only a slowdown seen every time counts
+            double change = getChange(result, &baseline[j]);
+            for (int retry = 0; retry < BENCH_RETRIES && change > options.tolerance; retry++) {
+                Result again = measureScenario(&scenarios[i], &options);
+                if (getChange(&again, &baseline[j]) < change) {
+                    result->best = again.best;
+                    result->reference = again.reference;
+                }
+                change = getChange(result, &baseline[j]);
+            }
+            int isRegression = isGated && change > options.tolerance;
+            snprintf(comparison, sizeof(comparison), "%+.1f%%%s", change*100, isRegression ? " SLOWER" : "");
+            regressions += isRegression;
+        }
+        printf("%-36s %12.2f %12.2f %7.1f%% %14.4g %10s\n", result->name, result->median, result->best, 100*result->deviation/result->mean, result->itemsPerSecond, comparison);
+        fflush(stdout);
+    }
+    if (options.saveFile != NULL && !saveBaseline(options.saveFile, results, resultCount)) return 1;
+
+    freePathFinder(&pathFinder);
+    freeNavGraph(&navigation);
+    free(routes);
+    closeCompiledMap(&map);
+    for (int i = 1; i < 4; i++) {
+        freeTerrainGrid(&terrains[i]);
+    }
+    freeArena(&arena);
+    free(recordedGeometry);
+    free(randomGeometry);
+    free(recordedShots);
+    free(randomShots);
+    free(scenarios);
+    free(results);
+    free(baseline);
+    if (regressions > 0) {
+        printf("\n*** %d REGRESSION%s: slower than %s by more than %.0f%% ***\n", regressions, regressions > 1 ? "S" : "", options.baselineFile, options.tolerance*100);
+        return 1;
+    }
+    return 0;
+}
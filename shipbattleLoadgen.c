@@ -0,0 +1,218 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Load generator for shipbattle_server. Opens many client connections on one epoll loop, every client plays its ship with a bot and
+//joins another match when its match ends. Reports finished matches per second and how long the server took to resolve every phase
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bots.h"
+#include "compiledMap.h"
+#include "matchClient.h"
+#define MAX_EVENTS 256
+
+typedef struct LoadOptions {
+    const char *address;
+    const char *mapFile;
+    int clients; //Connections kept open at once
+    int players; //Ships per match, every client plays one of them
+    double duration; //Seconds to run for
+    unsigned int seed;
+} LoadOptions;
+
+typedef struct LoadClientStruct {
+    MatchClient client;
+    Match match; //Copy of the match on the server, needed by the bot to give its orders
+    unsigned int seed;
+    double submitTime; //When the orders of the current phase were sent, 0 if they haven't been
+} LoadClient;
+
+typedef struct LoadStatsStruct {
+    long matches; //Matches played to the end, counted by the client in the first seat
+    long phases; //Phases resolved after a client sent its orders, counted once for every client
+    float *latencies; //Milliseconds from sending the orders of a phase to receiving the state it resolved to
+    long latencyCount;
+    long latencyCapacity;
+    int failures; //Connections lost
+} LoadStats;
+
+//Returns the time in seconds from an arbitrary point
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static int compareFloats(const void *a, const void *b) {
+    float difference = *(const float *)a - *(const float *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+static void addLatency(LoadStats *stats, double seconds) {
+    if (stats->latencyCount == stats->latencyCapacity) {
+        long capacity = stats->latencyCapacity > 0 ? stats->latencyCapacity*2 : 4096;
+        float *grown = realloc(stats->latencies, capacity*sizeof(float));
+        if (grown == NULL) return;
+        stats->latencies = grown;
+        stats->latencyCapacity = capacity;
+    }
+    stats->latencies[stats->latencyCount++] = seconds*1000;
+}
+
+//Handles everything the server sent the client: follows the match state, gives the bot's orders and joins a new match once it ends
+static int playClient(LoadClient *load, const LoadOptions *options, const TerrainGrid *terrain, LoadStats *stats) {
+    MatchClient *client = &load->client;
+    if (!updateMatchClient(client)) return 0;
+    while (client->hasOrders || client->hasState) {
+        client->hasOrders = 0; //The phases aren't played out locally, only the states are followed
+        if (client->hasState) {
+            if (!applyServerState(client, &load->match, terrain)) return 0;
+            if (load->submitTime > 0) {
+                addLatency(stats, now() - load->submitTime);
+                stats->phases++;
+                load->submitTime = 0;
+            }
+            if (load->match.isOver) {
+                stats->matches += client->firstSeat == 0;
+                if (!joinServerMatch(client, options->players, 1, (Vector2){2048, 1152})) return 0;
+            }
+        }
+        if (!updateMatchClient(client)) return 0; //Take the next message
+    }
+    Match *match = &load->match;
+    int ship = client->firstSeat;
+    int isGivingOrders = match->state == DIRECTION_INSTR || match->state == FIRE_INSTR;
+    if (client->hasJoined && match->playerCount == client->playerCount && !match->isOver && isGivingOrders && !client->isWaiting && match->ships.isAlive[ship]) {
+        if (match->state == FIRE_INSTR) bots[0].fireOrder(match, ship, &load->seed);
+        else bots[0].movementOrder(match, ship, &load->seed);
+        submitOrders(client, match);
+        load->submitTime = now();
+    }
+    return !client->connection.failed;
+}
+
+static void printUsage(void) {
+    printf("Usage: shipbattle_loadgen [options]\n"
+           "  --connect ADDRESS  Server to connect to, HOST:PORT, PORT or unix:PATH (default 7777)\n"
+           "  --map FILE         Compiled map the server uses (default collisions.sbm)\n"
+           "  --clients N        Connections kept open, each playing one ship (default 200)\n"
+           "  --players N        Ships per match (default 2)\n"
+           "  --duration N       Seconds to run for (default 10)\n"
+           "  --seed N           Seed of the bot orders (default 1)\n");
+}
+
+int main(int argc, char **argv) {
+    LoadOptions options = {"7777", "collisions.sbm", 200, 2, 10, 1};
+    //Read the command line options
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--help") == 0) {
+            printUsage();
+            return 0;
+        }
+        if (value == NULL) {
+            printUsage();
+            return 1;
+        }
+        if (strcmp(argv[i], "--connect") == 0) options.address = value;
+        else if (strcmp(argv[i], "--map") == 0) options.mapFile = value;
+        else if (strcmp(argv[i], "--clients") == 0) options.clients = atoi(value);
+        else if (strcmp(argv[i], "--players") == 0) options.players = atoi(value);
+        else if (strcmp(argv[i], "--duration") == 0) options.duration = atof(value);
+        else if (strcmp(argv[i], "--seed") == 0) options.seed = strtoul(value, NULL, 10);
+        else {
+            printUsage();
+            return 1;
+        }
+        i++;
+    }
+    if (options.clients < 1 || options.players < 2 || options.players > MAX_SERVER_PLAYERS || !(options.duration > 0)) {
+        printUsage();
+        return 1;
+    }
+
+    CompiledMap map;
+    TerrainGrid terrain;
+    if (!openCompiledMap(&map, options.mapFile, &terrain)) return 1;
+    LoadClient *clients = calloc(options.clients, sizeof(LoadClient));
+    int epoll = epoll_create1(0);
+    if (clients == NULL || epoll < 0) {
+        perror("Error starting load generator");
+        return 1;
+    }
+    LoadStats stats = {0};
+    int connected = 0;
+    for (int i = 0; i < options.clients; i++) {
+        LoadClient *load = &clients[i];
+        load->seed = options.seed + i;
+        if (!connectMatchClient(&load->client, options.address, options.players, 1, (Vector2){2048, 1152})) break;
+        struct epoll_event event = {EPOLLIN, {.u32 = i}};
+        epoll_ctl(epoll, EPOLL_CTL_ADD, load->client.connection.socket, &event);
+        connected++;
+    }
+    if (connected < options.clients) {
+        printf("Only %d of %d clients could connect\n", connected, options.clients);
+        if (connected == 0) return 1;
+    }
+    printf("%d clients playing %d player matches for %.1f s\n", connected, options.players, options.duration);
+
+    double start = now();
+    struct epoll_event events[MAX_EVENTS];
+    while (now() - start < options.duration) {
+        int eventCount = epoll_wait(epoll, events, MAX_EVENTS, 100);
+        for (int i = 0; i < eventCount; i++) {
+            LoadClient *load = &clients[events[i].data.u32];
+            if (load->client.connection.socket < 0) continue;
+            if (!playClient(load, &options, &terrain, &stats)) { //The server dropped the client
+                stats.failures++;
+                closeMatchClient(&load->client);
+            }
+        }
+    }
+    double elapsed = now() - start;
+
+    //Report the results
+    printf("Matches finished: %ld (%.1f matches/sec)\n", stats.matches, stats.matches/elapsed);
+    printf("Orders answered: %ld (%.1f/sec)\n", stats.phases, stats.phases/elapsed);
+    if (stats.latencyCount > 0) {
+        qsort(stats.latencies, stats.latencyCount, sizeof(float), compareFloats);
+        printf("Orders to resolved state: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", stats.latencies[stats.latencyCount/2],
+               stats.latencies[(long)(stats.latencyCount*0.99)], stats.latencies[stats.latencyCount - 1]);
+    }
+    if (stats.failures > 0) printf("Connections lost: %d\n", stats.failures);
+
+    for (int i = 0; i < options.clients; i++) {
+        if (clients[i].client.connection.socket >= 0 && i < connected) closeMatchClient(&clients[i].client);
+        freeMatch(&clients[i].match);
+    }
+    free(clients);
+    free(stats.latencies);
+    close(epoll);
+    freeTerrainGrid(&terrain);
+    closeCompiledMap(&map);
+    return stats.failures > 0;
+}
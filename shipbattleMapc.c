@@ -0,0 +1,181 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Map compiler. Builds a compiled map from island images, whose opaque parts are traced into terrain polylines, and from collisions.dat
+//files of fixed size sections
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "compiledMap.h"
+#include "outlineTracer.h"
+#include "pngDecoder.h"
+
+//Returns the time in seconds from an arbitrary point
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//Adds the lines of every section as polylines, starting a new polyline wherever a line doesn't start where the last one ended
+static void addSections(MapBuilder *builder, const struct CollisionSection *sections, int sectionCount) {
+    Vector2 points[11];
+    for (int i = 0; i < sectionCount; i++) {
+        int pointCount = 0;
+        for (int j = 0; j < 10; j++) {
+            Line line = sections[i].Lines[j];
+            if (pointCount > 0 && (points[pointCount - 1].x != line.start.x || points[pointCount - 1].y != line.start.y)) {
+                addMapPolyline(builder, points, pointCount);
+                pointCount = 0;
+            }
+            if (pointCount == 0) points[pointCount++] = line.start;
+            points[pointCount++] = line.end;
+        }
+        addMapPolyline(builder, points, pointCount);
+    }
+}
+
+//Adds the edges of the map as a closed polyline
+static void addBorder(MapBuilder *builder, Vector2 size) {
+    Vector2 corners[5] = {{0, 0}, {size.x, 0}, size, {0, size.y}, {0, 0}};
+    addMapPolyline(builder, corners, 5);
+}
+
+//Returns 1 if the file name ends with the provided extension
+static int hasExtension(const char *fileName, const char *extension) {
+    size_t length = strlen(fileName), extensionLength = strlen(extension);
+    return length >= extensionLength && strcmp(fileName + length - extensionLength, extension) == 0;
+}
+
+//Adds an input to the builder. Images are written FILE.png[@X,Y[,SCALE]] to place them on the map. Returns 1 if successful and 0 if not
+static int addInput(MapBuilder *builder, const char *input, int threshold, OutlinePlacement placement) {
+    char fileName[1024];
+    const char *at = strrchr(input, '@');
+    size_t length = at != NULL ? (size_t)(at - input) : strlen(input);
+    if (length >= sizeof(fileName)) {
+        printf("File name too long: %s\n", input);
+        return 0;
+    }
+    memcpy(fileName, input, length);
+    fileName[length] = '\0';
+    if (at != NULL && sscanf(at + 1, "%f,%f,%f", &placement.position.x, &placement.position.y, &placement.scale) < 2) {
+        printf("Expected FILE@X,Y[,SCALE] but got %s\n", input);
+        return 0;
+    }
+    if (hasExtension(fileName, ".dat")) {
+        int sectionCount;
+        struct CollisionSection *sections = loadCollisionSections(fileName, &sectionCount);
+        if (sections == NULL) return 0;
+        addSections(builder, sections, sectionCount);
+        free(sections);
+        return 1;
+    }
+    if (!(placement.scale > 0)) {
+        printf("Scale of %s must be positive\n", input);
+        return 0;
+    }
+    int width, height;
+    unsigned char *pixels = loadPng(fileName, &width, &height);
+    if (pixels == NULL) return 0;
+    int sectionCount = builder->sectionCount, segmentCount = builder->segmentCount;
+    int added = addImageOutlines(builder, pixels, width, height, threshold, &placement);
+    free(pixels);
+    if (!added) {
+        printf("Out of memory tracing %s\n", fileName);
+        return 0;
+    }
+    printf("%s: %dx%d pixels traced into %d polylines, %d segments\n", fileName, width, height, builder->sectionCount - sectionCount,
+           builder->segmentCount - segmentCount);
+    return 1;
+}
+
+static void printUsage(void) {
+    printf("Usage: shipbattle_mapc [options] INPUT... OUTPUT\n"
+           "Inputs are collisions.dat files or PNG images, placed on the map with FILE.png@X,Y[,SCALE] (default 0,0,1)\n"
+           "  --threshold N         Alpha from which an image pixel is land, 1 to 255 (default 128)\n"
+           "  --tolerance N         Largest distance between a traced outline and its polyline in map units (default 1)\n"
+           "  --min-area N          Drop traced outlines enclosing less than this many square map units (default 16)\n"
+           "  --section-segments N  Most segments in a traced polyline (default 16)\n"
+           "  --section-size N      Largest width and height of a traced polyline in map units (default 128)\n"
+           "  --border W H          Add the edges of a W by H map as terrain\n"
+           "  --cell-size N         Width and height of a terrain grid cell (default %g)\n", TERRAIN_CELL_SIZE);
+}
+
+int main(int argc, char **argv) {
+    float cellSize = TERRAIN_CELL_SIZE;
+    int threshold = 128;
+    OutlinePlacement placement = {{0, 0}, 1, 1, 16, 16, 128};
+    Vector2 border = {0, 0};
+    const char **files = malloc(argc*sizeof(char *));
+    int fileCount = 0;
+    if (files == NULL) return 1;
+    //Read the command line options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cell-size") == 0 && i + 1 < argc) cellSize = atof(argv[++i]);
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) placement.tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-area") == 0 && i + 1 < argc) placement.minArea = atof(argv[++i]);
+        else if (strcmp(argv[i], "--section-segments") == 0 && i + 1 < argc) placement.maxSectionSegments = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--section-size") == 0 && i + 1 < argc) placement.maxSectionSize = atof(argv[++i]);
+        else if (strcmp(argv[i], "--border") == 0 && i + 2 < argc) {
+            border.x = atof(argv[++i]);
+            border.y = atof(argv[++i]);
+        }
+        else if (argv[i][0] != '-') files[fileCount++] = argv[i];
+        else {
+            printUsage();
+            free(files);
+            return strcmp(argv[i], "--help") != 0;
+        }
+    }
+    if (fileCount < 2 || !(cellSize > 0) || threshold < 1 || threshold > 255 || !(placement.tolerance >= 0)
+        || placement.maxSectionSegments < 1 || !(placement.maxSectionSize > 0)) {
+        printUsage();
+        free(files);
+        return 1;
+    }
+    const char *output = files[fileCount - 1];
+
+    MapBuilder builder = {0};
+    int added = 1;
+    if (border.x > 0 && border.y > 0) addBorder(&builder, border);
+    for (int i = 0; i < fileCount - 1 && added; i++) {
+        added = addInput(&builder, files[i], threshold, placement);
+    }
+    free(files);
+    int written = added && writeCompiledMap(output, &builder, cellSize);
+    freeMapBuilder(&builder);
+    if (!written) return 1;
+
+    //Open the result to check it and report how long loading takes
+    CompiledMap map;
+    TerrainGrid terrain;
+    double start = now();
+    if (!openCompiledMap(&map, output, &terrain)) return 1;
+    double elapsed = now() - start;
+    printf("%s: %d polylines, %d segments, %dx%d grid, %.1f KB, opened in %.3f ms\n", output, map.sectionCount, terrain.segmentCount,
+           terrain.columns, terrain.rows, map.size/1024.0, elapsed*1000);
+    closeCompiledMap(&map);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Asset packer. Packs the game's images, decoded to RGBA pixels, and its sounds into one asset pack
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "assetPack.h"
+#include "pngDecoder.h"
+#include "threadPool.h"
+
+//Returns the time in seconds from an arbitrary point
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//Returns the file name without its directories, which is the name the game looks the asset up by
+static const char *getBaseName(const char *path) {
+    const char *name = path;
+    for (const char *c = path; *c != '\0'; c++) {
+        if (*c == '/' || *c == '\\') name = c + 1;
+    }
+    return name;
+}
+
+//Reads a whole file. Returns NULL if it can't be read
+static unsigned char *readFile(const char *fileName, size_t *size) {
+    FILE *f = fopen(fileName, "rb");
+    if (f == NULL) {
+        perror("Failed to open asset");
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *data = malloc(length > 0 ? length : 1);
+    if (data == NULL || length < 0 || fread(data, 1, length, f) != (size_t)length) {
+        printf("Failed to read %s\n", fileName);
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = length;
+    return data;
+}
+
+//Returns 1 if the file name ends with the provided extension
+static int hasExtension(const char *fileName, const char *extension) {
+    size_t length = strlen(fileName), extensionLength = strlen(extension);
+    return length >= extensionLength && strcmp(fileName + length - extensionLength, extension) == 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3 || strcmp(argv[1], "--help") == 0) {
+        printf("Usage: shipbattle_pack OUTPUT.sbpk ASSET...\n"
+               "PNG images are stored as decoded pixels, other files as they are. Assets are looked up by their file name\n");
+        return argc < 3;
+    }
+    const char *output = argv[1];
+    AssetPackBuilder builder = {0};
+    size_t inputSize = 0;
+    for (int i = 2; i < argc; i++) {
+        const char *name = getBaseName(argv[i]);
+        if (strlen(name) >= PACK_MAX_NAME) {
+            printf("Asset name too long: %s\n", name);
+            return 1;
+        }
+        size_t size;
+        unsigned char *data = readFile(argv[i], &size);
+        if (data == NULL) return 1;
+        inputSize += size;
+        int width, height;
+        unsigned char *pixels = hasExtension(name, ".png") ? loadPng(argv[i], &width, &height) : NULL;
+        if (pixels != NULL) addPackedImage(&builder, name, pixels, width, height);
+        else addPackedFile(&builder, name, data, size); //Formats the decoder can't read are decoded by the game instead
+        free(pixels);
+        free(data);
+    }
+    int written = writeAssetPack(output, &builder);
+    freeAssetPackBuilder(&builder);
+    if (!written) return 1;
+
+    //Load the pack the way the game does to check it and report how long that takes
+    AssetPack pack;
+    double start = now();
+    if (!openAssetPack(&pack, output)) return 1;
+    double read = now() - start;
+    int threadCount = getCoreCount();
+    if (!startAssetDecode(&pack, threadCount) || !finishAssetDecode(&pack)) {
+        closeAssetPack(&pack);
+        return 1;
+    }
+    double decoded = now() - start - read;
+    size_t decodedSize = 0;
+    for (int i = 0; i < pack.entryCount; i++) {
+        AssetEntry *entry = &pack.entries[i];
+        decodedSize += entry->size;
+        if (entry->type == ASSET_IMAGE) printf("  %-24s image %dx%d\n", entry->name, entry->width, entry->height);
+        else printf("  %-24s file %zu bytes\n", entry->name, entry->size);
+    }
+    printf("%s: %d assets, %d chunks, %.1f KB from %.1f KB of files and %.1f KB decoded. Read in %.1f ms, decoded on %d threads in %.1f ms\n",
+           output, pack.entryCount, pack.chunkCount, pack.fileSize/1024.0, inputSize/1024.0, decodedSize/1024.0, read*1000, threadCount, decoded*1000);
+    closeAssetPack(&pack);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Replay inspector. Decodes recorded matches, reports their size and decode speed and prints the state at the start of any round
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "replay.h"
+
+//Returns the time in seconds from an arbitrary point
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//Prints every ship and projectile of the player's current state
+static void printState(const ReplayPlayer *player) {
+    const Fleet *ships = &player->ships;
+    printf("Round %d, %d ticks in\n", player->round, player->ticks);
+    for (int i = 0; i < player->playerCount; i++) {
+        printf("  Ship %d: (%.2f, %.2f) heading %.3f speed %.1f%s\n", i, ships->positionX[i], ships->positionY[i],
+               ships->heading[i], ships->speed[i], ships->isAlive[i] ? "" : " sunk");
+    }
+    for (int i = 0; i < player->projectiles.count; i++) {
+        const ProjectileList *projectiles = &player->projectiles;
+        printf("  Projectile of ship %d: (%.2f, %.2f, %.2f)\n", projectiles->team[i], projectiles->positionX[i], projectiles->positionY[i], projectiles->positionZ[i]);
+    }
+}
+
+static void printUsage(void) {
+    printf("Usage: shipbattle_replay [options] FILE...\n"
+           "  --round N  Print the state at the start of round N of every file\n");
+}
+
+int main(int argc, char **argv) {
+    int round = -1;
+    int fileCount = 0;
+    //Read the command line options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--round") == 0 && i + 1 < argc) round = atoi(argv[++i]);
+        else if (argv[i][0] == '-') {
+            printUsage();
+            return strcmp(argv[i], "--help") != 0;
+        }
+        else fileCount++;
+    }
+    if (fileCount == 0) {
+        printUsage();
+        return 1;
+    }
+
+    long long bytes = 0, records = 0, rounds = 0;
+    int damaged = 0;
+    double decodeTime = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--round") == 0) {
+            i++;
+            continue;
+        }
+        ReplayPlayer player;
+        if (!openReplay(&player, argv[i])) {
+            damaged++;
+            continue;
+        }
+        //Decode the whole match from the first round
+        double start = now();
+        int type;
+        while ((type = readReplayRecord(&player)) != 0) records++;
+        decodeTime += now() - start;
+        if (player.reader.failed) {
+            printf("%s is damaged\n", argv[i]);
+            damaged++;
+        }
+        bytes += player.size;
+        rounds += getReplayRoundCount(&player);
+        if (round >= 0) {
+            printf("%s: ", argv[i]);
+            if (seekReplay(&player, round)) printState(&player);
+            else printf("round %d isn't in the replay\n", round);
+        }
+        closeReplay(&player);
+    }
+
+    //Report the totals
+    printf("Replays: %d (%d damaged)\n", fileCount, damaged);
+    printf("Rounds: %lld, %.1f bytes per round\n", rounds, rounds > 0 ? (double)bytes/rounds : 0);
+    printf("Size: %.2f MB\n", bytes/1e6);
+    printf("Decoded %lld records in %.3f s, %.1f MB/s\n", records, decodeTime, decodeTime > 0 ? bytes/1e6/decodeTime : 0);
+    return damaged > 0;
+}
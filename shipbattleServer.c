@@ -0,0 +1,486 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Authoritative match server. Hosts many matches at once on a single epoll event loop. Orders that arrive together are batched,
+//and every match that has all of its orders resolves its movement and firing phases at full speed on the thread pool
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bots.h"
+#include "compiledMap.h"
+#include "matchClient.h"
+#include "saveFile.h"
+#include "threadPool.h"
+#define MAX_EVENTS 256 //Socket events handled per wait
+#define LISTENER_ID UINT32_MAX //Event id of the listening socket, clients use their index
+
+typedef struct ServerOptions {
+    const char *address;
+    const char *mapFile;
+    int threads; //Workers the phases are resolved on
+    int maxRounds; //Matches still going after this many rounds are ended
+    int tickRate;
+    double duration; //Seconds to run for, 0 to run until interrupted
+    double reportInterval; //Seconds between reports, 0 for none
+} ServerOptions;
+
+typedef struct ServerMatchStruct {
+    Match match;
+    int isOpen; //Set while the slot holds a match
+    int isStarted; //Set once every seat has been taken
+    int isReady; //Set once every alive ship has its order, until the phase is resolved
+    int playerCount;
+    Vector2 mapBounds;
+    int seatsTaken;
+    int seatClient[MAX_SERVER_PLAYERS]; //Client playing every seat, -1 once it has left
+    unsigned char hasOrder[MAX_SERVER_PLAYERS]; //Ships that have their order for the current phase
+    unsigned int seed; //Of the bot orders given to ships whose client has left
+    ByteBuffer orders; //Orders message of the last resolved phase
+    ByteBuffer state; //State the last phase resolved to, encoded as a save
+} ServerMatch;
+
+typedef struct ServerClientStruct {
+    NetConnection connection;
+    int isOpen; //Set while the slot holds a connection
+    int isWriting; //Set while the socket is watched for room to send the rest of the output
+    int match; //Match the client plays in, -1 if none
+    int firstSeat;
+    int seatCount;
+} ServerClient;
+
+typedef struct ServerStruct {
+    ServerOptions *options;
+    const TerrainGrid *terrain;
+    int epoll;
+    int listener;
+    ServerClient *clients;
+    int clientCapacity;
+    ServerMatch *matches;
+    int matchCapacity;
+    int *ready; //Matches with every order in, resolved together after every wait
+    int readyCount;
+    int readyCapacity;
+    int *resolving; //Matches being resolved, swapped with ready so matches can be queued again while the results are sent
+    int resolvingCapacity;
+    long matchesStarted;
+    long matchesFinished;
+    long phasesResolved;
+    double resolveTime; //Seconds spent resolving phases
+} Server;
+
+static volatile sig_atomic_t isStopping = 0;
+
+static void stopServer(int signal) {
+    (void)signal;
+    isStopping = 1;
+}
+
+//Returns the time in seconds from an arbitrary point
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//Grows an array of slots so index fits, clearing the new slots. Returns 0 if out of memory
+static int growSlots(void **slots, int *capacity, int index, size_t slotSize) {
+    if (index < *capacity) return 1;
+    int newCapacity = *capacity > 0 ? *capacity : 16;
+    while (newCapacity <= index) newCapacity *= 2;
+    void *grown = realloc(*slots, newCapacity*slotSize);
+    if (grown == NULL) return 0;
+    memset((char *)grown + *capacity*slotSize, 0, (newCapacity - *capacity)*slotSize);
+    *slots = grown;
+    *capacity = newCapacity;
+    return 1;
+}
+
+//Watches the client's socket for received bytes, and for room to send while it has output the socket didn't take
+static void watchClient(Server *server, int index) {
+    ServerClient *client = &server->clients[index];
+    int isWriting = hasUnsentMessages(&client->connection);
+    if (isWriting == client->isWriting) return;
+    struct epoll_event event = {EPOLLIN | (isWriting ? EPOLLOUT : 0), {.u32 = index}};
+    epoll_ctl(server->epoll, EPOLL_CTL_MOD, client->connection.socket, &event);
+    client->isWriting = isWriting;
+}
+
+//Sends a message to the client
+static void sendToClient(Server *server, int index, MessageType type, const ByteBuffer *contents) {
+    ServerClient *client = &server->clients[index];
+    ByteBuffer *output = &client->connection.output;
+    size_t start = beginMessage(output, type);
+    putBytes(output, contents->data, contents->size);
+    endMessage(output, start);
+    sendMessages(&client->connection);
+    watchClient(server, index);
+}
+
+//Sends a message to every client playing in the match
+static void sendToMatch(Server *server, ServerMatch *match, MessageType type, const ByteBuffer *contents) {
+    for (int i = 0; i < match->seatsTaken; i++) {
+        int index = match->seatClient[i];
+        if (index >= 0 && server->clients[index].firstSeat == i) sendToClient(server, index, type, contents);
+    }
+}
+
+//Gives the ships whose client has left a bot order, then queues the match for resolution if every alive ship has its order
+static void checkOrders(Server *server, int index) {
+    ServerMatch *match = &server->matches[index];
+    Match *played = &match->match;
+    if (!match->isStarted || match->isReady || played->isOver) return;
+    for (int i = 0; i < match->playerCount; i++) {
+        if (played->ships.isAlive[i] == 0 || match->hasOrder[i]) continue;
+        if (match->seatClient[i] >= 0) return; //Still waiting for this ship
+        if (played->state == FIRE_INSTR) bots[0].fireOrder(played, i, &match->seed);
+        else bots[0].movementOrder(played, i, &match->seed);
+        match->hasOrder[i] = 1;
+    }
+    if (!growSlots((void **)&server->ready, &server->readyCapacity, server->readyCount, sizeof(int))) return;
+    match->isReady = 1;
+    server->ready[server->readyCount++] = index;
+}
+
+static void closeMatch(Server *server, int index) {
+    ServerMatch *match = &server->matches[index];
+    for (int i = 0; i < match->seatsTaken; i++) {
+        if (match->seatClient[i] >= 0) server->clients[match->seatClient[i]].match = -1;
+    }
+    match->isOpen = 0; //The memory of the match is kept for the next one
+    match->isReady = 0;
+    for (int i = 0; i < server->readyCount; i++) { //The slot may be taken by a new match before the queue is resolved
+        if (server->ready[i] == index) server->ready[i--] = server->ready[--server->readyCount];
+    }
+}
+
+static void dropClient(Server *server, int index) {
+    ServerClient *client = &server->clients[index];
+    if (client->match >= 0) { //The ships of the client are played by a bot from now on
+        ServerMatch *match = &server->matches[client->match];
+        int isEmpty = 1;
+        for (int i = 0; i < match->seatsTaken; i++) {
+            if (match->seatClient[i] == index) match->seatClient[i] = -1;
+            if (match->seatClient[i] >= 0) isEmpty = 0;
+        }
+        if (isEmpty) closeMatch(server, client->match); //Nobody is left to play it
+        else checkOrders(server, client->match);
+    }
+    closeConnection(&client->connection); //Closing the socket also removes it from epoll
+    client->isOpen = 0;
+}
+
+//Puts the client in an open match with enough free seats for the same number of players and map bounds, or starts a new one.
+//Returns 0 if the request is invalid or out of memory
+static int joinMatch(Server *server, int clientIndex, ByteReader *message) {
+    ServerClient *client = &server->clients[clientIndex];
+    int playerCount = getU8(message);
+    int seatCount = getU8(message);
+    Vector2 mapBounds = {getF32(message), getF32(message)};
+    if (message->failed || client->match >= 0 || playerCount < 2 || playerCount > MAX_SERVER_PLAYERS || seatCount < 1 || seatCount > playerCount) return 0;
+    if (!(mapBounds.x > 0 && mapBounds.x <= 100000 && mapBounds.y > 0 && mapBounds.y <= 100000)) return 0;
+    int index = -1, freeIndex = -1;
+    for (int i = 0; i < server->matchCapacity && index < 0; i++) {
+        ServerMatch *match = &server->matches[i];
+        if (!match->isOpen && freeIndex < 0) freeIndex = i;
+        if (match->isOpen && !match->isStarted && match->playerCount == playerCount && match->mapBounds.x == mapBounds.x &&
+            match->mapBounds.y == mapBounds.y && playerCount - match->seatsTaken >= seatCount) index = i;
+    }
+    if (index < 0) { //Start a new match
+        index = freeIndex >= 0 ? freeIndex : server->matchCapacity;
+        if (!growSlots((void **)&server->matches, &server->matchCapacity, index, sizeof(ServerMatch))) return 0;
+        ServerMatch *match = &server->matches[index];
+        if (!initializeMatch(&match->match, playerCount, 1, server->terrain, mapBounds, server->options->tickRate)) return 0;
+        match->isOpen = 1;
+        match->isStarted = 0;
+        match->isReady = 0;
+        match->playerCount = playerCount;
+        match->mapBounds = mapBounds;
+        match->seatsTaken = 0;
+        match->seed = index + 1;
+        memset(match->hasOrder, 0, sizeof(match->hasOrder));
+    }
+    ServerMatch *match = &server->matches[index];
+    client->match = index;
+    client->firstSeat = match->seatsTaken;
+    client->seatCount = seatCount;
+    for (int i = 0; i < seatCount; i++) {
+        match->seatClient[match->seatsTaken++] = clientIndex;
+    }
+    ByteBuffer joined = {0};
+    putU32(&joined, index);
+    putU8(&joined, client->firstSeat);
+    putU8(&joined, seatCount);
+    putU8(&joined, playerCount);
+    putF32(&joined, mapBounds.x);
+    putF32(&joined, mapBounds.y);
+    sendToClient(server, clientIndex, MESSAGE_JOINED, &joined);
+    freeByteBuffer(&joined);
+    if (match->seatsTaken == playerCount) { //Every seat is taken, send everyone the starting state
+        match->isStarted = 1;
+        server->matchesStarted++;
+        encodeSave(&match->state, &match->match, 0, 0);
+        sendToMatch(server, match, MESSAGE_STATE, &match->state);
+        checkOrders(server, index);
+    }
+    return !joined.failed && !match->state.failed;
+}
+
+//Takes the order of a ship of the client. Orders for another phase are late and ignored. Returns 0 if the order is invalid
+static int takeOrder(Server *server, int clientIndex, ByteReader *message) {
+    ServerClient *client = &server->clients[clientIndex];
+    uint64_t round = getVarint(message);
+    int state = getU8(message);
+    int ship = getU8(message);
+    float heading = getF32(message);
+    float value = getF32(message);
+    if (message->failed || client->match < 0 || ship < client->firstSeat || ship >= client->firstSeat + client->seatCount) return 0;
+    if (!isfinite(heading) || !isfinite(value)) return 0;
+    ServerMatch *match = &server->matches[client->match];
+    Match *played = &match->match;
+    if (!match->isStarted || match->isReady || played->isOver || round != (uint64_t)played->round || state != (int)played->state) return 1;
+    if (played->ships.isAlive[ship] == 0 || match->hasOrder[ship]) return 1;
+    if (state == FIRE_INSTR) setFireOrder(played, ship, heading, fminf(fmaxf(value, 0), M_PI/2)); //Keep the orders in what the game can give
+    else setMovementOrder(played, ship, heading, fminf(fmaxf(value, 0), maxShipSpeed));
+    match->hasOrder[ship] = 1;
+    checkOrders(server, client->match);
+    return 1;
+}
+
+//Reads everything the client sent and handles its messages. Drops the client if it left or sent something invalid
+static void readClient(Server *server, int index) {
+    ServerClient *client = &server->clients[index];
+    int isValid = receiveMessages(&client->connection);
+    MessageType type;
+    ByteReader message;
+    while (isValid && client->isOpen && takeMessage(&client->connection, &type, &message)) {
+        if (type == MESSAGE_JOIN) isValid = joinMatch(server, index, &message);
+        else if (type == MESSAGE_ORDER) isValid = takeOrder(server, index, &message);
+        else isValid = 0;
+    }
+    if (!isValid || client->connection.failed) dropClient(server, index);
+}
+
+static void acceptClients(Server *server) {
+    int socket;
+    while ((socket = acceptConnection(server->listener)) >= 0) {
+        int index = 0;
+        while (index < server->clientCapacity && server->clients[index].isOpen) index++;
+        if (!growSlots((void **)&server->clients, &server->clientCapacity, index, sizeof(ServerClient))) {
+            NetConnection connection;
+            openConnection(&connection, socket);
+            closeConnection(&connection);
+            continue;
+        }
+        ServerClient *client = &server->clients[index];
+        openConnection(&client->connection, socket);
+        client->isOpen = 1;
+        client->isWriting = 0;
+        client->match = -1;
+        struct epoll_event event = {EPOLLIN, {.u32 = index}};
+        if (epoll_ctl(server->epoll, EPOLL_CTL_ADD, socket, &event) != 0) dropClient(server, index);
+    }
+}
+
+//Plays out the phase a match has every order for, up to the next instructions phase. Runs on a worker of the thread pool
+static void resolveMatch(void *data, int task, int worker) {
+    (void)worker;
+    Server *server = data;
+    ServerMatch *match = &server->matches[server->resolving[task]];
+    Match *played = &match->match;
+    const Fleet *ships = &played->ships;
+    ByteBuffer *orders = &match->orders;
+    orders->size = 0;
+    putVarint(orders, played->round);
+    putU8(orders, played->state);
+    putVarint(orders, played->playerCount);
+    for (int i = 0; i < played->playerCount; i++) {
+        putF32(orders, played->state == FIRE_INSTR ? ships->aimHeading[i] : ships->heading[i]);
+        putF32(orders, played->state == FIRE_INSTR ? ships->aimAngle[i] : ships->speed[i]);
+    }
+    confirmOrders(played);
+    while (!played->isOver && played->state != DIRECTION_INSTR && played->state != FIRE_INSTR) stepMatch(played);
+    if (played->round >= server->options->maxRounds) played->isOver = 1; //Nobody is winning this one
+    encodeSave(&match->state, played, 0, 0);
+    memset(match->hasOrder, 0, sizeof(match->hasOrder));
+}
+
+//Resolves every match that has all of its orders on the thread pool, then sends the results
+static void resolveReadyMatches(Server *server) {
+    int resolvingCount = server->readyCount;
+    if (resolvingCount == 0) return;
+    //Matches that are ready right away again are queued for the next batch
+    int *resolving = server->ready, capacity = server->readyCapacity;
+    server->ready = server->resolving;
+    server->readyCapacity = server->resolvingCapacity;
+    server->readyCount = 0;
+    server->resolving = resolving;
+    server->resolvingCapacity = capacity;
+    double start = now();
+    int isResolved = runTasks(resolvingCount, server->options->threads, resolveMatch, server);
+    server->resolveTime += now() - start;
+    if (!isResolved) { //Out of memory, try again with the next batch
+        for (int i = 0; i < resolvingCount && growSlots((void **)&server->ready, &server->readyCapacity, server->readyCount, sizeof(int)); i++) {
+            server->ready[server->readyCount++] = server->resolving[i];
+        }
+        return;
+    }
+    for (int i = 0; i < resolvingCount; i++) {
+        int index = server->resolving[i];
+        ServerMatch *match = &server->matches[index];
+        match->isReady = 0;
+        server->phasesResolved++;
+        sendToMatch(server, match, MESSAGE_ORDERS, &match->orders);
+        sendToMatch(server, match, MESSAGE_STATE, &match->state);
+        if (match->match.isOver) {
+            server->matchesFinished++;
+            closeMatch(server, index); //The clients can join another match
+        }
+        else checkOrders(server, index);
+    }
+}
+
+static void printReport(Server *server, double elapsed) {
+    int clients = 0, matches = 0;
+    for (int i = 0; i < server->clientCapacity; i++) clients += server->clients[i].isOpen;
+    for (int i = 0; i < server->matchCapacity; i++) matches += server->matches[i].isOpen;
+    double matchRate = server->matchesFinished/elapsed;
+    printf("%.1f s: %d clients, %d matches, %ld finished, %ld phases, %.1f matches/sec (%.1f per core), %.1f%% of the time resolving\n",
+           elapsed, clients, matches, server->matchesFinished, server->phasesResolved, matchRate, matchRate/server->options->threads,
+           100*server->resolveTime/elapsed);
+    fflush(stdout);
+}
+
+static void printUsage(void) {
+    printf("Usage: shipbattle_server [options]\n"
+           "  --listen ADDRESS  HOST:PORT or PORT for TCP, unix:PATH for a Unix socket (default 7777)\n"
+           "  --map FILE        Compiled map (default collisions.sbm)\n"
+           "  --threads N       Workers the phases are resolved on (default: one per core)\n"
+           "  --max-rounds N    End matches after this many rounds (default 100)\n"
+           "  --tick-rate N     Simulation ticks per second (default %d)\n"
+           "  --duration N      Stop after N seconds (default: run until interrupted)\n"
+           "  --report N        Seconds between reports, 0 for none (default 5)\n", SIMULATION_TICK_RATE);
+}
+
+int main(int argc, char **argv) {
+    ServerOptions options = {"7777", "collisions.sbm", getCoreCount(), 100, SIMULATION_TICK_RATE, 0, 5};
+    //Read the command line options
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--help") == 0) {
+            printUsage();
+            return 0;
+        }
+        if (value == NULL) {
+            printUsage();
+            return 1;
+        }
+        if (strcmp(argv[i], "--listen") == 0) options.address = value;
+        else if (strcmp(argv[i], "--map") == 0) options.mapFile = value;
+        else if (strcmp(argv[i], "--threads") == 0) options.threads = atoi(value);
+        else if (strcmp(argv[i], "--max-rounds") == 0) options.maxRounds = atoi(value);
+        else if (strcmp(argv[i], "--tick-rate") == 0) options.tickRate = atoi(value);
+        else if (strcmp(argv[i], "--duration") == 0) options.duration = atof(value);
+        else if (strcmp(argv[i], "--report") == 0) options.reportInterval = atof(value);
+        else {
+            printUsage();
+            return 1;
+        }
+        i++;
+    }
+    if (options.threads < 1 || options.maxRounds < 1 || options.tickRate <= 0 || options.duration < 0 || options.reportInterval < 0) {
+        printUsage();
+        return 1;
+    }
+
+    CompiledMap map;
+    TerrainGrid terrain;
+    if (!openCompiledMap(&map, options.mapFile, &terrain)) return 1;
+    Server server = {&options, &terrain};
+    server.listener = listenOnAddress(options.address);
+    server.epoll = epoll_create1(0);
+    struct epoll_event listenerEvent = {EPOLLIN, {.u32 = LISTENER_ID}};
+    if (server.listener < 0 || server.epoll < 0 || epoll_ctl(server.epoll, EPOLL_CTL_ADD, server.listener, &listenerEvent) != 0) {
+        perror("Error starting server");
+        return 1;
+    }
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    printf("Listening on %s with %d threads\n", options.address, options.threads);
+    fflush(stdout);
+
+    double start = now(), nextReport = options.reportInterval;
+    struct epoll_event events[MAX_EVENTS];
+    while (!isStopping) {
+        double elapsed = now() - start;
+        if (options.duration > 0 && elapsed >= options.duration) break;
+        if (options.reportInterval > 0 && elapsed >= nextReport) {
+            printReport(&server, elapsed);
+            nextReport += options.reportInterval;
+        }
+        int eventCount = epoll_wait(server.epoll, events, MAX_EVENTS, server.readyCount > 0 ? 0 : 100);
+        for (int i = 0; i < eventCount; i++) {
+            uint32_t id = events[i].data.u32;
+            if (id == LISTENER_ID) {
+                acceptClients(&server);
+                continue;
+            }
+            ServerClient *client = &server.clients[id];
+            if (!client->isOpen) continue; //Dropped by an earlier event of this batch
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) readClient(&server, id);
+            if (client->isOpen && (events[i].events & EPOLLOUT)) {
+                if (!sendMessages(&client->connection)) dropClient(&server, id);
+                else watchClient(&server, id);
+            }
+        }
+        //Every order that came in with this batch of events is in, resolve the matches that have all of theirs together
+        resolveReadyMatches(&server);
+        for (int i = 0; i < server.clientCapacity; i++) { //Drop the clients whose output failed while results were sent
+            if (server.clients[i].isOpen && server.clients[i].connection.failed) dropClient(&server, i);
+        }
+    }
+    printReport(&server, now() - start);
+
+    for (int i = 0; i < server.clientCapacity; i++) {
+        if (server.clients[i].isOpen) closeConnection(&server.clients[i].connection);
+    }
+    for (int i = 0; i < server.matchCapacity; i++) {
+        freeMatch(&server.matches[i].match);
+        freeByteBuffer(&server.matches[i].orders);
+        freeByteBuffer(&server.matches[i].state);
+    }
+    free(server.clients);
+    free(server.matches);
+    free(server.ready);
+    free(server.resolving);
+    close(server.epoll);
+    close(server.listener);
+    if (strncmp(options.address, "unix:", 5) == 0) remove(options.address + 5);
+    freeTerrainGrid(&terrain);
+    closeCompiledMap(&map);
+    return 0;
+}
@@ -0,0 +1,346 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Headless match runner. Plays scripted or random-order matches as fast as possible and reports the results
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bots.h"
+#include "compiledMap.h"
+#include "navGraph.h"
+#include "replay.h"
+#include "threadPool.h"
+
+typedef struct ScriptOrder {
+    int isFire; //0 for a movement order and 1 for a fire order
+    int round;
+    int ship;
+    float heading;
+    float value; //Speed for movement orders, elevation for fire orders
+} ScriptOrder;
+
+typedef struct SimOptions {
+    int matches; //Number of matches to play
+    int players; //Ships per match
+    int volley; //Projectiles fired by each ship every round
+    unsigned int seed; //Seed of the first match, every match after it uses the next one
+    int maxRounds; //Matches still going after this many rounds are stopped
+    int tickRate; //Simulation ticks per second
+    const char *mapFile;
+    ScriptOrder *script; //Orders read from the script file
+    int scriptLength;
+    int threads; //Matches played at the same time
+    int tournament; //Set to 1 to play every bot against every other bot
+    const char *recordDirectory; //Directory every match is recorded to, NULL to not record
+} SimOptions;
+
+typedef struct MatchResult {
+    int winner; //Ship left alive, -1 if every ship was destroyed and -2 if the match was stopped by the round limit
+    int rounds; //Rounds played
+    float duration; //Simulated time in seconds
+    unsigned int checksum; //Hash of the final state, identical orders must always give the same value
+} MatchResult;
+
+typedef struct SimContext {
+    SimOptions *options;
+    const TerrainGrid *terrain;
+    Match *matches; //One match per worker, each one reuses the memory of the match it played before
+    ReplayRecorder *recorders; //One recorder per worker, used when the matches are recorded
+    PathFinder *pathFinders; //One route planner per worker over the shared navigation graph
+    MatchResult *results; //One result per match, merged once every match has been played
+    int (*pairings)[2]; //Bots facing each other in each tournament pairing
+    int failed; //Set if a match couldn't be allocated
+} SimContext;
+
+//Returns the time in seconds from an arbitrary point
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//Mixes the provided bytes into an FNV-1a hash
+static unsigned int hashBytes(unsigned int hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i])*16777619u;
+    }
+    return hash;
+}
+
+//Reads a script file. Every line is "move <round> <ship> <heading> <speed>" or "fire <round> <ship> <heading> <elevation>"
+static ScriptOrder *loadScript(const char *fileName, int *length) {
+    FILE *f = fopen(fileName, "r");
+    if (f == NULL) {
+        perror("Failed to open script");
+        return NULL;
+    }
+    int capacity = 64;
+    ScriptOrder *orders = malloc(capacity*sizeof(ScriptOrder));
+    char line[256];
+    *length = 0;
+    while (orders != NULL && fgets(line, sizeof(line), f)) {
+        char type[16];
+        ScriptOrder order;
+        if (line[0] == '#' || sscanf(line, "%15s %d %d %f %f", type, &order.round, &order.ship, &order.heading, &order.value) != 5) continue; //Skip comments and empty lines
+        order.isFire = strcmp(type, "fire") == 0;
+        if (*length == capacity) {
+            capacity *= 2;
+            orders = realloc(orders, capacity*sizeof(ScriptOrder));
+            if (orders == NULL) break;
+        }
+        orders[(*length)++] = order;
+    }
+    fclose(f);
+    return orders;
+}
+
+//Finds the scripted order for the provided ship. Returns NULL if the script doesn't contain one
+static ScriptOrder *findOrder(SimOptions *options, int isFire, int round, int ship) {
+    for (int i = 0; i < options->scriptLength; i++) {
+        ScriptOrder *order = &options->script[i];
+        if (order->isFire == isFire && order->round == round && order->ship == ship) return order;
+    }
+    return NULL;
+}
+
+//Returns the bot playing the provided ship. In a tournament the two bots of a pairing take turns, and swap sides every other match
+static const Bot *getBot(SimContext *context, int match, int ship) {
+    if (!context->options->tournament) return &bots[0];
+    int *pairing = context->pairings[match/context->options->matches];
+    int side = (ship + match) % 2;
+    return &bots[pairing[side]];
+}
+
+//Gives orders to every alive ship. Ships without a scripted order get one from their bot
+static void giveOrders(SimContext *context, Match *match, int matchIndex, unsigned int *seed) {
+    SimOptions *options = context->options;
+    int isFire = match->state == FIRE_INSTR;
+    for (int i = 0; i < match->playerCount; i++) {
+        if (match->ships.isAlive[i] == 0) continue;
+        ScriptOrder *order = findOrder(options, isFire, match->round, i);
+        const Bot *bot = getBot(context, matchIndex, i);
+        if (order != NULL && isFire) setFireOrder(match, i, order->heading, order->value);
+        else if (order != NULL) setMovementOrder(match, i, order->heading, order->value);
+        else if (isFire) bot->fireOrder(match, i, seed);
+        else bot->movementOrder(match, i, seed);
+    }
+    confirmOrders(match);
+}
+
+//Plays a single match until it ends or reaches the round limit. Runs on a worker of the thread pool
+static void playMatch(void *data, int matchIndex, int worker) {
+    SimContext *context = data;
+    SimOptions *options = context->options;
+    Match *match = &context->matches[worker]; //Nothing is shared with the other workers except the read only terrain
+    MatchResult *result = &context->results[matchIndex];
+    unsigned int seed = options->seed + matchIndex;
+    if (!initializeMatch(match, options->players, options->volley, context->terrain, (Vector2){2048, 1152}, options->tickRate)) {
+        context->failed = 1;
+        return;
+    }
+    match->pathFinder = &context->pathFinders[worker];
+    clearPathCache(match->pathFinder); //Routes cached by the last match would make this one depend on which worker plays it
+    if (options->recordDirectory != NULL) {
+        char fileName[1024];
+        snprintf(fileName, sizeof(fileName), "%s/match_%06d.sbr", options->recordDirectory, matchIndex);
+        if (!startReplayRecording(&context->recorders[worker], match, fileName)) context->failed = 1;
+    }
+    int ticks = 0;
+    while (!match->isOver && match->round < options->maxRounds) {
+        if (match->state == DIRECTION_INSTR || match->state == FIRE_INSTR) giveOrders(context, match, matchIndex, &seed);
+        else { //Fixed ticks give the same result as the game for the same orders
+            stepMatch(match);
+            ticks++;
+        }
+    }
+    if (match->replay != NULL && !finishReplayRecording(match->replay, match, 1)) context->failed = 1;
+    Fleet *ships = &match->ships;
+    result->rounds = match->round + 1;
+    result->duration = ticks*match->tickLength;
+    result->checksum = 2166136261u;
+    for (int i = 0; i < match->playerCount; i++) {
+        Vector2 position = {ships->positionX[i], ships->positionY[i]};
+        result->checksum = hashBytes(result->checksum, &position, sizeof(Vector2));
+        result->checksum = hashBytes(result->checksum, &ships->isAlive[i], sizeof(int));
+    }
+    result->winner = match->isOver ? -1 : -2;
+    for (int i = 0; i < match->playerCount && match->isOver; i++) {
+        if (ships->isAlive[i]) result->winner = i;
+    }
+}
+
+static void printUsage(void) {
+    printf("Usage: shipbattle_sim [options]\n"
+           "  --matches N     Number of matches to play (default 1000)\n"
+           "  --players N     Ships per match, at least 2 (default 2)\n"
+           "  --volley N      Projectiles fired by each ship every round (default 1)\n"
+           "  --seed N        Seed of the random orders (default 1)\n"
+           "  --max-rounds N  Stop matches after this many rounds (default 100)\n"
+           "  --tick-rate N   Simulation ticks per second (default %d)\n"
+           "  --map FILE      Compiled map (default collisions.sbm)\n"
+           "  --script FILE   Orders to play instead of random ones\n"
+           "  --threads N     Matches played at the same time (default: one per core)\n"
+           "  --tournament    Play --matches matches between every pair of bots\n"
+           "  --record DIR    Record every match to DIR/match_<number>.sbr\n", SIMULATION_TICK_RATE);
+}
+
+int main(int argc, char **argv) {
+    SimOptions options = {1000, 2, 1, 1, 100, SIMULATION_TICK_RATE, "collisions.sbm", NULL, 0, getCoreCount(), 0, NULL};
+    //Read the command line options
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--help") == 0) {
+            printUsage();
+            return 0;
+        }
+        if (strcmp(argv[i], "--tournament") == 0) {
+            options.tournament = 1;
+            continue;
+        }
+        if (value == NULL) {
+            printUsage();
+            return 1;
+        }
+        if (strcmp(argv[i], "--matches") == 0) options.matches = atoi(value);
+        else if (strcmp(argv[i], "--players") == 0) options.players = atoi(value);
+        else if (strcmp(argv[i], "--volley") == 0) options.volley = atoi(value);
+        else if (strcmp(argv[i], "--seed") == 0) options.seed = strtoul(value, NULL, 10);
+        else if (strcmp(argv[i], "--max-rounds") == 0) options.maxRounds = atoi(value);
+        else if (strcmp(argv[i], "--tick-rate") == 0) options.tickRate = atoi(value);
+        else if (strcmp(argv[i], "--map") == 0) options.mapFile = value;
+        else if (strcmp(argv[i], "--threads") == 0) options.threads = atoi(value);
+        else if (strcmp(argv[i], "--record") == 0) options.recordDirectory = value;
+        else if (strcmp(argv[i], "--script") == 0) {
+            options.script = loadScript(value, &options.scriptLength);
+            if (options.script == NULL) return 1;
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+        i++;
+    }
+    if (options.players < 2 || options.volley < 1 || options.matches <= 0 || options.tickRate <= 0 || options.threads < 1) {
+        printUsage();
+        return 1;
+    }
+
+    CompiledMap map;
+    TerrainGrid terrain;
+    if (!openCompiledMap(&map, options.mapFile, &terrain)) return 1;
+    NavGraph navigation;
+    if (!buildNavGraph(&navigation, &terrain)) {
+        printf("Failed to build the navigation graph\n");
+        return 1;
+    }
+
+    //Every tournament pairing plays options.matches matches
+    int pairingCount = options.tournament ? botCount*(botCount - 1)/2 : 1;
+    int matchCount = options.matches*pairingCount;
+    SimContext context = {&options, &terrain};
+    context.matches = calloc(options.threads, sizeof(Match));
+    context.recorders = calloc(options.threads, sizeof(ReplayRecorder));
+    context.pathFinders = calloc(options.threads, sizeof(PathFinder));
+    context.results = malloc(matchCount*sizeof(MatchResult));
+    context.pairings = malloc(pairingCount*sizeof(*context.pairings));
+    int ready = context.matches != NULL && context.recorders != NULL && context.pathFinders != NULL && context.results != NULL && context.pairings != NULL;
+    for (int i = 0; ready && i < options.threads; i++) {
+        ready = createPathFinder(&context.pathFinders[i], &navigation);
+    }
+    for (int a = 0, pairing = 0; ready && options.tournament && a < botCount; a++) {
+        for (int b = a + 1; b < botCount; b++) {
+            context.pairings[pairing][0] = a;
+            context.pairings[pairing++][1] = b;
+        }
+    }
+    //Check how many ships fit on the map before playing
+    ready = ready && initializeMatch(&context.matches[0], options.players, options.volley, &terrain, (Vector2){2048, 1152}, options.tickRate);
+    if (ready && playersAlive(&context.matches[0].ships) < options.players) printf("Only %d of %d ships fit on the map, the rest start destroyed\n", playersAlive(&context.matches[0].ships), options.players);
+    const char *kernels = getIntegrationKernelName(); //Name of the kernels the workers use, for the summary
+    double start = now();
+    ready = ready && runTasks(matchCount, options.threads, playMatch, &context);
+    double elapsed = now() - start;
+    if (!ready || context.failed) {
+        printf(options.recordDirectory != NULL ? "Failed to allocate or record the matches\n" : "Failed to allocate the matches\n");
+        return 1;
+    }
+
+    //Merge the results of every match in order, so they don't depend on which worker played which match
+    int *wins = calloc(options.tournament ? botCount : options.players, sizeof(int));
+    int *played = calloc(botCount, sizeof(int));
+    int draws = 0, unfinished = 0, shortest = matchCount > 0 ? context.results[0].rounds : 0, longest = 0;
+    long rounds = 0;
+    double duration = 0;
+    unsigned int checksum = 2166136261u;
+    for (int i = 0; i < matchCount && wins != NULL && played != NULL; i++) {
+        MatchResult *result = &context.results[i];
+        if (result->winner == -1) draws++;
+        else if (result->winner == -2) unfinished++;
+        else if (options.tournament) wins[getBot(&context, i, result->winner) - bots]++;
+        else wins[result->winner]++;
+        if (options.tournament) {
+            played[context.pairings[i/options.matches][0]]++;
+            played[context.pairings[i/options.matches][1]]++;
+        }
+        rounds += result->rounds;
+        shortest = result->rounds < shortest ? result->rounds : shortest;
+        longest = result->rounds > longest ? result->rounds : longest;
+        duration += result->duration;
+        checksum = hashBytes(checksum, &result->checksum, sizeof(unsigned int));
+    }
+
+    //Report the results
+    printf("Matches: %d (%d players, seed %u, %s kernels, %d threads)\n", matchCount, options.players, options.seed, kernels, options.threads);
+    if (options.tournament) {
+        for (int i = 0; i < botCount && wins != NULL && played != NULL; i++) {
+            printf("  %-10s wins: %d of %d (%.1f%%)\n", bots[i].name, wins[i], played[i], played[i] > 0 ? 100.0*wins[i]/played[i] : 0);
+        }
+    }
+    for (int i = 0; i < options.players && !options.tournament && wins != NULL; i++) {
+        printf("  Ship %d wins: %d\n", i, wins[i]);
+    }
+    printf("  Draws: %d\n  Unfinished: %d\n", draws, unfinished);
+    printf("Average rounds: %.2f (shortest %d, longest %d)\n", (double)rounds/matchCount, shortest, longest);
+    printf("Average match length: %.1f s\n", duration/matchCount);
+    printf("State checksum: %08x\n", checksum);
+    printf("Elapsed: %.3f s, %.1f matches/sec\n", elapsed, matchCount/elapsed);
+
+    for (int i = 0; i < options.threads; i++) {
+        freeMatch(&context.matches[i]);
+        freePathFinder(&context.pathFinders[i]);
+    }
+    free(context.matches);
+    free(context.recorders);
+    free(context.pathFinders);
+    free(context.results);
+    free(context.pairings);
+    free(wins);
+    free(played);
+    free(options.script);
+    freeNavGraph(&navigation);
+    freeTerrainGrid(&terrain);
+    closeCompiledMap(&map);
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "raymath.h"
+#include "rlgl.h"
+#include "spriteBatch.h"
+
+//Packs one image per sprite side by side into an atlas texture. Returns 1 if successful and 0 if not
+int buildSpriteAtlas(SpriteAtlas *atlas, const Image *images) {
+    int width = SPRITE_PADDING, height = 0;
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        width += images[i].width + SPRITE_PADDING;
+        height = images[i].height > height ? images[i].height : height;
+    }
+    Image atlasImage = GenImageColor(width, height + 2*SPRITE_PADDING, BLANK);
+    float x = SPRITE_PADDING;
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        Rectangle source = {0, 0, images[i].width, images[i].height};
+        atlas->regions[i] = (Rectangle){x, SPRITE_PADDING, images[i].width, images[i].height};
+        ImageDraw(&atlasImage, images[i], source, atlas->regions[i], WHITE);
+        x += images[i].width + SPRITE_PADDING;
+    }
+    atlas->texture = LoadTextureFromImage(atlasImage);
+    UnloadImage(atlasImage);
+    return atlas->texture.id != 0;
+}
+
+void unloadSpriteAtlas(SpriteAtlas *atlas) {
+    UnloadTexture(atlas->texture);
+    *atlas = (SpriteAtlas){0};
+}
+
+//Queues a sprite to be drawn with the rest of the batch. Sprites that don't fit in memory are skipped
+void addSprite(SpriteBatch *batch, SpriteId sprite, Vector2 position, Vector2 size, float rotation, Color tint) {
+    if (batch->count == batch->capacity) {
+        int capacity = batch->capacity > 0 ? batch->capacity*2 : 256;
+        SpriteInstance *grown = realloc(batch->instances, capacity*sizeof(SpriteInstance));
+        if (grown == NULL) return;
+        batch->instances = grown;
+        batch->capacity = capacity;
+    }
+    batch->instances[batch->count++] = (SpriteInstance){position, size, rotation, sprite, tint};
+}
+
+//Grows the batch's own vertex buffer to hold the provided number of quads, or the most it can hold
+static void reserveRenderBatch(SpriteBatch *batch, int quads) {
+    if (quads <= batch->renderCapacity || batch->renderCapacity == SPRITE_MAX_BATCH) return;
+    int capacity = batch->renderCapacity > 0 ? batch->renderCapacity : 1024;
+    while (capacity < quads && capacity < SPRITE_MAX_BATCH) capacity *= 2;
+    if (batch->renderCapacity > 0) rlUnloadRenderBatch(batch->renderBatch);
+    batch->renderBatch = rlLoadRenderBatch(1, capacity);
+    batch->renderCapacity = capacity;
+}
+
+//Draws every queued sprite as a textured quad from the atlas and empties the batch. The quads go to a vertex buffer of their own,
+//grown to fit the frame's sprites, and the texture stays bound for all of them, so they are drawn with a single draw call
+void drawSpriteBatch(SpriteBatch *batch) {
+    const SpriteAtlas *atlas = batch->atlas;
+    float width = atlas->texture.width, height = atlas->texture.height;
+    if (batch->count == 0) return;
+    reserveRenderBatch(batch, batch->count + 1); //rlgl flushes a buffer as soon as it is full, so one quad is left free
+    rlSetRenderBatchActive(&batch->renderBatch); //Draws whatever the default batch holds first, so the order on screen is kept
+    int chunk = batch->renderCapacity - 1;
+    for (int first = 0; first < batch->count; first += chunk) {
+        int last = first + chunk < batch->count ? first + chunk : batch->count;
+        rlCheckRenderBatchLimit(4*(last - first)); //Only flushes when the frame has more sprites than SPRITE_MAX_BATCH
+        rlSetTexture(atlas->texture.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0, 0, 1);
+        for (int i = first; i < last; i++) {
+            const SpriteInstance *sprite = &batch->instances[i];
+            Rectangle region = atlas->regions[sprite->sprite];
+            //Half of the sprite's width and height, rotated
+            float cosine = cosf(sprite->rotation), sine = sinf(sprite->rotation);
+            Vector2 across = {cosine*sprite->size.x/2, sine*sprite->size.x/2};
+            Vector2 down = {-sine*sprite->size.y/2, cosine*sprite->size.y/2};
+            Vector2 topLeft = Vector2Subtract(Vector2Subtract(sprite->position, across), down);
+            Vector2 bottomLeft = Vector2Add(Vector2Subtract(sprite->position, across), down);
+            Vector2 bottomRight = Vector2Add(Vector2Add(sprite->position, across), down);
+            Vector2 topRight = Vector2Subtract(Vector2Add(sprite->position, across), down);
+            float left = region.x/width, right = (region.x + region.width)/width;
+            float top = region.y/height, bottom = (region.y + region.height)/height;
+            rlColor4ub(sprite->tint.r, sprite->tint.g, sprite->tint.b, sprite->tint.a);
+            rlTexCoord2f(left, top);
+            rlVertex2f(topLeft.x, topLeft.y);
+            rlTexCoord2f(left, bottom);
+            rlVertex2f(bottomLeft.x, bottomLeft.y);
+            rlTexCoord2f(right, bottom);
+            rlVertex2f(bottomRight.x, bottomRight.y);
+            rlTexCoord2f(right, top);
+            rlVertex2f(topRight.x, topRight.y);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+    rlSetRenderBatchActive(NULL); //Draws the sprites and goes back to the default batch
+    batch->count = 0;
+}
+
+//Frees the queued sprites and the batch's vertex buffer. Called while the window is still open
+void freeSpriteBatch(SpriteBatch *batch) {
+    if (batch->renderCapacity > 0) rlUnloadRenderBatch(batch->renderBatch);
+    free(batch->instances);
+    *batch = (SpriteBatch){0};
+}
@@ -0,0 +1,64 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Draws every ship, shell and trajectory dot of a frame from one texture atlas in a single batch
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+#include "raylib.h"
+#include "rlgl.h"
+#define SPRITE_PADDING 2 //Empty pixels around every sprite in the atlas so filtering doesn't bleed between them
+#ifdef __EMSCRIPTEN__
+#define SPRITE_MAX_BATCH 16384 //Most quads in the batch's vertex buffer, WebGL 1 indexes vertices with 16 bits
+#else
+#define SPRITE_MAX_BATCH 262144 //Most quads in the batch's vertex buffer, past it the sprites are drawn with one call per full buffer
+#endif
+
+typedef enum SpriteId {SPRITE_SHIP, SPRITE_CANNON_BALL, SPRITE_DOT, SPRITE_COUNT} SpriteId; //Every sprite in the atlas
+
+typedef struct SpriteAtlasStruct {
+    Texture2D texture;
+    Rectangle regions[SPRITE_COUNT]; //Area of every sprite in the texture
+} SpriteAtlas;
+
+typedef struct SpriteInstanceStruct {
+    Vector2 position; //Center of the sprite
+    Vector2 size;
+    float rotation; //Around the center in radians
+    SpriteId sprite;
+    Color tint;
+} SpriteInstance;
+
+typedef struct SpriteBatchStruct {
+    const SpriteAtlas *atlas;
+    SpriteInstance *instances; //Sprites queued since the last draw, drawn in the order they were added
+    int count;
+    int capacity;
+    rlRenderBatch renderBatch; //Vertex buffer of the batch, kept apart from rlgl's default one so every sprite fits in a single draw call
+    int renderCapacity; //Quads renderBatch holds, 0 before the first draw
+} SpriteBatch;
+
+int buildSpriteAtlas(SpriteAtlas *atlas, const Image *images);
+void unloadSpriteAtlas(SpriteAtlas *atlas);
+void addSprite(SpriteBatch *batch, SpriteId sprite, Vector2 position, Vector2 size, float rotation, Color tint);
+void drawSpriteBatch(SpriteBatch *batch);
+void freeSpriteBatch(SpriteBatch *batch);
+#endif //SPRITEBATCH_H
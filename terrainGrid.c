@@ -0,0 +1,372 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "terrainGrid.h"
+
+//Returns the column of the cell containing the provided x coordinate, clamped to the grid
+static int getColumn(const TerrainGrid *grid, float x) {
+    int column = (int)floorf((x - grid->origin.x)/grid->cellSize);
+    return column < 0 ? 0 : column >= grid->columns ? grid->columns - 1 : column;
+}
+
+//Returns the row of the cell containing the provided y coordinate, clamped to the grid
+static int getRow(const TerrainGrid *grid, float y) {
+    int row = (int)floorf((y - grid->origin.y)/grid->cellSize);
+    return row < 0 ? 0 : row >= grid->rows ? grid->rows - 1 : row;
+}
+
+//Returns the water mask cell under the provided point, points outside the mask are coast
+static unsigned char getWaterCell(const TerrainGrid *grid, Vector2 point) {
+    int column = (int)floorf((point.x - grid->origin.x)/WATER_CELL_SIZE);
+    int row = (int)floorf((point.y - grid->origin.y)/WATER_CELL_SIZE);
+    if (column < 0 || row < 0 || column >= grid->waterColumns || row >= grid->waterRows) return WATER_COAST;
+    return grid->water[row*grid->waterColumns + column];
+}
+
+//Marks which cells of the water mask are open sea and which are land. Coast cells are found by walking along every segment,
+//then grown by a cell to close small gaps between sections. The largest region they enclose is the sea, and the regions
+//that don't reach the edge of the mask are inside islands
+static int buildWaterMask(TerrainGrid *grid) {
+    grid->waterColumns = (int)(grid->columns*grid->cellSize/WATER_CELL_SIZE);
+    grid->waterRows = (int)(grid->rows*grid->cellSize/WATER_CELL_SIZE);
+    int cellCount = grid->waterColumns*grid->waterRows;
+    unsigned char *coast = calloc(cellCount, 1);
+    int *region = malloc(cellCount*sizeof(int)); //Region number of every cell, -1 for coast
+    int *stack = malloc(cellCount*sizeof(int)); //Cells waiting to be filled
+    unsigned char *enclosed = malloc(cellCount); //1 for every region that doesn't reach the edge of the mask
+    grid->water = calloc(cellCount, 1);
+    if (coast == NULL || region == NULL || stack == NULL || enclosed == NULL || grid->water == NULL) {
+        free(coast);
+        free(region);
+        free(stack);
+        free(enclosed);
+        return 0;
+    }
+    for (int i = 0; i < grid->segmentCount; i++) {
+        Line line = grid->segments[i];
+        int steps = (int)(Vector2Distance(line.start, line.end)/(WATER_CELL_SIZE/2)) + 1;
+        for (int step = 0; step <= steps; step++) {
+            Vector2 point = Vector2Subtract(Vector2Lerp(line.start, line.end, (float)step/steps), grid->origin);
+            int column = (int)(point.x/WATER_CELL_SIZE), row = (int)(point.y/WATER_CELL_SIZE);
+            for (int y = row - 1; y <= row + 1; y++) {
+                for (int x = column - 1; x <= column + 1; x++) {
+                    if (x >= 0 && y >= 0 && x < grid->waterColumns && y < grid->waterRows) coast[y*grid->waterColumns + x] = 1;
+                }
+            }
+        }
+    }
+    //Flood fill every region of non coast cells and remember the largest
+    int regionCount = 0, largestRegion = -1, largestSize = 0;
+    for (int cell = 0; cell < cellCount; cell++) {
+        region[cell] = coast[cell] ? -1 : -2; //-2 means not filled yet
+    }
+    for (int cell = 0; cell < cellCount; cell++) {
+        if (region[cell] != -2) continue;
+        int size = 0, top = 0, isEnclosed = 1;
+        stack[top++] = cell;
+        region[cell] = regionCount;
+        while (top > 0) {
+            int current = stack[--top];
+            int x = current % grid->waterColumns, y = current / grid->waterColumns;
+            if (x == 0 || y == 0 || x == grid->waterColumns - 1 || y == grid->waterRows - 1) isEnclosed = 0;
+            int neighbours[4] = {x > 0 ? current - 1 : -1, x < grid->waterColumns - 1 ? current + 1 : -1,
+                                 y > 0 ? current - grid->waterColumns : -1, y < grid->waterRows - 1 ? current + grid->waterColumns : -1};
+            size++;
+            for (int n = 0; n < 4; n++) {
+                if (neighbours[n] >= 0 && region[neighbours[n]] == -2) {
+                    region[neighbours[n]] = regionCount;
+                    stack[top++] = neighbours[n];
+                }
+            }
+        }
+        if (size > largestSize) {
+            largestSize = size;
+            largestRegion = regionCount;
+        }
+        enclosed[regionCount++] = isEnclosed;
+    }
+    for (int cell = 0; cell < cellCount; cell++) {
+        if (region[cell] < 0) grid->water[cell] = WATER_COAST;
+        else if (region[cell] == largestRegion) grid->water[cell] = WATER_SEA;
+        else grid->water[cell] = enclosed[region[cell]] ? WATER_LAND : WATER_COAST; //Regions open to the edge may go on past the terrain
+    }
+    free(coast);
+    free(region);
+    free(stack);
+    free(enclosed);
+    return 1;
+}
+
+//Returns the distance between a point and a line segment
+static float getSegmentDistance(Vector2 point, Line line) {
+    Vector2 dir = Vector2Subtract(line.end, line.start);
+    float lengthSqr = Vector2LengthSqr(dir);
+    float t = lengthSqr > 0 ? Clamp(Vector2DotProduct(Vector2Subtract(point, line.start), dir)/lengthSqr, 0, 1) : 0; //Closest point along the segment
+    return Vector2Distance(point, Vector2Add(line.start, Vector2Scale(dir, t)));
+}
+
+//Samples the distance to the closest segment on a regular lattice over the grid, negative inside islands. Every sample searches
+//the grid in growing rings of cells and stops once no cell further out can hold anything closer. Samples in the coast band of the
+//water mask take the side of the closest sample the mask is sure about. Returns 1 if successful and 0 if it ran out of memory
+static int buildDistanceField(TerrainGrid *grid) {
+    grid->distanceColumns = (int)ceilf(grid->columns*grid->cellSize/TERRAIN_DISTANCE_CELL_SIZE) + 1;
+    grid->distanceRows = (int)ceilf(grid->rows*grid->cellSize/TERRAIN_DISTANCE_CELL_SIZE) + 1;
+    int sampleCount = grid->distanceColumns*grid->distanceRows;
+    signed char *side = malloc(sampleCount); //1 on the sea, -1 inside islands and 0 while unknown
+    int *queue = malloc(sampleCount*sizeof(int)); //Samples whose side is known, in the order they were found
+    grid->distance = malloc(sampleCount*sizeof(float));
+    if (side == NULL || queue == NULL || grid->distance == NULL) {
+        free(side);
+        free(queue);
+        return 0;
+    }
+    int queueEnd = 0;
+    for (int row = 0; row < grid->distanceRows; row++) {
+        for (int column = 0; column < grid->distanceColumns; column++) {
+            int sample = row*grid->distanceColumns + column;
+            Vector2 point = {grid->origin.x + column*TERRAIN_DISTANCE_CELL_SIZE, grid->origin.y + row*TERRAIN_DISTANCE_CELL_SIZE};
+            //Exact distance to the closest segment
+            float closest = INFINITY;
+            int pointColumn = getColumn(grid, point.x), pointRow = getRow(grid, point.y);
+            //Cells of the next ring are at least a cell away, two for the last samples which can lie just past the grid
+            for (int ring = 0; ring <= grid->columns + grid->rows && closest > (ring - 2)*grid->cellSize; ring++) {
+                for (int y = pointRow - ring; y <= pointRow + ring; y++) {
+                    //Only the first and last rows of a ring are walked across, the rows between just have their two ends
+                    int step = y == pointRow - ring || y == pointRow + ring ? 1 : 2*ring;
+                    for (int x = pointColumn - ring; x <= pointColumn + ring; x += step) {
+                        if (x < 0 || y < 0 || x >= grid->columns || y >= grid->rows) continue;
+                        int cell = y*grid->columns + x;
+                        for (int i = grid->cellStart[cell]; i < grid->cellStart[cell + 1]; i++) {
+                            closest = fminf(closest, getSegmentDistance(point, grid->segments[grid->cellSegments[i]]));
+                        }
+                    }
+                }
+            }
+            grid->distance[sample] = grid->segmentCount > 0 ? closest : 0;
+            //The side comes from the water mask cell below and to the right of the sample
+            unsigned char water = getWaterCell(grid, (Vector2){point.x + WATER_CELL_SIZE/2, point.y + WATER_CELL_SIZE/2});
+            side[sample] = water == WATER_SEA ? 1 : water == WATER_LAND ? -1 : 0;
+            if (side[sample] != 0) queue[queueEnd++] = sample;
+        }
+    }
+    //Spread the known sides into the coast band, breadth first so every sample takes the side of the closest known one
+    for (int queueStart = 0; queueStart < queueEnd; queueStart++) {
+        int sample = queue[queueStart];
+        int x = sample % grid->distanceColumns, y = sample / grid->distanceColumns;
+        int neighbours[4] = {x > 0 ? sample - 1 : -1, x < grid->distanceColumns - 1 ? sample + 1 : -1,
+                             y > 0 ? sample - grid->distanceColumns : -1, y < grid->distanceRows - 1 ? sample + grid->distanceColumns : -1};
+        for (int n = 0; n < 4; n++) {
+            if (neighbours[n] >= 0 && side[neighbours[n]] == 0) {
+                side[neighbours[n]] = side[sample];
+                queue[queueEnd++] = neighbours[n];
+            }
+        }
+    }
+    for (int sample = 0; sample < sampleCount; sample++) {
+        if (side[sample] < 0) grid->distance[sample] = -grid->distance[sample]; //Samples left unknown have no sea or land anywhere and count as sea
+    }
+    free(side);
+    free(queue);
+    return 1;
+}
+
+//Builds the grid from the terrain segments of the map. Returns 1 if successful and 0 if it ran out of memory
+int buildTerrainGrid(TerrainGrid *grid, const Line *segments, int segmentCount, float cellSize) {
+    *grid = (TerrainGrid){0};
+    grid->cellSize = cellSize;
+    grid->segmentCount = segmentCount;
+    grid->segments = malloc((segmentCount > 0 ? segmentCount : 1)*sizeof(Line));
+    if (grid->segments == NULL) return 0;
+
+    //Copy the segments and measure the area they cover
+    Vector2 min = {INFINITY, INFINITY};
+    Vector2 max = {-INFINITY, -INFINITY};
+    for (int i = 0; i < segmentCount; i++) {
+        Line line = segments[i];
+        grid->segments[i] = line;
+        min = Vector2Min(min, Vector2Min(line.start, line.end));
+        max = Vector2Max(max, Vector2Max(line.start, line.end));
+    }
+    if (grid->segmentCount == 0) min = max = (Vector2){0};
+    grid->origin = min;
+    grid->columns = (int)((max.x - min.x)/cellSize) + 1;
+    grid->rows = (int)((max.y - min.y)/cellSize) + 1;
+
+    //Count the segments overlapping every cell, then store their indices cell after cell
+    int cellCount = grid->columns*grid->rows;
+    grid->cellStart = calloc(cellCount + 1, sizeof(int));
+    if (grid->cellStart == NULL) {
+        freeTerrainGrid(grid);
+        return 0;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < grid->segmentCount; i++) {
+            Line line = grid->segments[i];
+            int firstColumn = getColumn(grid, fminf(line.start.x, line.end.x));
+            int lastColumn = getColumn(grid, fmaxf(line.start.x, line.end.x));
+            int firstRow = getRow(grid, fminf(line.start.y, line.end.y));
+            int lastRow = getRow(grid, fmaxf(line.start.y, line.end.y));
+            for (int row = firstRow; row <= lastRow; row++) {
+                for (int column = firstColumn; column <= lastColumn; column++) {
+                    int cell = row*grid->columns + column;
+                    if (pass == 0) grid->cellStart[cell + 1]++; //First pass counts
+                    else grid->cellSegments[grid->cellStart[cell]++] = i; //Second pass fills, using cellStart as a cursor
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int cell = 0; cell < cellCount; cell++) {
+                grid->cellStart[cell + 1] += grid->cellStart[cell];
+            }
+            grid->cellSegments = malloc((grid->cellStart[cellCount] + 1)*sizeof(int));
+            if (grid->cellSegments == NULL) {
+                freeTerrainGrid(grid);
+                return 0;
+            }
+        }
+    }
+    //The fill pass moved every start forward by one cell, shift them back
+    for (int cell = cellCount; cell > 0; cell--) {
+        grid->cellStart[cell] = grid->cellStart[cell - 1];
+    }
+    grid->cellStart[0] = 0;
+    if (!buildWaterMask(grid) || !buildDistanceField(grid)) {
+        freeTerrainGrid(grid);
+        return 0;
+    }
+    return 1;
+}
+
+//Frees the memory used by the grid
+void freeTerrainGrid(TerrainGrid *grid) {
+    if (grid->isMapped) { //The compiled map frees its own memory
+        *grid = (TerrainGrid){0};
+        return;
+    }
+    free(grid->segments);
+    free(grid->cellStart);
+    free(grid->cellSegments);
+    free(grid->water);
+    free(grid->distance);
+    *grid = (TerrainGrid){0};
+}
+
+//Checks if the provided point is on the open sea. Returns 1 if it is and 0 for land, coast and points outside the map
+int isWater(const TerrainGrid *grid, Vector2 point) {
+    return getWaterCell(grid, point) == WATER_SEA;
+}
+
+//Returns the signed distance from the provided point to the closest terrain, negative inside islands. Interpolates between the four
+//closest samples, so away from the coast it is off by at most TERRAIN_DISTANCE_ERROR. Points past the edge of the grid are at least as far as the edge
+float getTerrainDistance(const TerrainGrid *grid, Vector2 point) {
+    if (grid->segmentCount == 0) return INFINITY;
+    float x = (point.x - grid->origin.x)/TERRAIN_DISTANCE_CELL_SIZE;
+    float y = (point.y - grid->origin.y)/TERRAIN_DISTANCE_CELL_SIZE;
+    float clampedX = Clamp(x, 0, grid->distanceColumns - 1), clampedY = Clamp(y, 0, grid->distanceRows - 1);
+    int column = (int)clampedX < grid->distanceColumns - 1 ? (int)clampedX : grid->distanceColumns - 2;
+    int row = (int)clampedY < grid->distanceRows - 1 ? (int)clampedY : grid->distanceRows - 2;
+    float tx = clampedX - column, ty = clampedY - row;
+    const float *sample = &grid->distance[row*grid->distanceColumns + column];
+    float top = sample[0] + (sample[1] - sample[0])*tx;
+    float bottom = sample[grid->distanceColumns] + (sample[grid->distanceColumns + 1] - sample[grid->distanceColumns])*tx;
+    float distance = top + (bottom - top)*ty;
+    float outside = hypotf(x - clampedX, y - clampedY)*TERRAIN_DISTANCE_CELL_SIZE; //Distance past the edge of the grid
+    return outside > 0 ? fmaxf(distance, outside) : distance;
+}
+
+//Returns a lower bound of the distance between an oriented box and the terrain, 0 or less when they might touch. The box is
+//split along its length into pieces about as long as it is wide and each piece is bounded by a circle
+float getTerrainBoxDistance(const TerrainGrid *grid, Vector2 center, Vector2 forward, float halfLength, float halfWidth) {
+    int pieces = halfLength > halfWidth ? (int)ceilf(halfLength/halfWidth) : 1;
+    float pieceHalfLength = halfLength/pieces;
+    float radius = sqrtf(pieceHalfLength*pieceHalfLength + halfWidth*halfWidth);
+    float closest = INFINITY;
+    for (int i = 0; i < pieces; i++) {
+        Vector2 pieceCenter = Vector2Add(center, Vector2Scale(forward, pieceHalfLength*(2*i + 1) - halfLength));
+        closest = fminf(closest, getTerrainDistance(grid, pieceCenter));
+    }
+    return closest - radius - TERRAIN_DISTANCE_ERROR;
+}
+
+//Returns how far a ship can sail from the provided position along the heading before it touches terrain, at most length.
+//Steps as far as the distance field guarantees is clear and only runs the exact check where the field can't tell
+float getClearCourseLength(const TerrainGrid *grid, Vector2 start, float heading, float length) {
+    Vector2 forward = {cosf(heading), sinf(heading)};
+    float travelled = 0;
+    for (;;) {
+        Vector2 position = Vector2Add(start, Vector2Scale(forward, travelled));
+        float clearance = getTerrainBoxDistance(grid, position, forward, SHIP_HALF_LENGTH, SHIP_HALF_WIDTH);
+        if (clearance <= 0) {
+            Fleet ship = {.count = 1, .positionX = &position.x, .positionY = &position.y, .heading = &heading};
+            ShipGeometry geometry;
+            updateShipGeometry(&ship, &geometry);
+            if (checkTerrainCollision(&geometry, grid)) return travelled;
+        }
+        if (travelled >= length) return length;
+        travelled = fminf(length, travelled + fmaxf(clearance, COURSE_STEP));
+    }
+}
+
+//Checks if the provided ship is colliding with any terrain. Returns 1 if it detects collision and 0 if it doesn't
+int checkTerrainCollision(const ShipGeometry *geometry, const TerrainGrid *grid) {
+    const Vector2 *corners = geometry->corners;
+    if (grid->segmentCount == 0) return 0;
+    //Most ships are far from any terrain, which the distance field tells with a few reads
+    if (getTerrainBoxDistance(grid, geometry->position, geometry->forward, SHIP_HALF_LENGTH, SHIP_HALF_WIDTH) > 0) return 0;
+    //Bounding box of the ship
+    Vector2 min = Vector2Min(Vector2Min(corners[0], corners[1]), Vector2Min(corners[2], corners[3]));
+    Vector2 max = Vector2Max(Vector2Max(corners[0], corners[1]), Vector2Max(corners[2], corners[3]));
+    int firstColumn = getColumn(grid, min.x), lastColumn = getColumn(grid, max.x);
+    int firstRow = getRow(grid, min.y), lastRow = getRow(grid, max.y);
+
+    //Only look at the segments in the cells the ship overlaps
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            int cell = row*grid->columns + column;
+            for (int i = grid->cellStart[cell]; i < grid->cellStart[cell + 1]; i++) {
+                Line line = grid->segments[grid->cellSegments[i]];
+                //Skip segments whose bounding box misses the ship's
+                Vector2 lineMin = Vector2Min(line.start, line.end);
+                Vector2 lineMax = Vector2Max(line.start, line.end);
+                if (lineMin.x > max.x || lineMax.x < min.x || lineMin.y > max.y || lineMax.y < min.y) continue;
+                //A segment spanning several cells is only tested in the cell holding the top left corner of its overlap with the ship
+                if (getColumn(grid, fmaxf(lineMin.x, min.x)) != column || getRow(grid, fmaxf(lineMin.y, min.y)) != row) continue;
+                //Separating axis test between the segment and the hitbox, done in the ship's frame where the hitbox is axis aligned
+                Vector2 start = Vector2Subtract(line.start, geometry->position);
+                Vector2 end = Vector2Subtract(line.end, geometry->position);
+                float startX = Vector2DotProduct(start, geometry->forward), startY = Vector2DotProduct(start, geometry->side);
+                float endX = Vector2DotProduct(end, geometry->forward), endY = Vector2DotProduct(end, geometry->side);
+                if (fminf(startX, endX) > SHIP_HALF_LENGTH || fmaxf(startX, endX) < -SHIP_HALF_LENGTH) continue; //Apart along the ship
+                if (fminf(startY, endY) > SHIP_HALF_WIDTH || fmaxf(startY, endY) < -SHIP_HALF_WIDTH) continue; //Apart across the ship
+                //Apart along the normal of the segment, which the whole segment projects to a single point on
+                float normalX = endY - startY, normalY = startX - endX;
+                if (fabsf(normalX*startX + normalY*startY) > SHIP_HALF_LENGTH*fabsf(normalX) + SHIP_HALF_WIDTH*fabsf(normalY)) continue;
+                return 1; //No separating axis, the segment touches the hitbox or lies inside it
+            }
+        }
+    }
+    //A hitbox touching no segment is either clear of the terrain or entirely inside an island
+    return getWaterCell(grid, geometry->position) == WATER_LAND;
+}
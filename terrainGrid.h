@@ -0,0 +1,61 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Uniform grid over the terrain line segments, built once when the map is loaded
+#ifndef TERRAINGRID_H
+#define TERRAINGRID_H
+#define TERRAIN_CELL_SIZE 64.0f //Width and height of a grid cell
+#define WATER_CELL_SIZE 8.0f //Width and height of a water mask cell
+#define TERRAIN_DISTANCE_CELL_SIZE 16.0f //Spacing of the distance field samples
+#define TERRAIN_DISTANCE_ERROR (TERRAIN_DISTANCE_CELL_SIZE*0.7072f) //Largest error of interpolating between distance samples
+#define COURSE_STEP 2.0f //Shortest step taken when following a course close to terrain
+#define WATER_COAST 0 //Water mask cell near a terrain segment, or in water the mask can't tell is open sea
+#define WATER_SEA 1 //Water mask cell connected to the open sea
+#define WATER_LAND 2 //Water mask cell inside an island
+#include "gameCalculations.h"
+
+typedef struct TerrainGridStruct {
+    Vector2 origin; //Top left corner of the first cell
+    float cellSize;
+    int columns;
+    int rows;
+    int *cellStart; //Index of the first entry of every cell in cellSegments. Has columns*rows+1 entries
+    int *cellSegments; //Indices of the segments overlapping each cell, stored cell after cell
+    Line *segments; //Every terrain line segment of the map
+    int segmentCount;
+    unsigned char *water; //WATER_SEA, WATER_LAND or WATER_COAST for every water mask cell
+    int waterColumns;
+    int waterRows;
+    float *distance; //Signed distance to the closest segment at every distance sample, negative inside islands
+    int distanceColumns; //Samples are TERRAIN_DISTANCE_CELL_SIZE apart starting at the origin and cover the whole grid
+    int distanceRows;
+    int isMapped; //Set when the arrays point into a compiled map, which owns their memory
+} TerrainGrid;
+
+int buildTerrainGrid(TerrainGrid *grid, const Line *segments, int segmentCount, float cellSize);
+void freeTerrainGrid(TerrainGrid *grid);
+int checkTerrainCollision(const ShipGeometry *geometry, const TerrainGrid *grid);
+int isWater(const TerrainGrid *grid, Vector2 point);
+float getTerrainDistance(const TerrainGrid *grid, Vector2 point);
+float getTerrainBoxDistance(const TerrainGrid *grid, Vector2 center, Vector2 forward, float halfLength, float halfWidth);
+float getClearCourseLength(const TerrainGrid *grid, Vector2 start, float heading, float length);
+#endif //TERRAINGRID_H
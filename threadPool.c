@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "threadPool.h"
+
+typedef struct WorkerStruct {
+    ThreadPool *pool;
+    int index;
+} Worker;
+
+//Returns the number of cores the tasks can be spread across
+int getCoreCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#endif
+}
+
+//Takes the newest task from the worker's own queue. Returns -1 if it is empty
+static int popTask(WorkQueue *queue) {
+    int task = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->bottom > queue->top) task = queue->tasks[--queue->bottom];
+    pthread_mutex_unlock(&queue->lock);
+    return task;
+}
+
+//Takes the oldest task from another worker's queue. Returns -1 if it is empty
+static int stealTask(WorkQueue *queue) {
+    int task = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->bottom > queue->top) task = queue->tasks[queue->top++];
+    pthread_mutex_unlock(&queue->lock);
+    return task;
+}
+
+//Runs tasks from the worker's own queue, then from the other queues until every queue is empty.
+//Tasks never create new tasks so a full pass over empty queues means the work is done
+static void *runWorker(void *argument) {
+    Worker *worker = argument;
+    ThreadPool *pool = worker->pool;
+    while (1) {
+        int task = popTask(&pool->queues[worker->index]);
+        for (int i = 1; task < 0 && i < pool->workerCount; i++) { //Start with the next worker so thieves spread out
+            task = stealTask(&pool->queues[(worker->index + i) % pool->workerCount]);
+        }
+        if (task < 0) break;
+        pool->function(pool->context, task, worker->index);
+    }
+    return NULL;
+}
+
+//Runs function for every task from 0 to taskCount - 1 on workerCount threads, including the calling one, and waits for all of them.
+//Returns 1 if successful and 0 if out of memory, in which case no task has run
+int runTasks(int taskCount, int workerCount, TaskFunction function, void *context) {
+    if (workerCount < 1) workerCount = 1;
+    if (workerCount > taskCount) workerCount = taskCount > 0 ? taskCount : 1;
+    ThreadPool pool = {workerCount, calloc(workerCount, sizeof(WorkQueue)), function, context};
+    Worker *workers = malloc(workerCount*sizeof(Worker));
+    pthread_t *threads = malloc(workerCount*sizeof(pthread_t));
+    int *tasks = malloc((taskCount > 0 ? taskCount : 1)*sizeof(int));
+    if (pool.queues == NULL || workers == NULL || threads == NULL || tasks == NULL) {
+        free(pool.queues);
+        free(workers);
+        free(threads);
+        free(tasks);
+        return 0;
+    }
+    //Give every worker an equal block of tasks. Blocks are pushed in reverse so each worker starts from the lowest task in its block
+    for (int i = 0; i < workerCount; i++) {
+        WorkQueue *queue = &pool.queues[i];
+        int first = (int)((long long)taskCount*i/workerCount);
+        int last = (int)((long long)taskCount*(i + 1)/workerCount);
+        pthread_mutex_init(&queue->lock, NULL);
+        queue->tasks = tasks + first;
+        queue->top = 0;
+        queue->bottom = last - first;
+        for (int j = 0; j < last - first; j++) {
+            queue->tasks[j] = last - 1 - j;
+        }
+        workers[i] = (Worker){&pool, i};
+    }
+    int threadCount = 1;
+    while (threadCount < workerCount && pthread_create(&threads[threadCount], NULL, runWorker, &workers[threadCount]) == 0) {
+        threadCount++;
+    }
+    //If some threads couldn't be created the running workers steal the tasks of the missing ones
+    runWorker(&workers[0]); //The calling thread is worker 0
+    for (int i = 1; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < workerCount; i++) {
+        pthread_mutex_destroy(&pool.queues[i].lock);
+    }
+    free(pool.queues);
+    free(workers);
+    free(threads);
+    free(tasks);
+    return 1;
+}
@@ -0,0 +1,46 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Runs independent tasks on every core, idle workers steal tasks from busy ones
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <pthread.h>
+
+typedef void (*TaskFunction)(void *context, int task, int worker); //Runs a single task on the provided worker
+
+typedef struct WorkQueueStruct {
+    pthread_mutex_t lock;
+    int *tasks; //Tasks given to this worker, the owner takes from the bottom and thieves from the top
+    int top;
+    int bottom;
+} WorkQueue;
+
+typedef struct ThreadPoolStruct {
+    int workerCount;
+    WorkQueue *queues; //One queue per worker
+    TaskFunction function;
+    void *context; //Passed to every task
+} ThreadPool;
+
+int getCoreCount(void);
+int runTasks(int taskCount, int workerCount, TaskFunction function, void *context);
+#endif //THREADPOOL_H
@@ -0,0 +1,62 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <math.h>
+
+#include "ballistics.h"
+#include "fireControl.h"
+#include "trajectoryPreview.h"
+
+//Rebuilds the preview if the aim or the firing position changed since it was last built. The arc is drawn flat on the map, sideways
+//by the height of the projectile. Returns 1 if the preview was rebuilt and 0 if the cached one still holds
+int updateTrajectoryPreview(TrajectoryPreview *preview, Vector2 origin, float heading, float angle) {
+    if (preview->isValid && preview->origin.x == origin.x && preview->origin.y == origin.y && preview->heading == heading && preview->angle == angle) return 0;
+    preview->origin = origin;
+    preview->heading = heading;
+    preview->angle = angle;
+    preview->isValid = 1;
+
+    float horizontalSpeed = PROJECTILE_SPEED*cosf(angle), verticalSpeed = PROJECTILE_SPEED*sinf(angle);
+    if (horizontalSpeed < 1e-3f) { //Fired straight up, it lands where it started
+        preview->points[0] = origin;
+        preview->pointCount = 1;
+        preview->climbIndex = preview->dropIndex = 1;
+        return 1;
+    }
+    //Distance covered before falling back to the water
+    float range = horizontalSpeed*(verticalSpeed + sqrtf(2*GRAVITY*LAUNCH_HEIGHT + verticalSpeed*verticalSpeed))/GRAVITY;
+    int pointCount = (int)ceilf(range/PREVIEW_DOT_SPACING) + 1;
+    pointCount = pointCount < PREVIEW_MIN_POINTS ? PREVIEW_MIN_POINTS : pointCount > PREVIEW_MAX_POINTS ? PREVIEW_MAX_POINTS : pointCount;
+    //Height at a distance x is LAUNCH_HEIGHT + slope*x - curve*x^2
+    float slope = tanf(angle), curve = 0.5f*GRAVITY/(horizontalSpeed*horizontalSpeed);
+    float headingCos = cosf(heading), headingSin = sinf(heading);
+    preview->pointCount = pointCount;
+    preview->climbIndex = preview->dropIndex = pointCount;
+    for (int i = 0; i < pointCount; i++) {
+        float x = i*range/(pointCount - 1);
+        float height = LAUNCH_HEIGHT + (slope - curve*x)*x;
+        preview->points[i] = (Vector2){origin.x + x*headingCos - height*headingSin, origin.y + x*headingSin + height*headingCos};
+        if (height > SHELL_HIT_HEIGHT && preview->climbIndex == pointCount) preview->climbIndex = i;
+        else if (height <= SHELL_HIT_HEIGHT && preview->climbIndex < i && preview->dropIndex == pointCount) preview->dropIndex = i;
+    }
+    return 1;
+}
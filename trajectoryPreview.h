@@ -0,0 +1,43 @@
+/*
+Copyright (C) 2025 EverTech1, georgerafa
+
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+//Cached trajectory preview shown while a ship aims, rebuilt only when the aim or the ship's end position changes
+#ifndef TRAJECTORYPREVIEW_H
+#define TRAJECTORYPREVIEW_H
+#define PREVIEW_DOT_SPACING 12.0f //Distance between preview dots along the ground
+#define PREVIEW_MIN_POINTS 31 //Short shots still get this many dots
+#define PREVIEW_MAX_POINTS 160 //Long shots get more dots, up to this many
+#include "gameCalculations.h"
+
+typedef struct TrajectoryPreviewStruct {
+    Vector2 origin; //Where the ship will be when it fires
+    float heading; //Aim the preview was built for
+    float angle;
+    int isValid; //0 until the preview has been built
+    Vector2 points[PREVIEW_MAX_POINTS]; //Sampled arc in world space
+    int pointCount;
+    int climbIndex; //First point above the height ships can be hit at
+    int dropIndex; //First point after the apex back below that height, points before climbIndex or from here on can hit
+} TrajectoryPreview;
+
+int updateTrajectoryPreview(TrajectoryPreview *preview, Vector2 origin, float heading, float angle);
+#endif //TRAJECTORYPREVIEW_H